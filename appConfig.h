@@ -0,0 +1,205 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace LearnVulkan
+{
+    /// 同时在 GPU 上排队的最大帧数缺省值；越大 CPU/GPU 重叠越多，但输入延迟也越高
+    constexpr uint32_t DEFAULT_MAX_FRAMES_IN_FLIGHT = 2;
+
+    /// 离屏模式没有窗口可以关闭，未指定 --frames 时渲染的帧数
+    constexpr uint64_t DEFAULT_HEADLESS_FRAMES = 100;
+
+    // ==================================================================
+    // 启动参数
+    // --frames-in-flight N  每个 FrameContext 一份命令缓冲 / uniform / 描述符集 / 信号量
+    // --record-draws N      每帧把模型重复录制 N 次，用于测量每个 draw 的录制开销
+    // --record-threads N    把 draw 列表分给 N 个线程录制二级命令缓冲，1 表示直接录进主命令缓冲
+    // --instances N         把模型按网格铺开 N 份（实例化基准场景）
+    // --draw-per-object     每个实例单独一个 draw 与一份物体 uniform，作为实例化绘制的对照
+    // --gpu-culling         计算着色器做视锥剔除并写间接绘制命令，CPU 每帧的录制量与实例数无关
+    // --depth-prepass       先只写深度绘制一遍，再只对最前面的片元着色（片元着色器很重时减少 overdraw）
+    // --gpu-profile FILE    把每帧各通道的 GPU 时间写入 FILE（.json 为 JSON Lines，否则为 CSV）
+    // --no-pipeline-stats   GPU 计时不附带管线统计查询（顶点 / 片元着色器调用次数）
+    // --cpu-trace FILE      退出时把 CPU 作用域计时导出为 Chrome trace JSON（需以 BONA_CPU_PROFILER 编译）
+    // --headless            不创建窗口 / 表面 / 交换链，渲染到离屏图像，用于无显示器的基准与回归测试
+    // --device NAME|INDEX   按名字的一部分或序号选择物理设备（例如 llvmpipe、SwiftShader）
+    // --frames N            渲染 N 帧后退出（离屏模式缺省 DEFAULT_HEADLESS_FRAMES 帧）
+    // --capture FILE        退出前把最后一帧读回写成 PPM（只在离屏模式下可用）
+    // --width N / --height N  窗口或离屏目标的尺寸
+    // --no-validation       不开启验证层（构建机上通常没有安装）
+    // --fixed-timestep S    动画时间每帧前进 S 秒而不是取墙钟，相同参数的两次运行画面逐帧一致
+    // --camera-path P       相机沿路径运动：orbit[:S] 为绕模型一周的内置路径（半径乘 S，放大后纹理被缩小采样），
+    //                       否则为关键帧文件（见 cameraPath.h）
+    // --no-mips             纹理只有第 0 级（对照缩小采样时没有 mip 链的带宽与走样）
+    // --cpu-mips            即使格式支持 blit 也在 CPU 上生成 mip 链
+    // --compress-textures   没有预压缩 .dds 时在加载时把纹理压缩为 BCn（设备不支持时保持 RGBA8）
+    // --texture-stream-budget KB  .ktx2 纹理的 mip 链从最小一级开始流式加载，每帧最多上传 KB 千字节（0 为启动时全部上传）
+    // --texture-budget MB   纹理显存上限（还受设备预算限制），超出时按 LRU 丢掉纹理最精细的级别（.ktx2 与由源图像生成了 mip 链的纹理，.dds 不参与），用于模拟小显存的 GPU
+    // ==================================================================
+    struct AppConfig
+    {
+        uint32_t mMaxFramesInFlight{ DEFAULT_MAX_FRAMES_IN_FLIGHT };
+        uint32_t mRecordDraws{ 1 };
+        uint32_t mRecordThreads{ 1 };
+        uint32_t mInstanceCount{ 1 };
+        bool     mDrawPerObject{ false };
+        bool     mGpuCulling{ false };
+        bool     mDepthPrepass{ false };
+        bool     mPipelineStatistics{ true };
+        bool     mHeadless{ false };
+        bool     mValidation{ true };
+        bool     mTextureMips{ true };
+        bool     mCpuMips{ false };
+        bool     mCompressTextures{ false };
+        uint32_t mWidth{ 1280 };
+        uint32_t mHeight{ 720 };
+        uint64_t mFrameCount{ 0 };
+
+        uint64_t mTextureStreamBudget{ 0 };  // 字节
+        uint64_t mTextureBudget{ 0 };        // 字节，0 为只使用设备预算
+
+        std::string mDeviceSelector{};
+        std::string mCapturePath{};
+        std::string mCameraPath{};
+
+        double mFixedTimestep{ 0.0 };
+
+        /// 逐帧记录 CPU / GPU 时间与显存高水位（Bona_bench 使用，没有对应的命令行参数）
+        bool mCollectFrameTimings{ false };
+
+        std::string mGpuProfileDump{};
+        std::string mCpuTrace{};
+
+        static AppConfig parse(int argc, char** argv)
+        {
+            AppConfig config{};
+
+            for (int i = 1; i < argc; ++i)
+            {
+                std::string arg = argv[i];
+
+                if (arg == "--frames-in-flight" && i + 1 < argc)
+                {
+                    long value = std::strtol(argv[++i], nullptr, 10);
+                    config.mMaxFramesInFlight = static_cast<uint32_t>(value < 1 ? 1 : (value > 8 ? 8 : value));
+                }
+                else if (arg == "--record-draws" && i + 1 < argc)
+                {
+                    long value = std::strtol(argv[++i], nullptr, 10);
+                    config.mRecordDraws = static_cast<uint32_t>(value < 1 ? 1 : value);
+                }
+                else if (arg == "--record-threads" && i + 1 < argc)
+                {
+                    long value = std::strtol(argv[++i], nullptr, 10);
+                    config.mRecordThreads = static_cast<uint32_t>(value < 1 ? 1 : (value > 64 ? 64 : value));
+                }
+                else if (arg == "--instances" && i + 1 < argc)
+                {
+                    long value = std::strtol(argv[++i], nullptr, 10);
+                    config.mInstanceCount = static_cast<uint32_t>(value < 1 ? 1 : value);
+                }
+                else if (arg == "--draw-per-object")
+                {
+                    config.mDrawPerObject = true;
+                }
+                else if (arg == "--gpu-culling")
+                {
+                    config.mGpuCulling = true;
+                }
+                else if (arg == "--depth-prepass")
+                {
+                    config.mDepthPrepass = true;
+                }
+                else if (arg == "--no-mips")
+                {
+                    config.mTextureMips = false;
+                }
+                else if (arg == "--cpu-mips")
+                {
+                    config.mCpuMips = true;
+                }
+                else if (arg == "--compress-textures")
+                {
+                    config.mCompressTextures = true;
+                }
+                else if (arg == "--texture-stream-budget" && i + 1 < argc)
+                {
+                    long long value = std::strtoll(argv[++i], nullptr, 10);
+                    config.mTextureStreamBudget = static_cast<uint64_t>(value < 0 ? 0 : value) * 1024;
+                }
+                else if (arg == "--texture-budget" && i + 1 < argc)
+                {
+                    long long value = std::strtoll(argv[++i], nullptr, 10);
+                    config.mTextureBudget = static_cast<uint64_t>(value < 0 ? 0 : value) * 1024 * 1024;
+                }
+                else if (arg == "--gpu-profile" && i + 1 < argc)
+                {
+                    config.mGpuProfileDump = argv[++i];
+                }
+                else if (arg == "--cpu-trace" && i + 1 < argc)
+                {
+                    config.mCpuTrace = argv[++i];
+                }
+                else if (arg == "--headless")
+                {
+                    config.mHeadless = true;
+                }
+                else if (arg == "--device" && i + 1 < argc)
+                {
+                    config.mDeviceSelector = argv[++i];
+                }
+                else if (arg == "--frames" && i + 1 < argc)
+                {
+                    long long value = std::strtoll(argv[++i], nullptr, 10);
+                    config.mFrameCount = static_cast<uint64_t>(value < 0 ? 0 : value);
+                }
+                else if (arg == "--capture" && i + 1 < argc)
+                {
+                    config.mCapturePath = argv[++i];
+                }
+                else if (arg == "--width" && i + 1 < argc)
+                {
+                    long value = std::strtol(argv[++i], nullptr, 10);
+                    config.mWidth = static_cast<uint32_t>(value < 1 ? 1 : value);
+                }
+                else if (arg == "--height" && i + 1 < argc)
+                {
+                    long value = std::strtol(argv[++i], nullptr, 10);
+                    config.mHeight = static_cast<uint32_t>(value < 1 ? 1 : value);
+                }
+                else if (arg == "--fixed-timestep" && i + 1 < argc)
+                {
+                    double value = std::strtod(argv[++i], nullptr);
+                    config.mFixedTimestep = value < 0.0 ? 0.0 : value;
+                }
+                else if (arg == "--camera-path" && i + 1 < argc)
+                {
+                    config.mCameraPath = argv[++i];
+                }
+                else if (arg == "--no-validation")
+                {
+                    config.mValidation = false;
+                }
+                else if (arg == "--no-pipeline-stats")
+                {
+                    config.mPipelineStatistics = false;
+                }
+                else
+                {
+                    std::cout << "Warning: unknown argument " << arg << std::endl;
+                }
+            }
+
+            if (config.mHeadless && config.mFrameCount == 0)
+            {
+                config.mFrameCount = DEFAULT_HEADLESS_FRAMES;
+            }
+
+            return config;
+        }
+    };
+}
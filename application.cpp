@@ -4,115 +4,263 @@ namespace LearnVulkan
 {
     void Application::run()
     {
+        CPU_PROFILE_THREAD("Main");
+
         initWindow();
         initVulkan();
         mainLoop();
         cleanUp();
+
+        if (!mConfig.mCpuTrace.empty())
+        {
+            if (!Wrapper::CpuProfiler::isEnabled())
+            {
+                std::cout << "Warning: built without BONA_CPU_PROFILER, " << mConfig.mCpuTrace << " not written" << std::endl;
+            }
+            else if (!Wrapper::CpuProfiler::exportChromeTrace(mConfig.mCpuTrace))
+            {
+                std::cout << "Warning: failed to write CPU trace " << mConfig.mCpuTrace << std::endl;
+            }
+        }
     }
 
+    // 离屏模式不创建窗口（也就不初始化 GLFW），可以在没有显示器的机器上运行
     void Application::initWindow()
     {
-        mWindow = Wrapper::Window::create(mWidth, mHeight);
+        mWidth  = mConfig.mWidth;
+        mHeight = mConfig.mHeight;
+
+        if (!mConfig.mHeadless)
+        {
+            mWindow = Wrapper::Window::create(mWidth, mHeight);
+        }
     }
 
     void Application::initVulkan()
     {
 		mFeaturesChain = Wrapper::FeaturesChain::create();
-        mInstance = Wrapper::Instance::create(true);
-        mSurface = Wrapper::WindowSurface::create(mInstance, mWindow);
-        mDevice = Wrapper::Device::create(mInstance, mSurface);
+        mInstance = Wrapper::Instance::create(mConfig.mValidation);
+
+        if (mWindow != nullptr)
+        {
+            mSurface = Wrapper::WindowSurface::create(mInstance, mWindow);
+        }
+
+        mDevice = Wrapper::Device::create(mInstance, mSurface, mConfig.mDeviceSelector);
         mCommandPool = Wrapper::CommandPool::create(mDevice);
 
-        mSwapChain = Wrapper::SwapChain::create(mDevice, mWindow, mSurface, mCommandPool);
-        mWidth  = mSwapChain->getExtent().width;
-        mHeight = mSwapChain->getExtent().height;
+        // 离屏目标每个帧上下文一张，不需要像交换链那样按图像获取
+        if (mConfig.mHeadless)
+        {
+            mOffscreenTarget = Wrapper::OffscreenTarget::create(mDevice, mWidth, mHeight, mConfig.mMaxFramesInFlight);
+        }
+        else
+        {
+            mSwapChain = Wrapper::SwapChain::create(mDevice, mWindow, mSurface, mCommandPool);
+            mWidth  = mSwapChain->getExtent().width;
+            mHeight = mSwapChain->getExtent().height;
+        }
 
         mRenderPass = Wrapper::RenderPass::create(mDevice);
         createRenderPass();
 
-        mSwapChain->createFrameBuffers(mRenderPass);
+        if (mOffscreenTarget != nullptr)
+        {
+            mOffscreenTarget->createFrameBuffers(mRenderPass);
+        }
+        else
+        {
+            mSwapChain->createFrameBuffers(mRenderPass);
+        }
+
+        // 整个程序共用一个线程池：加载时解析模型、解码与压缩纹理，渲染时多线程录制；
+        // 调用线程也参与 parallelFor，所以只需要 N - 1 个工作线程
+        uint32_t threadCount = std::max(mConfig.mRecordThreads, std::thread::hardware_concurrency());
+        mThreadPool = ThreadPool::create(std::max(1u, threadCount - 1));
+
+        // 所有资源上传走传输队列，渲染提交只在有新上传时等待对应的时间线值
+        mUploadEngine = Wrapper::UploadEngine::create(mDevice, 64ull * 1024 * 1024, mConfig.mMaxFramesInFlight);
+
+        // uniform 与描述符集按 frames-in-flight 分片，而不是按交换链图像数；
+        // 逐物体绘制时每个实例一份物体 uniform，按最坏的 256 字节对齐预留 arena
+        VkDeviceSize arenaSize = 4ull * 1024 * 1024;
+        if (mConfig.mDrawPerObject)
+        {
+            arenaSize = std::max<VkDeviceSize>(arenaSize, (mConfig.mInstanceCount + 2ull) * 256);
+        }
+
+        Texture::MipMode mipMode = !mConfig.mTextureMips ? Texture::MipMode::None
+                                 : mConfig.mCpuMips      ? Texture::MipMode::Cpu
+                                                         : Texture::MipMode::Auto;
 
         mUniformManager = UniformManager::create();
-        mUniformManager->init(mDevice, mCommandPool, mSwapChain->getImageCount());
+        mUniformManager->init(mDevice, mUploadEngine, *mThreadPool, static_cast<int>(mConfig.mMaxFramesInFlight), arenaSize, mipMode, mConfig.mCompressTextures, mConfig.mTextureStreamBudget, mConfig.mTextureBudget);
 
         mModel = Model::create(mDevice);
-        mModel->loadModel("assets/models/diablo3_pose/diablo3_pose.obj", mDevice);
+        mModel->loadModel("assets/models/diablo3_pose/diablo3_pose.obj", mDevice, mUploadEngine, *mThreadPool);
+
+        if (mConfig.mInstanceCount > 1)
+        {
+            createInstances();
+        }
 
-        mPipeline = Wrapper::Pipeline::create(mDevice, mRenderPass);
         createPipeline();
 
-        mCommandBuffers.resize(mSwapChain->getImageCount());
-        createCommandBuffers();
+        // 主通道额外统计片元着色器调用次数，以观察深度测试 / 深度预通道消除的 overdraw
+        VkQueryPipelineStatisticFlags statistics = 0;
+        if (mConfig.mPipelineStatistics)
+        {
+            statistics = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                         VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+        }
+
+        mGpuProfiler = Wrapper::GpuProfiler::create(mDevice, mConfig.mMaxFramesInFlight, statistics, mConfig.mGpuProfileDump);
+
+        if (mConfig.mCollectFrameTimings)
+        {
+            mGpuProfiler->setResolveCallback([this](uint64_t, const char* name, double milliseconds)
+            {
+                mFrameTimings.mGpuMilliseconds[name].push_back(milliseconds);
+            });
+        }
+
+        // 环绕路径的半径取实例铺开后的相机距离，高度略高于模型
+        if (mConfig.mCameraPath.compare(0, 5, "orbit") == 0)
+        {
+            float scale = mConfig.mCameraPath.size() > 6 && mConfig.mCameraPath[5] == ':' ? std::strtof(mConfig.mCameraPath.c_str() + 6, nullptr) : 1.0f;
+            if (scale <= 0.0f)
+            {
+                scale = 1.0f;
+            }
+
+            float radius = mModel->getCameraDistance() * scale;
+            mCameraPath  = CameraPath::createOrbit(radius, radius * 0.25f, 20.0f);
+        }
+        else if (!mConfig.mCameraPath.empty())
+        {
+            mCameraPath = CameraPath::load(mConfig.mCameraPath);
+        }
+
+        // GPU 剔除以 firstInstance 选择实例矩阵，设备不支持时退回 CPU 录制路径
+        if (mConfig.mGpuCulling)
+        {
+            if (!mDevice->supportsDrawIndirectFirstInstance())
+            {
+                std::cout << "Warning: drawIndirectFirstInstance is not supported, GPU culling disabled" << std::endl;
+            }
+            else
+            {
+                mConfig.mDrawPerObject = false;
+                mGpuCulling = GpuCulling::create(mDevice, mUploadEngine, mModel, mConfig.mMaxFramesInFlight);
+            }
+        }
+
+        mFrameRing = FrameContextRing::create(mDevice, mUniformManager, mConfig.mMaxFramesInFlight);
+
+        mDevice->getAllocator()->printStats();
+    }
+
+    // 实例化基准场景：在 XY 平面上按正方形网格铺开实例，相机拉远到能看到整个网格
+    void Application::createInstances()
+    {
+        uint32_t  count   = mConfig.mInstanceCount;
+        uint32_t  side    = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+        glm::vec3 size    = mModel->getBoundsMax() - mModel->getBoundsMin();
+        float     spacing = std::max({ size.x, size.y, size.z, 0.01f }) * 1.2f;
+        float     center  = (side - 1) * 0.5f;
+
+        std::vector<glm::mat4> matrices(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float x = (static_cast<float>(i % side) - center) * spacing;
+            float y = (static_cast<float>(i / side) - center) * spacing;
+
+            matrices[i] = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.0f));
+        }
 
-        createSyncObjects();
+        mModel->setInstances(matrices, mDevice, mUploadEngine);
+        mModel->setCameraDistance(side * spacing * 0.9f + 2.0f);
+
+        std::cout << "Scene: " << count << " instances, " << (mConfig.mDrawPerObject ? "one draw per object" : "instanced draws") << std::endl;
     }
 
     void Application::createPipeline()
     {
-        VkViewport viewport = {};
-        viewport.x = 0.0f;
-        viewport.y = (float)mHeight;
-        viewport.width = (float)mWidth;
-        viewport.height = -(float)mHeight;
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
+        mPipeline = Wrapper::Pipeline::create(mDevice, mRenderPass);
+        setupPipeline(mPipeline, false);
 
-        VkRect2D scissor = {};
-        scissor.offset   = { 0, 0 };
-        scissor.extent   = { mWidth, mHeight };
+        if (mConfig.mDepthPrepass)
+        {
+            mDepthPrepassPipeline = Wrapper::Pipeline::create(mDevice, mRenderPass);
+            setupPipeline(mDepthPrepassPipeline, true);
+        }
+    }
 
-        mPipeline->setViewports({ viewport });
-        mPipeline->setScissors({ scissor });
+    // depthOnly 为深度预通道管线：只有顶点着色器、不写颜色；主管线在预通道之后只做相等深度的着色
+    void Application::setupPipeline(const Wrapper::Pipeline::Ptr& pipeline, bool depthOnly)
+    {
+        // 视口与裁剪在录制时设置，管线与交换链尺寸无关，窗口缩放时可以直接复用
+        pipeline->setDynamicStates({ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR });
 
         std::vector<Wrapper::Shader::Ptr> shaderGroup{};
 
         auto shaderVertex = Wrapper::Shader::create(mDevice, "shaders/vs.spv", VK_SHADER_STAGE_VERTEX_BIT, "main");
         shaderGroup.push_back(shaderVertex);
 
-        auto shaderFragment = Wrapper::Shader::create(mDevice, "shaders/fs.spv", VK_SHADER_STAGE_FRAGMENT_BIT, "main");
-        shaderGroup.push_back(shaderFragment);
+        if (!depthOnly)
+        {
+            auto shaderFragment = Wrapper::Shader::create(mDevice, "shaders/fs.spv", VK_SHADER_STAGE_FRAGMENT_BIT, "main");
+            shaderGroup.push_back(shaderFragment);
+        }
 
-        mPipeline->setShaderGroup(shaderGroup);
+        pipeline->setShaderGroup(shaderGroup);
 
         auto bindingDescription = mModel->getVertexInputBindingDescriptions();
         auto attributeDescriptions = mModel->getAttributeDescriptions();
 
-        mPipeline->mVertexInputState.vertexBindingDescriptionCount   = bindingDescription.size();
-        mPipeline->mVertexInputState.pVertexBindingDescriptions      = bindingDescription.data();
-        mPipeline->mVertexInputState.vertexAttributeDescriptionCount = attributeDescriptions.size();
-        mPipeline->mVertexInputState.pVertexAttributeDescriptions    = attributeDescriptions.data();
-
-        mPipeline->mAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        mPipeline->mAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        mPipeline->mAssemblyState.primitiveRestartEnable = VK_FALSE;
-
-        mPipeline->mRasterState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        mPipeline->mRasterState.polygonMode = VK_POLYGON_MODE_FILL;
-        mPipeline->mRasterState.lineWidth = 1.0f;
-        mPipeline->mRasterState.cullMode = VK_CULL_MODE_BACK_BIT;
-        mPipeline->mRasterState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-
-        mPipeline->mRasterState.depthBiasEnable         = VK_FALSE;
-        mPipeline->mRasterState.depthBiasConstantFactor = 0.0f;
-        mPipeline->mRasterState.depthBiasClamp          = 0.0f;
-        mPipeline->mRasterState.depthBiasSlopeFactor    = 0.0f;
-
-        mPipeline->mSampleState.sampleShadingEnable   = VK_FALSE;
-        mPipeline->mSampleState.rasterizationSamples  = VK_SAMPLE_COUNT_1_BIT;
-        mPipeline->mSampleState.minSampleShading      = 1.0f;
-        mPipeline->mSampleState.pSampleMask           = nullptr;
-        mPipeline->mSampleState.alphaToCoverageEnable = VK_FALSE;
-        mPipeline->mSampleState.alphaToOneEnable      = VK_FALSE;
-
-        mPipeline->mDepthStencilState.depthTestEnable = VK_FALSE;
-        mPipeline->mDepthStencilState.depthWriteEnable = VK_FALSE;
-        mPipeline->mDepthStencilState.depthCompareOp = VK_COMPARE_OP_LESS;
+        pipeline->mVertexInputState.vertexBindingDescriptionCount   = bindingDescription.size();
+        pipeline->mVertexInputState.pVertexBindingDescriptions      = bindingDescription.data();
+        pipeline->mVertexInputState.vertexAttributeDescriptionCount = attributeDescriptions.size();
+        pipeline->mVertexInputState.pVertexAttributeDescriptions    = attributeDescriptions.data();
+
+        pipeline->mAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        pipeline->mAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        pipeline->mAssemblyState.primitiveRestartEnable = VK_FALSE;
+
+        pipeline->mRasterState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        pipeline->mRasterState.polygonMode = VK_POLYGON_MODE_FILL;
+        pipeline->mRasterState.lineWidth = 1.0f;
+        pipeline->mRasterState.cullMode = VK_CULL_MODE_BACK_BIT;
+        pipeline->mRasterState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+        pipeline->mRasterState.depthBiasEnable         = VK_FALSE;
+        pipeline->mRasterState.depthBiasConstantFactor = 0.0f;
+        pipeline->mRasterState.depthBiasClamp          = 0.0f;
+        pipeline->mRasterState.depthBiasSlopeFactor    = 0.0f;
+
+        pipeline->mSampleState.sampleShadingEnable   = VK_FALSE;
+        pipeline->mSampleState.rasterizationSamples  = VK_SAMPLE_COUNT_1_BIT;
+        pipeline->mSampleState.minSampleShading      = 1.0f;
+        pipeline->mSampleState.pSampleMask           = nullptr;
+        pipeline->mSampleState.alphaToCoverageEnable = VK_FALSE;
+        pipeline->mSampleState.alphaToOneEnable      = VK_FALSE;
+
+        // 反向 Z：近处深度为 1、远处为 0，清除为 0，越近越“大”
+        // 有深度预通道时深度已经写好，主管线只让与之相等（最前面）的片元着色，不再写深度
+        bool shadeAfterPrepass = mConfig.mDepthPrepass && !depthOnly;
+
+        pipeline->mDepthStencilState.depthTestEnable  = VK_TRUE;
+        pipeline->mDepthStencilState.depthWriteEnable = shadeAfterPrepass ? VK_FALSE : VK_TRUE;
+        pipeline->mDepthStencilState.depthCompareOp   = shadeAfterPrepass ? VK_COMPARE_OP_GREATER_OR_EQUAL : VK_COMPARE_OP_GREATER;
+
+        pipeline->mDepthStencilState.depthBoundsTestEnable = VK_FALSE;
+        pipeline->mDepthStencilState.stencilTestEnable     = VK_FALSE;
 
         VkPipelineColorBlendAttachmentState blendAttachment{};
-        blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-                                         VK_COLOR_COMPONENT_G_BIT |
-                                         VK_COLOR_COMPONENT_B_BIT |
-                                         VK_COLOR_COMPONENT_A_BIT;
+        blendAttachment.colorWriteMask = depthOnly ? 0 : (VK_COLOR_COMPONENT_R_BIT |
+                                                          VK_COLOR_COMPONENT_G_BIT |
+                                                          VK_COLOR_COMPONENT_B_BIT |
+                                                          VK_COLOR_COMPONENT_A_BIT);
 
         blendAttachment.blendEnable         = VK_FALSE;
         blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
@@ -123,41 +271,42 @@ namespace LearnVulkan
         blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
         blendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
 
-        mPipeline->pushBlendAttachment(blendAttachment);
+        pipeline->pushBlendAttachment(blendAttachment);
 
-        mPipeline->mBlendState.logicOpEnable = VK_FALSE;
-        mPipeline->mBlendState.logicOp = VK_LOGIC_OP_COPY;
+        pipeline->mBlendState.logicOpEnable = VK_FALSE;
+        pipeline->mBlendState.logicOp = VK_LOGIC_OP_COPY;
 
-        mPipeline->mBlendState.blendConstants[0] = 0.0f;
-        mPipeline->mBlendState.blendConstants[1] = 0.0f;
-        mPipeline->mBlendState.blendConstants[2] = 0.0f;
-        mPipeline->mBlendState.blendConstants[3] = 0.0f;
+        pipeline->mBlendState.blendConstants[0] = 0.0f;
+        pipeline->mBlendState.blendConstants[1] = 0.0f;
+        pipeline->mBlendState.blendConstants[2] = 0.0f;
+        pipeline->mBlendState.blendConstants[3] = 0.0f;
 
-        mPipeline->mLayoutState.setLayoutCount = 1;
+        pipeline->mLayoutState.setLayoutCount = 1;
         auto layout = mUniformManager->getDescriptorLayout()->getLayout();
-        mPipeline->mLayoutState.pSetLayouts = &layout;
+        pipeline->mLayoutState.pSetLayouts = &layout;
 
-        mPipeline->mLayoutState.pushConstantRangeCount = 0;
-        mPipeline->mLayoutState.pPushConstantRanges = nullptr;
+        pipeline->mLayoutState.pushConstantRangeCount = 0;
+        pipeline->mLayoutState.pPushConstantRanges = nullptr;
 
-        mPipeline->build();
+        pipeline->build();
     }
 
     void Application::createRenderPass()
     {
         VkAttachmentDescription colorAttachment{};
-        colorAttachment.format         = mSwapChain->getFormat();
+        colorAttachment.format         = mOffscreenTarget != nullptr ? mOffscreenTarget->getFormat() : mSwapChain->getFormat();
         colorAttachment.samples        = VK_SAMPLE_COUNT_1_BIT;
         colorAttachment.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;      // 每次渲染前清除颜色附件
         colorAttachment.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;     // 渲染后存储颜色附件内容
         colorAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;  // 不关心模板附件的加载操作
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // 不关心模板附件的存储操作
         colorAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        colorAttachment.finalLayout    = mOffscreenTarget != nullptr ? Wrapper::OffscreenTarget::FINAL_LAYOUT : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         mRenderPass->addAttachment(colorAttachment);
 
-        /*VkAttachmentDescription depthAttachment{};
+        // 深度只在本通道内有效：清除后使用，结束时丢弃（DONT_CARE），tile 架构上不会写回显存
+        VkAttachmentDescription depthAttachment{};
         depthAttachment.format         = Wrapper::Image::findDepthFormat(mDevice);
         depthAttachment.samples        = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
@@ -167,19 +316,19 @@ namespace LearnVulkan
         depthAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
         depthAttachment.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
-        mRenderPass->addAttachment(depthAttachment);*/
+        mRenderPass->addAttachment(depthAttachment);
 
         VkAttachmentReference colorAttachmentRef{};
         colorAttachmentRef.attachment = 0;
         colorAttachmentRef.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-        /*VkAttachmentReference depthattachmentRef{};
+        VkAttachmentReference depthattachmentRef{};
         depthattachmentRef.attachment = 1;
-        depthattachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;*/
+        depthattachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
         Wrapper::SubPass subPass{};
         subPass.addColorAttachmentReference(colorAttachmentRef);
-        //subPass.setDepthStencilAttachmentReference(depthattachmentRef);
+        subPass.setDepthStencilAttachmentReference(depthattachmentRef);
         subPass.buildSubPassDescription();
 
         mRenderPass->addSubPass(subPass);
@@ -187,78 +336,221 @@ namespace LearnVulkan
         VkSubpassDependency dependency{};
         dependency.srcSubpass    = VK_SUBPASS_EXTERNAL;
         dependency.dstSubpass    = 0;
-        dependency.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.srcAccessMask = 0;
-        dependency.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependency.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependency.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
         mRenderPass->addDependency(dependency);
 
         mRenderPass->buildRenderPass();
     }
 
-    void Application::createCommandBuffers()
+    // 每帧把绘制录制进当前 FrameContext 的命令缓冲，目标帧缓冲由本帧获取到的交换链图像决定；返回录制的 draw 数量
+    // 开启多线程录制时，draw 列表按线程数切块，各线程录制自己的二级命令缓冲，主命令缓冲只负责渲染通道与 vkCmdExecuteCommands
+    uint32_t Application::recordCommandBuffer(const FrameContext::Ptr& frame, uint32_t imageIndex)
     {
-        for (int i = 0; i < mSwapChain->getImageCount(); ++i)
+        CPU_PROFILE_ZONE("Record");
+
+        const auto& commandBuffer = frame->getCommandBuffer();
+        uint32_t    drawCount     = mConfig.mDrawPerObject ? mModel->getInstanceCount() : mConfig.mRecordDraws;
+
+        if (mGpuCulling != nullptr)
+        {
+            drawCount = 1;
+        }
+
+        std::vector<VkCommandBuffer> secondaryCommandBuffers{};
+
+        // 每个录制槽位各自收集本帧采样的纹理，多线程录制时互不共享容器
+        for (auto& textures : mSampledTextures)
         {
-            mCommandBuffers[i] = Wrapper::CommandBuffer::create(mDevice, mCommandPool);
+            textures.clear();
+        }
+        mSampledTextures.resize(std::max<size_t>(mSampledTextures.size(), mConfig.mRecordThreads));
+
+        if (mConfig.mRecordThreads > 1)
+        {
+            uint32_t slotCount = std::min(mConfig.mRecordThreads, drawCount);
+            frame->prepareSecondaryCommandBuffers(slotCount);
+
+            VkCommandBufferInheritanceInfo inheritanceInfo{};
+            inheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            inheritanceInfo.renderPass  = mRenderPass->getRenderPass();
+            inheritanceInfo.subpass     = 0;
+            inheritanceInfo.framebuffer = getFrameBuffer(imageIndex);
+
+            // 二级命令缓冲在主命令缓冲的管线统计查询范围内执行，必须声明继承的统计项；
+            // 设备不支持 inheritedQueries 时不能这样做，主通道也就不开统计查询（见下面的 mainPassScope）
+            if (mDevice->supportsInheritedQueries())
+            {
+                inheritanceInfo.pipelineStatistics = mGpuProfiler->getStatistics();
+            }
+
+            mThreadPool->parallelFor(slotCount, [&](size_t slot)
+            {
+                CPU_PROFILE_ZONE("Record secondary");
+
+                const auto& secondary = frame->getSecondaryCommandBuffer(static_cast<uint32_t>(slot));
+
+                uint32_t firstDraw = static_cast<uint32_t>(uint64_t(drawCount) * slot / slotCount);
+                uint32_t lastDraw  = static_cast<uint32_t>(uint64_t(drawCount) * (slot + 1) / slotCount);
+
+                secondary->begin(VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, inheritanceInfo);
+                recordDraws(secondary, frame, firstDraw, lastDraw, mSampledTextures[slot]);
+                secondary->end();
+            });
+
+            for (uint32_t slot = 0; slot < slotCount; ++slot)
+            {
+                secondaryCommandBuffers.push_back(frame->getSecondaryCommandBuffer(slot)->getCommandBuffer());
+            }
+        }
 
-            mCommandBuffers[i]->begin();
+        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
-            VkRenderPassBeginInfo renderBeginInfo{};
-            renderBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderBeginInfo.renderPass        = mRenderPass->getRenderPass();
-            renderBeginInfo.framebuffer       = mSwapChain->getFrameBuffer(i);
-            renderBeginInfo.renderArea.offset = { 0, 0 };
-            renderBeginInfo.renderArea.extent = mSwapChain->getExtent();
+        // 读回本上下文上一次的计时结果并重置查询，此后才能开始作用域
+        mGpuProfiler->beginFrame(commandBuffer, frame->getIndex());
 
-            VkClearValue clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
-            renderBeginInfo.clearValueCount = 1;
-            renderBeginInfo.pClearValues = &clearColor;
+        Wrapper::GpuProfiler::Scope frameScope(mGpuProfiler, commandBuffer, "Frame");
 
-            /*std::vector<VkClearValue> clearColors;
-            VkClearValue clearColor;
-            clearColor.color = { 0.0f, 0.0f, 0.0f, 1.0f };
-            clearColors.push_back(clearColor);
+        // 剔除的 dispatch 不能放进渲染通道，在开始通道前录制
+        if (mGpuCulling != nullptr)
+        {
+            Wrapper::GpuProfiler::Scope cullScope(mGpuProfiler, commandBuffer, "Cull");
 
-            VkClearValue depthClearColor;
-            depthClearColor.depthStencil = { 1.0f, 0 };
-            clearColors.push_back(depthClearColor);
+            const auto& vpUniform = mModel->getVPUniform();
+            mGpuCulling->cull(commandBuffer, frame->getIndex(), vpUniform.mProjectionMatrix * vpUniform.mViewMatrix, mModel->getUniform().mModelMatrix);
+        }
 
-            renderBeginInfo.clearValueCount = static_cast<uint32_t>(clearColors.size());
-            renderBeginInfo.pClearValues    = clearColors.data();*/
+        VkRenderPassBeginInfo renderBeginInfo{};
+        renderBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderBeginInfo.renderPass        = mRenderPass->getRenderPass();
+        renderBeginInfo.framebuffer       = getFrameBuffer(imageIndex);
+        renderBeginInfo.renderArea.offset = { 0, 0 };
+        renderBeginInfo.renderArea.extent = getRenderExtent();
 
-            mCommandBuffers[i]->beginRenderPass(renderBeginInfo);
+        std::vector<VkClearValue> clearColors;
+        VkClearValue clearColor;
+        clearColor.color = { 0.0f, 0.0f, 0.0f, 1.0f };
+        clearColors.push_back(clearColor);
 
-            mCommandBuffers[i]->bindGraphicPipeline(mPipeline->getPipeline());
+        // 反向 Z：远平面深度为 0
+        VkClearValue depthClearColor;
+        depthClearColor.depthStencil = { 0.0f, 0 };
+        clearColors.push_back(depthClearColor);
 
-            mCommandBuffers[i]->bindDescriptorSet(mPipeline->getLayout(), mUniformManager->getDescriptorSet(mCurrentFrame));
+        renderBeginInfo.clearValueCount = static_cast<uint32_t>(clearColors.size());
+        renderBeginInfo.pClearValues    = clearColors.data();
 
-            //mCommandBuffers[i]->bindVertexBuffer({ mModel->getVertexBuffer()->getBuffer() });
+        // 查询在渲染通道外开始和结束，覆盖整个通道（包括二级命令缓冲，需要 inheritedQueries）
+        {
+            bool statistics = secondaryCommandBuffers.empty() || mDevice->supportsInheritedQueries();
 
-            mCommandBuffers[i]->bindVertexBuffer(mModel->getVertexBuffers());
+            Wrapper::GpuProfiler::Scope mainPassScope(mGpuProfiler, commandBuffer, "Main pass", statistics);
 
-            mCommandBuffers[i]->bindIndexBuffer(mModel->getIndexBuffer()->getBuffer());
+            if (secondaryCommandBuffers.empty())
+            {
+                commandBuffer->beginRenderPass(renderBeginInfo);
 
-            mCommandBuffers[i]->drawIndex(mModel->getIndexCount());
+                recordDraws(commandBuffer, frame, 0, drawCount, mSampledTextures[0]);
+            }
+            else
+            {
+                commandBuffer->beginRenderPass(renderBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-            mCommandBuffers[i]->endRenderPass();
+                commandBuffer->executeCommands(secondaryCommandBuffers);
+            }
 
-            mCommandBuffers[i]->end();
+            commandBuffer->endRenderPass();
         }
+
+        frameScope.end();
+
+        commandBuffer->end();
+
+        return drawCount;
     }
 
-    void Application::createSyncObjects()
+    // 录制 draw 列表中 [firstDraw, lastDraw) 的部分；二级命令缓冲不继承绑定与动态状态，所以每段都要重新设置
+    // 实例化路径每个 draw 画出全部实例；逐物体路径每个实例一个 draw，并重新绑定它自己的物体 uniform 偏移；
+    // GPU 剔除路径只录制间接绘制，命令与数量由本帧之前的 dispatch 写入；
+    // 本段真正录制了着色绘制时，把它们绑定的片元阶段纹理追加到 sampledTextures（深度预通道没有片元着色器，不采样）
+    void Application::recordDraws(const Wrapper::CommandBuffer::Ptr& commandBuffer, const FrameContext::Ptr& frame, uint32_t firstDraw, uint32_t lastDraw, std::vector<Texture::Ptr>& sampledTextures)
     {
-        mFences.resize(mSwapChain->getImageCount());
-        for (int i = 0; i < mSwapChain->getImageCount(); ++i)
+        // 深度预通道与主管线的布局相同，描述符集与动态状态在切换管线后仍然有效
+        commandBuffer->bindGraphicPipeline(mDepthPrepassPipeline != nullptr ? mDepthPrepassPipeline->getPipeline() : mPipeline->getPipeline());
+
+        VkExtent2D extent = getRenderExtent();
+
+        VkViewport viewport = {};
+        viewport.x = 0.0f;
+        viewport.y = (float)extent.height;
+        viewport.width = (float)extent.width;
+        viewport.height = -(float)extent.height;
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+
+        VkRect2D scissor = {};
+        scissor.offset   = { 0, 0 };
+        scissor.extent   = extent;
+
+        commandBuffer->setViewport(viewport);
+        commandBuffer->setScissor(scissor);
+
+        commandBuffer->bindDescriptorSet(mPipeline->getLayout(), frame->getDescriptorSet(), mUniformManager->getDynamicOffsets(static_cast<int>(frame->getIndex())));
+
+        //commandBuffer->bindVertexBuffer({ mModel->getVertexBuffer()->getBuffer() });
+
+        commandBuffer->bindVertexBuffer(mModel->getVertexBuffers());
+
+        commandBuffer->bindIndexBuffer(mModel->getIndexBuffer()->getBuffer(), mModel->getIndexType());
+
+        auto drawList = [&]()
         {
-            mFences[i] = Wrapper::Fence::create(mDevice);
+            if (mGpuCulling != nullptr)
+            {
+                if (firstDraw < lastDraw)
+                {
+                    mGpuCulling->draw(commandBuffer, frame->getIndex());
+                }
+            }
+            else if (mConfig.mDrawPerObject)
+            {
+                int frameIndex = static_cast<int>(frame->getIndex());
+
+                for (uint32_t i = firstDraw; i < lastDraw; ++i)
+                {
+                    commandBuffer->bindDescriptorSet(mPipeline->getLayout(), frame->getDescriptorSet(), mUniformManager->getDynamicOffsets(frameIndex, mObjectOffsets[i]));
+                    commandBuffer->drawIndex(mModel->getIndexCount(), 1, i);
+                }
+            }
+            else
+            {
+                for (uint32_t i = firstDraw; i < lastDraw; ++i)
+                {
+                    commandBuffer->drawIndex(mModel->getIndexCount(), mModel->getInstanceCount());
+                }
+            }
+        };
+
+        drawList();
+
+        if (mDepthPrepassPipeline != nullptr)
+        {
+            commandBuffer->bindGraphicPipeline(mPipeline->getPipeline());
+            drawList();
+        }
+
+        // GPU 剔除时 CPU 不知道哪些实例留下，只要录制了间接绘制就保守地记为采样
+        if (firstDraw < lastDraw)
+        {
+            mUniformManager->getBoundTextures(VK_SHADER_STAGE_FRAGMENT_BIT, sampledTextures);
         }
-        mImageAvailableSemaphore = Wrapper::Semaphore::create(mDevice, true);
-        mRenderFinishedSemaphore = Wrapper::Semaphore::create(mDevice, true);
     }
 
-    // 重建交换链：当窗口大小发生变化的时候，交换链需要被重建，Framebuffers、RenderPass、Pipeline等也需要重新创建
+    // 重建交换链：当窗口大小发生变化的时候，交换链与 Framebuffers 需要被重建
+    // 视口与裁剪是动态状态，只有表面格式变化时才重建 RenderPass 与 Pipeline；
+    // 旧交换链作为 oldSwapchain 传入，并延迟到引用它的帧在 GPU 上完成、呈现队列空闲后再销毁，不再 vkDeviceWaitIdle
     void Application::recreateSwapChain()
     {
         int width = 0, height = 0;
@@ -270,68 +562,162 @@ namespace LearnVulkan
             glfwGetFramebufferSize(mWindow->getWindow(), &width, &height);
         }
 
-        vkDeviceWaitIdle(mDevice->getDevice());
-
-        cleanupSwapChain();
+        auto oldSwapChain = mSwapChain;
 
-        mSwapChain = Wrapper::SwapChain::create(mDevice, mWindow, mSurface, mCommandPool);
+        mSwapChain = Wrapper::SwapChain::create(mDevice, mWindow, mSurface, mCommandPool, oldSwapChain);
         mWidth = mSwapChain->getExtent().width;
         mHeight = mSwapChain->getExtent().height;
 
-        mRenderPass = Wrapper::RenderPass::create(mDevice);
-        createRenderPass();
+        // 等到新交换链上的第一帧完成时，旧交换链的帧缓冲不再被使用；呈现还要等呈现队列空闲（见 releaseRetiredSwapChains）
+        mRetiredSwapChains.emplace_back(oldSwapChain, mFrameRing->getSignalValue());
 
-        mSwapChain->createFrameBuffers(mRenderPass);
+        if (mSwapChain->getFormat() != oldSwapChain->getFormat())
+        {
+            // 格式变化很少见：只等待已提交的帧，而不是整个设备
+            mFrameRing->waitIdle();
 
-        mPipeline = Wrapper::Pipeline::create(mDevice, mRenderPass);
-        createPipeline();
+            mRenderPass = Wrapper::RenderPass::create(mDevice);
+            createRenderPass();
 
-        mCommandBuffers.resize(mSwapChain->getImageCount());
-        createCommandBuffers();
+            createPipeline();
+        }
 
-        createSyncObjects();
+        mSwapChain->createFrameBuffers(mRenderPass);
     }
 
-    void Application::cleanupSwapChain()
+    VkFramebuffer Application::getFrameBuffer(uint32_t imageIndex) const
     {
-        mSwapChain.reset();
-        mCommandBuffers.clear();
-        mPipeline.reset();
-        mRenderPass.reset();
-        mImageAvailableSemaphore.reset();
-        mRenderFinishedSemaphore.reset();
-        mFences.clear();
+        return mOffscreenTarget != nullptr ? mOffscreenTarget->getFrameBuffer(imageIndex) : mSwapChain->getFrameBuffer(imageIndex);
     }
 
+    VkExtent2D Application::getRenderExtent() const
+    {
+        return mOffscreenTarget != nullptr ? mOffscreenTarget->getExtent() : mSwapChain->getExtent();
+    }
+
+    void Application::releaseRetiredSwapChains()
+    {
+        if (mRetiredSwapChains.empty())
+        {
+            return;
+        }
+
+        uint64_t completedValue = mFrameRing->getCompletedValue();
+
+        if (mRetiredSwapChains.front().second > completedValue)
+        {
+            return;
+        }
+
+        // 时间线只说明渲染提交已完成；等待旧交换链每图像渲染完成信号量的 vkQueuePresentKHR 没有可等待的对象，
+        // 呈现引擎可能还没消费这些信号量。vkQueueWaitIdle 等待呈现队列上提交的所有操作（包括呈现对信号量的等待）完成，
+        // 之后销毁信号量与交换链是安全的；只在窗口大小变化后的一帧发生一次，不影响稳态帧率
+        vkQueueWaitIdle(mDevice->getPresentQueue());
+
+        mRetiredSwapChains.erase(std::remove_if(mRetiredSwapChains.begin(), mRetiredSwapChains.end(),
+                                                [completedValue](const auto& retired) { return retired.second <= completedValue; }),
+                                 mRetiredSwapChains.end());
+    }
+
+    // --frames 为 0 时一直运行到窗口关闭；离屏模式总是在渲染完指定帧数后退出
     void Application::mainLoop()
     {
-        while (!mWindow->shouldClose())
+        mStartTime = std::chrono::high_resolution_clock::now();
+
+        while (mConfig.mFrameCount == 0 || mRenderedFrameCount < mConfig.mFrameCount)
         {
-            mWindow->pollEvents();
+            auto frameStart = std::chrono::high_resolution_clock::now();
+
+            if (mWindow != nullptr)
+            {
+                if (mWindow->shouldClose())
+                {
+                    break;
+                }
+
+                mWindow->pollEvents();
+            }
 
-            mModel->update(mWidth, mHeight);
+            {
+                CPU_PROFILE_ZONE("Model::update");
 
-            mUniformManager->update(mModel->getVPUniform(), mModel->getUniform(), mCurrentFrame);
+                float time = mConfig.mFixedTimestep > 0.0
+                           ? static_cast<float>(mRenderedFrameCount * mConfig.mFixedTimestep)
+                           : std::chrono::duration<float>(frameStart - mStartTime).count();
+
+                if (mCameraPath != nullptr)
+                {
+                    glm::vec3 eye{};
+                    glm::vec3 target{};
+                    mCameraPath->evaluate(time, eye, target);
+                    mModel->setCamera(eye, target);
+                }
+
+                mModel->update(mWidth, mHeight, time);
+            }
 
             render();
+
+            if (mConfig.mCollectFrameTimings)
+            {
+                mFrameTimings.mCpuMilliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count());
+            }
         }
 
         vkDeviceWaitIdle(mDevice->getDevice());
+
+        // 最后 frames-in-flight 帧的 GPU 计时此时才可读
+        mGpuProfiler->flush();
+
+        if (mConfig.mCollectFrameTimings)
+        {
+            VkPhysicalDeviceProperties properties{};
+            vkGetPhysicalDeviceProperties(mDevice->getPhysicalDevice(), &properties);
+
+            mFrameTimings.mDeviceName = properties.deviceName;
+            mFrameTimings.mHeapStats  = mDevice->getAllocator()->getHeapStats();
+        }
+
+        // 交换链图像没有 TRANSFER_SRC 用途，只有离屏模式能读回
+        if (!mConfig.mCapturePath.empty())
+        {
+            if (mOffscreenTarget == nullptr)
+            {
+                std::cout << "Warning: --capture requires --headless, " << mConfig.mCapturePath << " not written" << std::endl;
+            }
+            else if (mRenderedFrameCount > 0)
+            {
+                mOffscreenTarget->saveImage(mLastImageIndex, mCommandPool, mConfig.mCapturePath);
+                std::cout << "Captured frame " << mRenderedFrameCount << " to " << mConfig.mCapturePath << std::endl;
+            }
+        }
     }
 
     void Application::render()
     {
+        CPU_PROFILE_ZONE("Frame");
+
 #pragma region Draw
 
-        mFences[mCurrentFrame]->block();
+        // 只等待本上下文上一次的提交，其余 frames-in-flight - 1 帧仍可在 GPU 上执行
+        const FrameContext::Ptr& frame = mFrameRing->beginFrame();
 
-        uint32_t imageIndex{ 0 };
-        VkResult result = vkAcquireNextImageKHR(mDevice->getDevice(),
-                                                mSwapChain->getSwapChain(),
-                                                UINT64_MAX,
-                                                mImageAvailableSemaphore->getSemaphore(),
-                                                VK_NULL_HANDLE,
-                                                &imageIndex);
+        releaseRetiredSwapChains();
+
+        // 离屏模式直接使用上下文自己的目标，beginFrame 已保证它上一次的渲染完成
+        uint32_t imageIndex{ frame->getIndex() };
+        VkResult result{ VK_SUCCESS };
+        if (mSwapChain != nullptr)
+        {
+            CPU_PROFILE_ZONE("vkAcquireNextImageKHR");
+
+            result = vkAcquireNextImageKHR(mDevice->getDevice(),
+                                           mSwapChain->getSwapChain(),
+                                           UINT64_MAX,
+                                           frame->getImageAvailableSemaphore()->getSemaphore(),
+                                           VK_NULL_HANDLE,
+                                           &imageIndex);
+        }
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
@@ -344,64 +730,167 @@ namespace LearnVulkan
             throw std::runtime_error("Error: failed to acquire next image!");
         }
 
-        VkTimelineSemaphoreSubmitInfo submitTimelineInfo{};
-        submitTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        auto uniformStart = std::chrono::high_resolution_clock::now();
 
-        VkSemaphore waitSemaphores           = mImageAvailableSemaphore->getSemaphore();
-        uint64_t waitValues[]                = { 0 };
-        submitTimelineInfo.waitSemaphoreValueCount = 1;
-        submitTimelineInfo.pWaitSemaphoreValues    = waitValues;
+        // 上下文的 uniform 分片此时已不被 GPU 读取
+        mUniformManager->update(mModel->getVPUniform(), mModel->getUniform(), static_cast<int>(frame->getIndex()));
 
-        VkSemaphore signalSemaphores           = mRenderFinishedSemaphore->getSemaphore();
-        uint64_t signalValues[]                = { mCurrentValue };
-        submitTimelineInfo.signalSemaphoreValueCount = 1;
-        submitTimelineInfo.pSignalSemaphoreValues    = signalValues;
+        // 流式纹理的上传在下面的 flush 中随本帧提交，本帧的描述符集此时已可改写
+        mUniformManager->streamTextures(mUploadEngine, static_cast<int>(frame->getIndex()));
+
+        // 逐物体路径：每个实例一份物体 uniform，录制前在主线程写入，录制线程只读偏移
+        mObjectOffsets.clear();
+        if (mConfig.mDrawPerObject)
+        {
+            for (uint32_t i = 0; i < mModel->getInstanceCount(); ++i)
+            {
+                mObjectOffsets.push_back(mUniformManager->pushObject(mModel->getUniform(), static_cast<int>(frame->getIndex())));
+            }
+        }
+
+        auto recordStart = std::chrono::high_resolution_clock::now();
+
+        uint32_t drawCount = recordCommandBuffer(frame, imageIndex);
+
+        // 只有本帧录制的着色绘制绑定的纹理才记为被采样，常驻管理按最近采样帧做 LRU 降级
+        for (const auto& textures : mSampledTextures)
+        {
+            for (const auto& texture : textures)
+            {
+                mUniformManager->getTextureResidency()->markSampled(texture);
+            }
+        }
+
+        auto recordEnd = std::chrono::high_resolution_clock::now();
+
+        mUniformMicroseconds += std::chrono::duration<double, std::micro>(recordStart - uniformStart).count();
+        mRecordMicroseconds  += std::chrono::duration<double, std::micro>(recordEnd - recordStart).count();
+        mRecordDrawCount     += drawCount;
+
+        std::vector<VkSemaphore>          waitSemaphores{};
+        std::vector<uint64_t>             waitValues{};
+        std::vector<VkPipelineStageFlags> waitStages{};
+
+        std::vector<VkSemaphore> signalSemaphores{ mFrameRing->getTimelineSemaphore()->getSemaphore() };
+        std::vector<uint64_t>    signalValues{ mFrameRing->getSignalValue() };
+
+        // 离屏模式没有要等待的交换链图像，也没有呈现
+        if (mSwapChain != nullptr)
+        {
+            waitSemaphores.push_back(frame->getImageAvailableSemaphore()->getSemaphore());
+            waitValues.push_back(0);
+            waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+            signalSemaphores.push_back(mSwapChain->getRenderFinishedSemaphore(imageIndex)->getSemaphore());
+            signalValues.push_back(0);
+        }
+
+        std::vector<VkCommandBuffer> commandBuffers{};
+
+        // 提交本帧之前累积的上传；只有确实有新上传时，渲染才在首次使用的阶段等待对应的时间线值
+        Wrapper::UploadEngine::FrameDependency uploadDependency{};
+        if (mUploadEngine->flush(uploadDependency))
+        {
+            waitSemaphores.push_back(uploadDependency.mWaitSemaphore);
+            waitValues.push_back(uploadDependency.mWaitValue);
+            waitStages.push_back(uploadDependency.mWaitStage);
+
+            signalSemaphores.push_back(uploadDependency.mSignalSemaphore);
+            signalValues.push_back(uploadDependency.mSignalValue);
+
+            commandBuffers.push_back(uploadDependency.mAcquireCommandBuffer);
+        }
+
+        commandBuffers.push_back(frame->getCommandBuffer()->getCommandBuffer());
+
+        // 二值信号量对应的值会被忽略
+        VkTimelineSemaphoreSubmitInfo submitTimelineInfo{};
+        submitTimelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        submitTimelineInfo.waitSemaphoreValueCount   = static_cast<uint32_t>(waitValues.size());
+        submitTimelineInfo.pWaitSemaphoreValues      = waitValues.data();
+        submitTimelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+        submitTimelineInfo.pSignalSemaphoreValues    = signalValues.data();
 
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submitInfo.pNext = &submitTimelineInfo;
 
-        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-        submitInfo.waitSemaphoreCount   = 1;
-        submitInfo.pWaitSemaphores      = &waitSemaphores;
-        submitInfo.pWaitDstStageMask    = waitStages;
+        submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+        submitInfo.pWaitSemaphores    = waitSemaphores.data();
+        submitInfo.pWaitDstStageMask  = waitStages.data();
+
+        submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+        submitInfo.pCommandBuffers    = commandBuffers.data();
+
+        submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+        submitInfo.pSignalSemaphores    = signalSemaphores.data();
 
-        auto commandBuffer            = mCommandBuffers[imageIndex]->getCommandBuffer();
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers    = &commandBuffer;
+        auto submitStart = std::chrono::high_resolution_clock::now();
 
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = &signalSemaphores;
+        {
+            CPU_PROFILE_ZONE("vkQueueSubmit");
+
+            if (vkQueueSubmit(mDevice->getGraphicQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Error: failed to submit renderCommand!");
+            }
+        }
 
-        mFences[mCurrentFrame]->resetFence();
+        mSubmitMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - submitStart).count();
 
-        if (vkQueueSubmit(mDevice->getGraphicQueue(), 1, &submitInfo, mFences[mCurrentFrame]->getFence()) != VK_SUCCESS)
+        mFrameRing->endFrame();
+
+        mLastImageIndex = imageIndex;
+        ++mRenderedFrameCount;
+
+        if (++mRecordFrameCount == RECORD_STATS_INTERVAL)
         {
-            throw std::runtime_error("Error: failed to submit renderCommand!");
+            double cpuMicroseconds = mUniformMicroseconds + mRecordMicroseconds + mSubmitMicroseconds;
+
+            std::cout << "CPU: " << cpuMicroseconds / mRecordFrameCount << " us/frame (uniforms "
+                      << mUniformMicroseconds / mRecordFrameCount << ", record "
+                      << mRecordMicroseconds / mRecordFrameCount << ", submit "
+                      << mSubmitMicroseconds / mRecordFrameCount << "), record "
+                      << mRecordMicroseconds / mRecordDrawCount << " us/draw ("
+                      << mRecordDrawCount / mRecordFrameCount << " draws/frame, "
+                      << mModel->getInstanceCount() << " instances)" << std::endl;
+
+            mGpuProfiler->printStats();
+            mUniformManager->getTextureResidency()->printStats();
+
+            mUniformMicroseconds = 0.0;
+            mSubmitMicroseconds  = 0.0;
+            mRecordMicroseconds  = 0.0;
+            mRecordDrawCount     = 0;
+            mRecordFrameCount    = 0;
         }
 
 #pragma endregion
 
 #pragma region Present
 
-        VkTimelineSemaphoreSubmitInfo presentTimelineInfo{};
-        presentTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
-        presentTimelineInfo.waitSemaphoreValueCount = 1;
-        presentTimelineInfo.pWaitSemaphoreValues = signalValues;
+        if (mSwapChain == nullptr)
+        {
+            return;
+        }
 
+        VkSemaphore renderFinishedSemaphore = mSwapChain->getRenderFinishedSemaphore(imageIndex)->getSemaphore();
 
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-        presentInfo.pNext = &presentTimelineInfo;
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &signalSemaphores;
+        presentInfo.pWaitSemaphores = &renderFinishedSemaphore;
 
         VkSwapchainKHR swapChains[] = { mSwapChain->getSwapChain() };
         presentInfo.swapchainCount = 1;
         presentInfo.pSwapchains = swapChains;
         presentInfo.pImageIndices = &imageIndex;
 
-        result = vkQueuePresentKHR(mDevice->getPresentQueue(), &presentInfo);
+        {
+            CPU_PROFILE_ZONE("vkQueuePresentKHR");
+
+            result = vkQueuePresentKHR(mDevice->getPresentQueue(), &presentInfo);
+        }
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || mWindow->mWindowResized)
         {
@@ -414,16 +903,21 @@ namespace LearnVulkan
         }
 
 #pragma endregion
-
-        mCurrentFrame = (mCurrentFrame + 1) % mSwapChain->getImageCount();
-        mCurrentValue++;
     }
 
     void Application::cleanUp()
     {
+        mThreadPool.reset();
+        mGpuCulling.reset();
+        mGpuProfiler.reset();
+        mFrameRing.reset();
+        mRetiredSwapChains.clear();
+        mUploadEngine.reset();
+        mDepthPrepassPipeline.reset();
         mPipeline.reset();
         mRenderPass.reset();
         mSwapChain.reset();
+        mOffscreenTarget.reset();
         mDevice.reset();
         mSurface.reset();
         mInstance.reset();
@@ -7,14 +7,18 @@
 #include "vulkanWrapper/window.h"
 #include "vulkanWrapper/windowSurface.h"
 #include "vulkanWrapper/swapChain.h"
+#include "vulkanWrapper/offscreenTarget.h"
 #include "vulkanWrapper/shader.h"
 #include "vulkanWrapper/pipeline.h"
+#include "vulkanWrapper/gpuProfiler.h"
+#include "vulkanWrapper/cpuProfiler.h"
 #include "vulkanWrapper/renderPass.h"
 #include "vulkanWrapper/commandPool.h"
 #include "vulkanWrapper/commandBuffer.h"
 #include "vulkanWrapper/semaphore.h"
 #include "vulkanWrapper/fence.h"
 #include "vulkanWrapper/buffer.h"
+#include "vulkanWrapper/uploadEngine.h"
 #include "vulkanWrapper/descriptorSetLayout.h"
 #include "vulkanWrapper/descriptorPool.h"
 #include "vulkanWrapper/descriptorSet.h"
@@ -25,28 +29,50 @@
 #include "texture/texture.h"
 
 #include "model.h"
+#include "frameContext.h"
+#include "gpuCulling.h"
+#include "cameraPath.h"
+#include "appConfig.h"
+#include "threadPool.h"
 
 namespace LearnVulkan
 {
+    /// 逐帧计时与显存高水位，AppConfig::mCollectFrameTimings 为 true 时记录
+    struct FrameTimings
+    {
+        std::string                                mDeviceName{};
+        std::vector<double>                        mCpuMilliseconds{};   // 每次主循环迭代（更新 + 录制 + 提交 + 呈现）的墙钟时间
+        std::map<std::string, std::vector<double>> mGpuMilliseconds{};   // 按 GPU 计时作用域名，顺序与帧序号一致
+        std::vector<Wrapper::MemoryHeapStats>      mHeapStats{};         // 主循环结束时的各堆统计（含高水位）
+    };
+
     class Application
     {
     public:
-        Application()  = default;
+        explicit Application(const AppConfig& config = {}) : mConfig(config) {}
         ~Application() = default;
 
         void run();
 
+        [[nodiscard]] const FrameTimings& getFrameTimings() const { return mFrameTimings; }
+
     private:
         void initWindow();
         void initVulkan();
         void createPipeline();
+        void setupPipeline(const Wrapper::Pipeline::Ptr& pipeline, bool depthOnly);
         void createRenderPass();
-        void createCommandBuffers();
-        void createSyncObjects();
+        uint32_t recordCommandBuffer(const FrameContext::Ptr& frame, uint32_t imageIndex);
+        void recordDraws(const Wrapper::CommandBuffer::Ptr& commandBuffer, const FrameContext::Ptr& frame, uint32_t firstDraw, uint32_t lastDraw, std::vector<Texture::Ptr>& sampledTextures);
+        void createInstances();
         void mainLoop();
         void render();
         void recreateSwapChain();
-        void cleanupSwapChain();
+        void releaseRetiredSwapChains();
+
+        /// 当前渲染目标（交换链或离屏目标）的帧缓冲与尺寸
+        VkFramebuffer getFrameBuffer(uint32_t imageIndex) const;
+        VkExtent2D getRenderExtent() const;
         void cleanUp();
 
     private:
@@ -54,7 +80,7 @@ namespace LearnVulkan
         unsigned int mHeight{ 720 };
 
     private:
-        int                         mCurrentFrame{ 0 };
+        AppConfig                   mConfig{};
         Wrapper::Window::Ptr        mWindow{ nullptr };
         Wrapper::FeaturesChain::Ptr mFeaturesChain{ nullptr };
         Wrapper::Instance::Ptr      mInstance{ nullptr };
@@ -62,20 +88,50 @@ namespace LearnVulkan
         Wrapper::WindowSurface::Ptr mSurface{ nullptr };
         Wrapper::SwapChain::Ptr     mSwapChain{ nullptr };
         Wrapper::Pipeline::Ptr      mPipeline{ nullptr };
+        Wrapper::Pipeline::Ptr      mDepthPrepassPipeline{ nullptr };
         Wrapper::RenderPass::Ptr    mRenderPass{ nullptr };
 
-        Wrapper::CommandPool::Ptr                mCommandPool{ nullptr };
-        std::vector<Wrapper::CommandBuffer::Ptr> mCommandBuffers{};
+        // 离屏模式下代替交换链
+        Wrapper::OffscreenTarget::Ptr mOffscreenTarget{ nullptr };
+
+        Wrapper::CommandPool::Ptr  mCommandPool{ nullptr };
+        Wrapper::UploadEngine::Ptr mUploadEngine{ nullptr };
+        FrameContextRing::Ptr      mFrameRing{ nullptr };
+        ThreadPool::Ptr            mThreadPool{ nullptr };  // 加载时解析 / 解码与多线程录制共用
 
-        //std::vector<Wrapper::Semaphore::Ptr> mImageAvailableSemaphores{};
-        //std::vector<Wrapper::Semaphore::Ptr> mRenderFinishedSemaphores{};
-        Wrapper::Semaphore::Ptr          mImageAvailableSemaphore;
-        Wrapper::Semaphore::Ptr          mRenderFinishedSemaphore;
-        uint64_t                         mCurrentValue{ 0 };
-        std::vector<Wrapper::Fence::Ptr> mFences{};
+        // 被替换的交换链及其可以销毁时的帧时间线值
+        std::vector<std::pair<Wrapper::SwapChain::Ptr, uint64_t>> mRetiredSwapChains{};
 
         UniformManager::Ptr mUniformManager{ nullptr };
         Model::Ptr          mModel{ nullptr };
+        GpuCulling::Ptr     mGpuCulling{ nullptr };
         VPMatrices          mVPMatrices;
+
+        // 动画时钟：固定步长时为已提交帧数 * 步长，否则为从主循环开始的墙钟时间
+        std::chrono::high_resolution_clock::time_point mStartTime{};
+        CameraPath::Ptr                                mCameraPath{ nullptr };
+        FrameTimings                                   mFrameTimings{};
+
+        // 已提交的帧数与最后一帧使用的目标图像（离屏模式在退出时读回它）
+        uint64_t mRenderedFrameCount{ 0 };
+        uint32_t mLastImageIndex{ 0 };
+
+        // 逐物体绘制时本帧每个实例的物体 uniform 动态偏移
+        std::vector<uint32_t> mObjectOffsets{};
+
+        // [录制槽位] 本帧该槽位录制的着色绘制所绑定、片元着色器会采样的纹理，录制后交给纹理常驻管理记为已采样
+        std::vector<std::vector<Texture::Ptr>> mSampledTextures{};
+
+        // CPU 开销统计（物体 uniform 写入 / 录制 / vkQueueSubmit），每 RECORD_STATS_INTERVAL 帧输出一次
+        static constexpr uint32_t RECORD_STATS_INTERVAL = 1000;
+
+        double   mUniformMicroseconds{ 0.0 };
+        double   mSubmitMicroseconds{ 0.0 };
+        double   mRecordMicroseconds{ 0.0 };
+        uint64_t mRecordDrawCount{ 0 };
+        uint32_t mRecordFrameCount{ 0 };
+
+        // GPU 各通道耗时与主通道的片元着色器调用次数，随 CPU 统计一起输出
+        Wrapper::GpuProfiler::Ptr mGpuProfiler{ nullptr };
     };
 }
@@ -0,0 +1,270 @@
+﻿// OBJ 解析基准：tinyobj（当前 Model 的旧路径）对比多线程 ObjLoader
+//
+// 用法：Bona_objloader_bench [--triangles N] [--threads N] [--repeat N] [file.obj ...]
+// 不给文件时测试自带的 diablo3_pose.obj 和一份合成的 N 三角形网格（默认 1000 万，约 1 GB），
+// 合成文件写在系统临时目录中，测试结束后删除
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "../tiny_obj_loader.h"
+
+#include "../mesh/objLoader.h"
+
+using namespace LearnVulkan;
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double elapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /// 生成一个规则网格 OBJ，每个格子两个三角形，带 vt / vn
+    void writeSyntheticObj(const std::string& path, size_t triangleCount)
+    {
+        size_t side = static_cast<size_t>(std::ceil(std::sqrt(triangleCount / 2.0)));
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            throw std::runtime_error("Error: failed to create " + path);
+        }
+
+        std::vector<char> buffer(1 << 20);
+        setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+        fprintf(file, "# synthetic grid, %zu triangles\n", triangleCount);
+
+        for (size_t y = 0; y <= side; ++y)
+        {
+            for (size_t x = 0; x <= side; ++x)
+            {
+                float u = static_cast<float>(x) / side;
+                float v = static_cast<float>(y) / side;
+                fprintf(file, "v %.6f %.6f %.6f\n", u * 2.0f - 1.0f, std::sin(u * 6.2831853f) * 0.1f, v * 2.0f - 1.0f);
+                fprintf(file, "vt %.6f %.6f\n", u, v);
+                fprintf(file, "vn 0.000000 1.000000 0.000000\n");
+            }
+        }
+
+        size_t written = 0;
+        for (size_t y = 0; y < side && written < triangleCount; ++y)
+        {
+            for (size_t x = 0; x < side && written < triangleCount; ++x)
+            {
+                size_t a = y * (side + 1) + x + 1;
+                size_t b = a + 1;
+                size_t c = a + side + 1;
+                size_t d = c + 1;
+
+                fprintf(file, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, b, b, b, d, d, d);
+                ++written;
+
+                if (written < triangleCount)
+                {
+                    fprintf(file, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, d, d, d, c, c, c);
+                    ++written;
+                }
+            }
+        }
+
+        fclose(file);
+    }
+
+    struct Result
+    {
+        double mMilliseconds{ 0.0 };
+        size_t mPositionCount{ 0 };
+        size_t mTriangleCount{ 0 };
+    };
+
+    /// 旧路径：tinyobj::LoadObj 之后按 shape 逐个 push_back 展开（与去重前的 Model::loadModel 相同）
+    Result runTinyObj(const std::string& path, std::vector<float>& positions)
+    {
+        auto start = Clock::now();
+
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string err;
+        std::string warn;
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str()))
+        {
+            throw std::runtime_error(err);
+        }
+
+        positions.clear();
+        size_t indexCount = 0;
+        for (const auto& shape : shapes)
+        {
+            for (const auto& index : shape.mesh.indices)
+            {
+                positions.push_back(attrib.vertices[3 * index.vertex_index + 0]);
+                positions.push_back(attrib.vertices[3 * index.vertex_index + 1]);
+                positions.push_back(attrib.vertices[3 * index.vertex_index + 2]);
+                ++indexCount;
+            }
+        }
+
+        Result result{};
+        result.mMilliseconds  = elapsedMs(start);
+        result.mPositionCount = attrib.vertices.size() / 3;
+        result.mTriangleCount = indexCount / 3;
+        return result;
+    }
+
+    Result runObjLoader(const std::string& path, ThreadPool& threadPool, std::vector<float>& positions)
+    {
+        auto start = Clock::now();
+
+        ObjMesh     mesh{};
+        std::string error;
+        if (!ObjLoader::load(path, mesh, threadPool, error))
+        {
+            throw std::runtime_error(error);
+        }
+
+        // 与旧路径做同样的展开，但先一次性分配
+        positions.resize(mesh.mIndices.size() * 3);
+        threadPool.parallelFor((mesh.mIndices.size() + 65535) / 65536, [&](size_t block)
+        {
+            size_t begin = block * 65536;
+            size_t end   = std::min(begin + 65536, mesh.mIndices.size());
+            for (size_t i = begin; i < end; ++i)
+            {
+                const float* source = mesh.mPositions.data() + mesh.mIndices[i].mPosition * 3;
+                std::copy(source, source + 3, positions.data() + i * 3);
+            }
+        });
+
+        Result result{};
+        result.mMilliseconds  = elapsedMs(start);
+        result.mPositionCount = mesh.mPositions.size() / 3;
+        result.mTriangleCount = mesh.mIndices.size() / 3;
+        return result;
+    }
+
+    template<typename Function>
+    Result best(int repeat, Function&& function)
+    {
+        Result bestResult{};
+        for (int i = 0; i < repeat; ++i)
+        {
+            Result result = function();
+            if (i == 0 || result.mMilliseconds < bestResult.mMilliseconds)
+            {
+                bestResult = result;
+            }
+        }
+        return bestResult;
+    }
+
+    void benchmarkFile(const std::string& path, uint32_t threadCount, int repeat)
+    {
+        double sizeMB = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+
+        std::vector<float> tinyPositions{};
+        std::vector<float> loaderPositions{};
+
+        ThreadPool singleThread(1);
+        ThreadPool threadPool(threadCount);
+
+        Result tiny   = best(repeat, [&]() { return runTinyObj(path, tinyPositions); });
+        Result single = best(repeat, [&]() { return runObjLoader(path, singleThread, loaderPositions); });
+        Result multi  = best(repeat, [&]() { return runObjLoader(path, threadPool, loaderPositions); });
+
+        // 校验两条路径得到相同的几何
+        float maxError = tinyPositions.size() == loaderPositions.size() ? 0.0f : INFINITY;
+        for (size_t i = 0; i < tinyPositions.size() && i < loaderPositions.size(); ++i)
+        {
+            maxError = std::max(maxError, std::abs(tinyPositions[i] - loaderPositions[i]));
+        }
+
+        std::cout << path << " (" << sizeMB << " MB, " << tiny.mPositionCount << " positions, "
+                  << tiny.mTriangleCount << " triangles)" << std::endl;
+        std::cout << "  tinyobj            : " << tiny.mMilliseconds << " ms, " << sizeMB / (tiny.mMilliseconds / 1000.0) << " MB/s" << std::endl;
+        std::cout << "  ObjLoader 1 thread : " << single.mMilliseconds << " ms, " << sizeMB / (single.mMilliseconds / 1000.0) << " MB/s" << std::endl;
+        std::cout << "  ObjLoader " << threadPool.getThreadCount() << " threads: " << multi.mMilliseconds << " ms, "
+                  << sizeMB / (multi.mMilliseconds / 1000.0) << " MB/s, speedup x" << tiny.mMilliseconds / multi.mMilliseconds << std::endl;
+        std::cout << "  triangles match: " << (tiny.mTriangleCount == multi.mTriangleCount ? "yes" : "NO")
+                  << ", max position error: " << maxError << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t   triangleCount = 10000000;
+    uint32_t threadCount   = 0;
+    int      repeat        = 3;
+
+    std::vector<std::string> files{};
+    std::filesystem::path    syntheticPath{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--triangles" && i + 1 < argc)
+        {
+            triangleCount = std::stoull(argv[++i]);
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            threadCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--repeat" && i + 1 < argc)
+        {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    int exitCode = 0;
+
+    try
+    {
+        if (files.empty())
+        {
+            files.push_back("assets/models/diablo3_pose/diablo3_pose.obj");
+
+            syntheticPath = std::filesystem::temp_directory_path() / ("synthetic_" + std::to_string(triangleCount) + ".obj");
+
+            std::cout << "Generating " << syntheticPath.string() << " ..." << std::endl;
+            writeSyntheticObj(syntheticPath.string(), triangleCount);
+            files.push_back(syntheticPath.string());
+        }
+
+        for (const auto& file : files)
+        {
+            benchmarkFile(file, threadCount, repeat);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+        exitCode = 1;
+    }
+
+    // 失败时也删除，不在临时目录中留下上 GB 的文件
+    if (!syntheticPath.empty())
+    {
+        std::error_code error{};
+        std::filesystem::remove(syntheticPath, error);
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,271 @@
+﻿// 场景基准：离屏固定步长渲染 N 帧，相机沿脚本路径运动，输出帧时间分位数与显存高水位
+//
+// 用法：Bona_bench [--output FILE.json] [--warmup N] [--frames N] [--window] [Bona 的其它参数 ...]
+// 默认等价于 Bona --headless --frames <warmup + N> --fixed-timestep 1/60 --camera-path orbit --no-validation，
+// 后给出的参数覆盖默认值；固定步长保证相同参数的两次运行渲染完全相同的帧序列，结果可以直接对比
+//
+// 纹理缩小采样场景：Bona_bench --camera-path orbit:8 --instances 256 --output mips.json
+// 与同样参数加 --no-mips 的结果对比 gpu_scope_ms 中 "Main pass" 的时间（片元调用次数相同，差异来自纹理读取带宽）
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "../application.h"
+
+using namespace LearnVulkan;
+
+namespace
+{
+    struct Summary
+    {
+        size_t mCount{ 0 };
+        double mMin{ 0.0 };
+        double mMean{ 0.0 };
+        double mP50{ 0.0 };
+        double mP95{ 0.0 };
+        double mP99{ 0.0 };
+        double mMax{ 0.0 };
+    };
+
+    /// 丢弃前 warmup 个样本后统计；分位数取最近秩
+    Summary summarize(const std::vector<double>& samples, size_t warmup)
+    {
+        Summary summary{};
+        if (samples.size() <= warmup)
+        {
+            return summary;
+        }
+
+        std::vector<double> sorted(samples.begin() + warmup, samples.end());
+        std::sort(sorted.begin(), sorted.end());
+
+        auto percentile = [&sorted](double p)
+        {
+            size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+            return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+        };
+
+        summary.mCount = sorted.size();
+        summary.mMin   = sorted.front();
+        summary.mMax   = sorted.back();
+        summary.mMean  = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+        summary.mP50   = percentile(50.0);
+        summary.mP95   = percentile(95.0);
+        summary.mP99   = percentile(99.0);
+
+        return summary;
+    }
+
+    /// 进程的常驻内存峰值（字节）
+    uint64_t getPeakHostMemory()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+        }
+        return 0;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    std::string escape(const std::string& text)
+    {
+        std::string result;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result;
+    }
+
+    void writeSummary(std::ostream& out, const Summary& summary)
+    {
+        out << "{ \"count\": " << summary.mCount
+            << ", \"min\": " << summary.mMin
+            << ", \"mean\": " << summary.mMean
+            << ", \"p50\": " << summary.mP50
+            << ", \"p95\": " << summary.mP95
+            << ", \"p99\": " << summary.mP99
+            << ", \"max\": " << summary.mMax << " }";
+    }
+
+    void printSummary(const char* label, const Summary& summary)
+    {
+        std::cout << label << " min " << summary.mMin << " / mean " << summary.mMean << " / p50 " << summary.mP50
+                  << " / p95 " << summary.mP95 << " / p99 " << summary.mP99 << " ms (" << summary.mCount << " frames)" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string outputPath = "bench_results.json";
+    uint64_t    warmup     = 60;
+    uint64_t    frames     = 1000;
+    bool        headless   = true;
+
+    std::vector<std::string> forwarded{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--output" && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+        }
+        else if (arg == "--warmup" && i + 1 < argc)
+        {
+            warmup = std::stoull(argv[++i]);
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            frames = std::max<uint64_t>(1, std::stoull(argv[++i]));
+        }
+        else if (arg == "--window")
+        {
+            headless = false;
+        }
+        else
+        {
+            forwarded.push_back(arg);
+        }
+    }
+
+    std::vector<std::string> arguments{ argv[0] };
+    if (headless)
+    {
+        arguments.push_back("--headless");
+    }
+    arguments.insert(arguments.end(), { "--frames", std::to_string(warmup + frames),
+                                        "--fixed-timestep", "0.0166666667",
+                                        "--camera-path", "orbit",
+                                        "--no-validation" });
+    arguments.insert(arguments.end(), forwarded.begin(), forwarded.end());
+
+    std::vector<char*> argumentPointers{};
+    for (auto& argument : arguments)
+    {
+        argumentPointers.push_back(argument.data());
+    }
+
+    AppConfig config = AppConfig::parse(static_cast<int>(argumentPointers.size()), argumentPointers.data());
+    config.mCollectFrameTimings = true;
+
+    Application app(config);
+
+    try
+    {
+        app.run();
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    const FrameTimings& timings = app.getFrameTimings();
+
+    Summary cpu = summarize(timings.mCpuMilliseconds, warmup);
+    printSummary("CPU frame:", cpu);
+
+    // GPU 计时按帧序号到达，丢失的帧（读回时结果尚未就绪）不会出现，warmup 同样按样本数丢弃
+    std::map<std::string, Summary> gpu{};
+    for (const auto& [name, samples] : timings.mGpuMilliseconds)
+    {
+        gpu[name] = summarize(samples, warmup);
+    }
+
+    if (gpu.count("Frame") != 0)
+    {
+        printSummary("GPU frame:", gpu["Frame"]);
+    }
+
+    uint64_t peakHostMemory = getPeakHostMemory();
+
+    std::ofstream out(outputPath);
+    if (!out)
+    {
+        std::cout << "Error: failed to open " << outputPath << std::endl;
+        return 1;
+    }
+
+    out << std::setprecision(6) << std::fixed;
+    out << "{\n";
+    out << "  \"device\": \"" << escape(timings.mDeviceName) << "\",\n";
+    out << "  \"config\": { \"frames\": " << frames
+        << ", \"warmup\": " << warmup
+        << ", \"width\": " << config.mWidth
+        << ", \"height\": " << config.mHeight
+        << ", \"headless\": " << (config.mHeadless ? "true" : "false")
+        << ", \"fixed_timestep\": " << config.mFixedTimestep
+        << ", \"camera_path\": \"" << escape(config.mCameraPath) << "\""
+        << ", \"frames_in_flight\": " << config.mMaxFramesInFlight
+        << ", \"record_threads\": " << config.mRecordThreads
+        << ", \"instances\": " << config.mInstanceCount
+        << ", \"gpu_culling\": " << (config.mGpuCulling ? "true" : "false")
+        << ", \"depth_prepass\": " << (config.mDepthPrepass ? "true" : "false") << " },\n";
+
+    out << "  \"cpu_frame_ms\": ";
+    writeSummary(out, cpu);
+    out << ",\n";
+
+    out << "  \"gpu_scope_ms\": {";
+    bool first = true;
+    for (const auto& [name, summary] : gpu)
+    {
+        out << (first ? "\n" : ",\n") << "    \"" << escape(name) << "\": ";
+        writeSummary(out, summary);
+        first = false;
+    }
+    out << "\n  },\n";
+
+    out << "  \"memory\": {\n";
+    out << "    \"peak_host_bytes\": " << peakHostMemory << ",\n";
+    out << "    \"heaps\": [";
+    first = true;
+    for (const auto& heap : timings.mHeapStats)
+    {
+        out << (first ? "\n" : ",\n")
+            << "      { \"index\": " << heap.mHeapIndex
+            << ", \"size\": " << heap.mHeapSize
+            << ", \"peak_block_bytes\": " << heap.mPeakBlockBytes
+            << ", \"peak_used_bytes\": " << heap.mPeakUsedBytes << " }";
+        first = false;
+    }
+    out << "\n    ]\n";
+    out << "  }\n";
+    out << "}\n";
+
+    std::cout << "Results written to " << outputPath << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,194 @@
+﻿// 纹理加载基准：旧路径（stb 输出 RGBA 后拷贝进暂存内存）对比 DecodedImage（保持原通道数解码，SIMD 扩展直接写暂存内存）
+//
+// 用法：Bona_texture_bench [--threads N] [--repeat N] [image ...]
+// 不给文件时加载 assets/models 下的所有 .tga / .jpg / .png，相当于启动时载入全部模型贴图的 CPU 部分
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../stb_image.h"
+
+#include "../texture/decodedImage.h"
+#include "../threadPool.h"
+
+using namespace LearnVulkan;
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double elapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /// 模拟暂存环：每张图像的 RGBA8 数据依次排放在一块预先分配的内存中
+    struct Staging
+    {
+        std::vector<uint8_t> mData{};
+        std::vector<size_t>  mOffsets{};
+    };
+
+    /// 旧路径：逐个 stbi_load(..., STBI_rgb_alpha)，再把结果 memcpy 进暂存内存
+    double runStbRGBA(const std::vector<std::string>& files, Staging& staging)
+    {
+        auto start = Clock::now();
+
+        staging.mData.clear();
+        staging.mOffsets.clear();
+
+        for (const auto& file : files)
+        {
+            int width, height, channels;
+            stbi_uc* pixels = stbi_load(file.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+            if (!pixels)
+            {
+                throw std::runtime_error("Error: failed to read " + file);
+            }
+
+            size_t size = size_t(width) * height * 4;
+            staging.mOffsets.push_back(staging.mData.size());
+            staging.mData.resize(staging.mData.size() + size);
+            memcpy(staging.mData.data() + staging.mOffsets.back(), pixels, size);
+
+            stbi_image_free(pixels);
+        }
+
+        return elapsedMs(start);
+    }
+
+    /// 新路径：线程池并行解码（threadPool 为空时在调用线程上逐个解码），
+    /// 再按顺序分配暂存空间（与上传引擎一样在调用线程上），扩展直接写入
+    double runDecodedImage(const std::vector<std::string>& files, ThreadPool* threadPool, Staging& staging, double& decodeMs)
+    {
+        auto start = Clock::now();
+
+        std::vector<DecodedImage::Ptr> images(files.size());
+        auto decode = [&](size_t index) { images[index] = DecodedImage::decode(files[index]); };
+
+        if (threadPool)
+        {
+            threadPool->parallelFor(files.size(), decode);
+        }
+        else
+        {
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                decode(i);
+            }
+        }
+
+        decodeMs = elapsedMs(start);
+
+        staging.mData.clear();
+        staging.mOffsets.clear();
+
+        for (const auto& image : images)
+        {
+            staging.mOffsets.push_back(staging.mData.size());
+            staging.mData.resize(staging.mData.size() + image->getRGBA8Size());
+            image->convertToRGBA8(staging.mData.data() + staging.mOffsets.back());
+        }
+
+        return elapsedMs(start);
+    }
+
+    template<typename Function>
+    double best(int repeat, Function&& function)
+    {
+        double bestMs = 0.0;
+        for (int i = 0; i < repeat; ++i)
+        {
+            double ms = function();
+            if (i == 0 || ms < bestMs)
+            {
+                bestMs = ms;
+            }
+        }
+        return bestMs;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threadCount = 0;
+    int      repeat      = 3;
+
+    std::vector<std::string> files{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--threads" && i + 1 < argc)
+        {
+            threadCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--repeat" && i + 1 < argc)
+        {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    try
+    {
+        if (files.empty())
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator("assets/models"))
+            {
+                std::string extension = entry.path().extension().string();
+                if (extension == ".tga" || extension == ".jpg" || extension == ".png")
+                {
+                    files.push_back(entry.path().string());
+                }
+            }
+
+            std::sort(files.begin(), files.end());
+        }
+
+        if (files.empty())
+        {
+            std::cout << "No images found (run from the build directory or pass files)" << std::endl;
+            return 1;
+        }
+
+        Staging reference{};
+        Staging single{};
+        Staging multi{};
+
+        ThreadPool threadPool(threadCount);
+
+        double singleDecodeMs = 0.0;
+        double multiDecodeMs  = 0.0;
+
+        double stbMs    = best(repeat, [&]() { return runStbRGBA(files, reference); });
+        double singleMs = best(repeat, [&]() { return runDecodedImage(files, nullptr, single, singleDecodeMs); });
+        double multiMs  = best(repeat, [&]() { return runDecodedImage(files, &threadPool, multi, multiDecodeMs); });
+
+        double sizeMB = reference.mData.size() / (1024.0 * 1024.0);
+
+        std::cout << files.size() << " images, " << sizeMB << " MB as RGBA8, RGB expand kernel: " << DecodedImage::getExpandKernelName() << std::endl;
+        std::cout << "  stbi_load RGBA + copy        : " << stbMs << " ms" << std::endl;
+        std::cout << "  DecodedImage 1 thread        : " << singleMs << " ms (decode " << singleDecodeMs << " ms)" << std::endl;
+        std::cout << "  DecodedImage " << threadPool.getThreadCount() + 1 << " threads       : " << multiMs << " ms (decode "
+                  << multiDecodeMs << " ms), speedup x" << stbMs / multiMs << std::endl;
+        std::cout << "  output matches: " << (reference.mData == single.mData && reference.mData == multi.mData ? "yes" : "NO") << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
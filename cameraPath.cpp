@@ -0,0 +1,112 @@
+﻿#include "cameraPath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <glm/gtc/constants.hpp>
+
+namespace LearnVulkan
+{
+    static glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t)
+    {
+        float t2 = t * t;
+        float t3 = t2 * t;
+
+        return 0.5f * ((2.0f * p1) +
+                       (p2 - p0) * t +
+                       (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                       (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+    }
+
+    CameraPath::Ptr CameraPath::createOrbit(float radius, float height, float period)
+    {
+        constexpr uint32_t SEGMENTS = 32;
+
+        std::vector<Keyframe> keyframes(SEGMENTS + 1);
+        for (uint32_t i = 0; i <= SEGMENTS; ++i)
+        {
+            float angle = glm::two_pi<float>() * static_cast<float>(i) / SEGMENTS;
+
+            keyframes[i].mTime   = period * static_cast<float>(i) / SEGMENTS;
+            keyframes[i].mEye    = glm::vec3(std::sin(angle) * radius, height, std::cos(angle) * radius);
+            keyframes[i].mTarget = glm::vec3(0.0f);
+        }
+
+        return std::make_shared<CameraPath>(std::move(keyframes));
+    }
+
+    CameraPath::Ptr CameraPath::load(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to open camera path " + path);
+        }
+
+        std::vector<Keyframe> keyframes{};
+
+        std::string line;
+        uint32_t    lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            ++lineNumber;
+
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#')
+            {
+                continue;
+            }
+
+            std::istringstream stream(line);
+
+            Keyframe keyframe{};
+            if (!(stream >> keyframe.mTime
+                         >> keyframe.mEye.x >> keyframe.mEye.y >> keyframe.mEye.z
+                         >> keyframe.mTarget.x >> keyframe.mTarget.y >> keyframe.mTarget.z))
+            {
+                throw std::runtime_error("Error: malformed camera keyframe at " + path + ":" + std::to_string(lineNumber));
+            }
+
+            keyframes.push_back(keyframe);
+        }
+
+        if (keyframes.size() < 2)
+        {
+            throw std::runtime_error("Error: camera path " + path + " needs at least two keyframes");
+        }
+
+        std::stable_sort(keyframes.begin(), keyframes.end(), [](const Keyframe& a, const Keyframe& b) { return a.mTime < b.mTime; });
+
+        return std::make_shared<CameraPath>(std::move(keyframes));
+    }
+
+    CameraPath::CameraPath(std::vector<Keyframe> keyframes)
+    {
+        mKeyframes = std::move(keyframes);
+    }
+
+    void CameraPath::evaluate(float time, glm::vec3& eye, glm::vec3& target) const
+    {
+        float duration = getDuration();
+        float local    = duration > 0.0f ? std::fmod(time, duration) : 0.0f;
+        if (local < 0.0f)
+        {
+            local += duration;
+        }
+        local += mKeyframes.front().mTime;
+
+        // 找到 local 所在的区间 [i, i + 1]，两端之外的控制点取端点本身
+        auto   upper = std::upper_bound(mKeyframes.begin(), mKeyframes.end(), local, [](float value, const Keyframe& keyframe) { return value < keyframe.mTime; });
+        size_t i1    = std::min<size_t>(mKeyframes.size() - 1, static_cast<size_t>(std::max<ptrdiff_t>(1, upper - mKeyframes.begin())));
+        size_t i0    = i1 - 1;
+        size_t im    = i0 > 0 ? i0 - 1 : i0;
+        size_t i2    = std::min(i1 + 1, mKeyframes.size() - 1);
+
+        float span = mKeyframes[i1].mTime - mKeyframes[i0].mTime;
+        float t    = span > 0.0f ? std::clamp((local - mKeyframes[i0].mTime) / span, 0.0f, 1.0f) : 0.0f;
+
+        eye    = catmullRom(mKeyframes[im].mEye, mKeyframes[i0].mEye, mKeyframes[i1].mEye, mKeyframes[i2].mEye, t);
+        target = catmullRom(mKeyframes[im].mTarget, mKeyframes[i0].mTarget, mKeyframes[i1].mTarget, mKeyframes[i2].mTarget, t);
+    }
+}
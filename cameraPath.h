@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // 脚本化相机路径：按时间排列的关键帧（相机位置 + 注视点），Catmull-Rom 插值
+    // 时间超出路径长度时从头循环，相同的时间序列总是得到相同的相机，用于可复现的基准
+    //
+    // 文件格式：每行一个关键帧 "time eyeX eyeY eyeZ targetX targetY targetZ"，# 开头为注释
+    // ==================================================================
+    class CameraPath
+    {
+    public:
+        using Ptr = std::shared_ptr<CameraPath>;
+
+        struct Keyframe
+        {
+            float     mTime{ 0.0f };
+            glm::vec3 mEye{ 0.0f };
+            glm::vec3 mTarget{ 0.0f };
+        };
+
+        /// 绕 Y 轴一周的环绕路径，注视原点
+        static Ptr createOrbit(float radius, float height, float period);
+
+        /// 读取关键帧文件，格式错误或少于两个关键帧时抛出异常
+        static Ptr load(const std::string& path);
+
+        explicit CameraPath(std::vector<Keyframe> keyframes);
+
+        void evaluate(float time, glm::vec3& eye, glm::vec3& target) const;
+
+        [[nodiscard]] float getDuration() const { return mKeyframes.back().mTime - mKeyframes.front().mTime; }
+
+    private:
+        std::vector<Keyframe> mKeyframes{};
+    };
+}
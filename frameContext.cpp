@@ -0,0 +1,88 @@
+﻿#include "frameContext.h"
+#include "vulkanWrapper/cpuProfiler.h"
+
+namespace LearnVulkan
+{
+    FrameContext::FrameContext(const Wrapper::Device::Ptr& device, const UniformManager::Ptr& uniformManager, uint32_t index)
+    {
+        mDevice                  = device;
+        mIndex                   = index;
+        mCommandPool             = Wrapper::CommandPool::create(device, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+        mCommandBuffer           = Wrapper::CommandBuffer::create(device, mCommandPool);
+        mDescriptorSet           = uniformManager->getDescriptorSet(static_cast<int>(index));
+        mImageAvailableSemaphore = Wrapper::Semaphore::create(device, false);
+    }
+
+    void FrameContext::reset()
+    {
+        mCommandPool->reset();
+
+        for (const auto& pool : mSecondaryCommandPools)
+        {
+            pool->reset();
+        }
+    }
+
+    void FrameContext::prepareSecondaryCommandBuffers(uint32_t count)
+    {
+        while (mSecondaryCommandBuffers.size() < count)
+        {
+            auto pool = Wrapper::CommandPool::create(mDevice, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+            mSecondaryCommandPools.push_back(pool);
+            mSecondaryCommandBuffers.push_back(Wrapper::CommandBuffer::create(mDevice, pool, true));
+        }
+    }
+
+    FrameContextRing::FrameContextRing(const Wrapper::Device::Ptr& device, const UniformManager::Ptr& uniformManager, uint32_t framesInFlight)
+    {
+        if (framesInFlight == 0)
+        {
+            throw std::runtime_error("Error: frames in flight must be at least 1!");
+        }
+
+        mTimeline = Wrapper::Semaphore::create(device, true);
+
+        mContexts.reserve(framesInFlight);
+        for (uint32_t i = 0; i < framesInFlight; ++i)
+        {
+            mContexts.push_back(FrameContext::create(device, uniformManager, i));
+        }
+    }
+
+    FrameContextRing::~FrameContextRing()
+    {
+        waitIdle();
+    }
+
+    const FrameContext::Ptr& FrameContextRing::beginFrame()
+    {
+        const auto& context = mContexts[mCurrent];
+
+        if (context->getTimelineValue() != 0)
+        {
+            CPU_PROFILE_ZONE("Wait frame");
+
+            mTimeline->wait(context->getTimelineValue());
+        }
+
+        context->reset();
+
+        return context;
+    }
+
+    void FrameContextRing::endFrame()
+    {
+        mSubmittedValue = getSignalValue();
+        mContexts[mCurrent]->setTimelineValue(mSubmittedValue);
+
+        mCurrent = (mCurrent + 1) % static_cast<uint32_t>(mContexts.size());
+    }
+
+    void FrameContextRing::waitIdle()
+    {
+        if (mTimeline != nullptr && mSubmittedValue != 0)
+        {
+            mTimeline->wait(mSubmittedValue);
+        }
+    }
+}
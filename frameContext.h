@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+#include "vulkanWrapper/device.h"
+#include "vulkanWrapper/commandPool.h"
+#include "vulkanWrapper/commandBuffer.h"
+#include "vulkanWrapper/semaphore.h"
+#include "uniformManager.h"
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // 一帧从 CPU 录制到 GPU 执行期间独占的资源
+    // 数量由 frames-in-flight 决定，与交换链图像数无关；交换链重建时保持不变
+    // （渲染完成信号量属于交换链图像，见 SwapChain::getRenderFinishedSemaphore）
+    // 命令缓冲来自上下文私有的 TRANSIENT 池，每帧整池重置后重新录制；
+    // 多线程录制时每个录制线程另有一个 TRANSIENT 池和一个二级命令缓冲
+    // ==================================================================
+    class FrameContext
+    {
+    public:
+        using Ptr = std::shared_ptr<FrameContext>;
+
+        static Ptr create(const Wrapper::Device::Ptr& device, const UniformManager::Ptr& uniformManager, uint32_t index)
+        {
+            return std::make_shared<FrameContext>(device, uniformManager, index);
+        }
+
+        FrameContext(const Wrapper::Device::Ptr& device, const UniformManager::Ptr& uniformManager, uint32_t index);
+
+        ~FrameContext() = default;
+
+        /// 上一次提交完成后调用：vkResetCommandPool 一次回收本帧的全部命令内存
+        void reset();
+
+        /// 在主线程上确保至少有 count 个二级命令缓冲槽位，之后各线程只访问自己的槽位
+        void prepareSecondaryCommandBuffers(uint32_t count);
+
+        [[nodiscard]] const Wrapper::CommandBuffer::Ptr& getSecondaryCommandBuffer(uint32_t slot) const { return mSecondaryCommandBuffers[slot]; }
+
+        [[nodiscard]] auto getIndex()                   const { return mIndex; }
+        [[nodiscard]] auto getCommandPool()             const { return mCommandPool; }
+        [[nodiscard]] auto getCommandBuffer()           const { return mCommandBuffer; }
+        [[nodiscard]] auto getDescriptorSet()           const { return mDescriptorSet; }
+        [[nodiscard]] auto getImageAvailableSemaphore() const { return mImageAvailableSemaphore; }
+
+        /// 该上下文最近一次提交在帧时间线上的信号值，0 表示从未提交
+        [[nodiscard]] auto getTimelineValue() const { return mTimelineValue; }
+
+        void setTimelineValue(uint64_t value) { mTimelineValue = value; }
+
+    private:
+        Wrapper::Device::Ptr        mDevice{ nullptr };
+        uint32_t                    mIndex{ 0 };
+        Wrapper::CommandPool::Ptr   mCommandPool{ nullptr };
+        Wrapper::CommandBuffer::Ptr mCommandBuffer{ nullptr };
+        VkDescriptorSet             mDescriptorSet{ VK_NULL_HANDLE };
+        Wrapper::Semaphore::Ptr     mImageAvailableSemaphore{ nullptr };
+        uint64_t                    mTimelineValue{ 0 };
+
+        // 命令池不能被多个线程同时使用，所以每个录制槽位一个池
+        std::vector<Wrapper::CommandPool::Ptr>   mSecondaryCommandPools{};
+        std::vector<Wrapper::CommandBuffer::Ptr> mSecondaryCommandBuffers{};
+    };
+
+    // ==================================================================
+    // FrameContext 环
+    // 所有帧的提交共用一个时间线信号量，第 N 次提交信号值 N。
+    // beginFrame 只等待当前上下文上一次提交的值，代替按交换链图像数分配的 Fence
+    // ==================================================================
+    class FrameContextRing
+    {
+    public:
+        using Ptr = std::shared_ptr<FrameContextRing>;
+
+        static Ptr create(const Wrapper::Device::Ptr& device, const UniformManager::Ptr& uniformManager, uint32_t framesInFlight)
+        {
+            return std::make_shared<FrameContextRing>(device, uniformManager, framesInFlight);
+        }
+
+        FrameContextRing(const Wrapper::Device::Ptr& device, const UniformManager::Ptr& uniformManager, uint32_t framesInFlight);
+
+        ~FrameContextRing();
+
+        /// 阻塞到当前上下文的上一次提交在 GPU 上完成并重置它的命令池，之后可以安全地重写它的命令缓冲与 uniform
+        const FrameContext::Ptr& beginFrame();
+
+        /// 本帧提交需要在帧时间线上信号的值
+        [[nodiscard]] uint64_t getSignalValue() const { return mSubmittedValue + 1; }
+
+        /// 本帧已提交：记录信号值并切换到下一个上下文
+        void endFrame();
+
+        void waitIdle();
+
+        /// 最近一次已提交帧的时间线值
+        [[nodiscard]] auto getSubmittedValue() const { return mSubmittedValue; }
+
+        /// GPU 已完成到的时间线值
+        [[nodiscard]] uint64_t getCompletedValue() const { return mTimeline->getCounterValue(); }
+
+        [[nodiscard]] auto getTimelineSemaphore() const { return mTimeline; }
+        [[nodiscard]] auto getFramesInFlight()    const { return static_cast<uint32_t>(mContexts.size()); }
+
+    private:
+        std::vector<FrameContext::Ptr> mContexts{};
+        Wrapper::Semaphore::Ptr        mTimeline{ nullptr };
+        uint64_t                       mSubmittedValue{ 0 };
+        uint32_t                       mCurrent{ 0 };
+    };
+}
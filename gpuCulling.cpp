@@ -0,0 +1,179 @@
+﻿#include "gpuCulling.h"
+
+namespace LearnVulkan
+{
+    static constexpr uint32_t CULL_GROUP_SIZE = 64;
+
+    GpuCulling::GpuCulling(const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine, const Model::Ptr& model, uint32_t frameCount)
+    {
+        mDevice      = device;
+        mModel       = model;
+        mObjectCount = static_cast<uint32_t>(model->getInstanceMatrices().size());
+
+        if (!mDevice->supportsDrawIndirectFirstInstance())
+        {
+            throw std::runtime_error("Error: GPU culling needs drawIndirectFirstInstance!");
+        }
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(mDevice->getPhysicalDevice(), &properties);
+
+        // 不支持 multiDrawIndirect 时每次间接调用只能有一个绘制
+        mUseDrawCount    = mDevice->supportsDrawIndirectCount();
+        mMaxDrawsPerCall = mDevice->supportsMultiDrawIndirect() ? std::max(1u, properties.limits.maxDrawIndirectCount) : 1u;
+
+        // 所有物体共用同一个网格，包围球取包围盒中心和半对角线
+        glm::vec3 boundsMin = mModel->getBoundsMin();
+        glm::vec3 boundsMax = mModel->getBoundsMax();
+        glm::vec4 sphere    = glm::vec4((boundsMin + boundsMax) * 0.5f, glm::length(boundsMax - boundsMin) * 0.5f);
+
+        std::vector<glm::vec4> spheres(mObjectCount, sphere);
+        mBoundsBuffer = Wrapper::Buffer::createStorageBuffer(mDevice, spheres.size() * sizeof(glm::vec4), spheres.data(), uploadEngine);
+
+        VkDeviceSize commandSize = VkDeviceSize(mObjectCount) * sizeof(VkDrawIndexedIndirectCommand);
+
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            mParameterBuffers.push_back(Wrapper::Buffer::createUniformBuffer(mDevice, sizeof(CullParameters)));
+
+            mCommandBuffers.push_back(Wrapper::Buffer::create(mDevice,
+                                                              commandSize,
+                                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+            mCountBuffers.push_back(Wrapper::Buffer::create(mDevice,
+                                                            sizeof(uint32_t),
+                                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+        }
+
+        auto addParam = [this](uint32_t binding, VkDescriptorType type, size_t size)
+        {
+            auto param             = Wrapper::UniformParameter::create();
+            param->mBinding        = binding;
+            param->mCount          = 1;
+            param->mDescriptorType = type;
+            param->mSize           = size;
+            param->mStage          = VK_SHADER_STAGE_COMPUTE_BIT;
+            mParams.push_back(param);
+
+            return param;
+        };
+
+        auto parameterParam = addParam(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, sizeof(CullParameters));
+        auto instanceParam  = addParam(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mObjectCount * sizeof(glm::mat4));
+        auto boundsParam    = addParam(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, spheres.size() * sizeof(glm::vec4));
+        auto commandParam   = addParam(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, commandSize);
+        auto countParam     = addParam(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, sizeof(uint32_t));
+
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            parameterParam->mBuffers.push_back(mParameterBuffers[i]);
+            instanceParam->mBuffers.push_back(mModel->getInstanceBuffer());
+            boundsParam->mBuffers.push_back(mBoundsBuffer);
+            commandParam->mBuffers.push_back(mCommandBuffers[i]);
+            countParam->mBuffers.push_back(mCountBuffers[i]);
+        }
+
+        mDescriptorSetLayout = Wrapper::DescriptorSetLayout::create(mDevice);
+        mDescriptorSetLayout->build(mParams);
+
+        mDescriptorPool = Wrapper::DescriptorPool::create(mDevice);
+        mDescriptorPool->build(mParams, static_cast<int>(frameCount));
+
+        mDescriptorSet = Wrapper::DescriptorSet::create(mDevice, mParams, mDescriptorSetLayout, mDescriptorPool, static_cast<int>(frameCount));
+
+        mPipeline = Wrapper::ComputePipeline::create(mDevice);
+        mPipeline->setShader(Wrapper::Shader::create(mDevice, "shaders/cull.spv", VK_SHADER_STAGE_COMPUTE_BIT, "main"));
+        auto layout = mDescriptorSetLayout->getLayout();
+        mPipeline->mLayoutState.setLayoutCount = 1;
+        mPipeline->mLayoutState.pSetLayouts    = &layout;
+        mPipeline->build();
+
+        std::cout << "GpuCulling: " << mObjectCount << " objects, "
+                  << (mUseDrawCount ? "vkCmdDrawIndexedIndirectCount" : "vkCmdDrawIndexedIndirect") << ", "
+                  << getIndirectCallCount() << " indirect call(s)/frame" << std::endl;
+    }
+
+    void GpuCulling::cull(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex, const glm::mat4& viewProjection, const glm::mat4& modelMatrix)
+    {
+        CullParameters parameters{};
+        extractFrustumPlanes(viewProjection, parameters.mFrustumPlanes);
+        parameters.mModelMatrix = modelMatrix;
+        parameters.mObjectCount = mObjectCount;
+        parameters.mIndexCount  = static_cast<uint32_t>(mModel->getIndexCount());
+        parameters.mCompact     = mUseDrawCount ? 1 : 0;
+
+        // 参数缓冲按帧分片，本帧上下文此时已不被 GPU 读取
+        mParameterBuffers[frameIndex]->updateBufferByMap(&parameters, sizeof(CullParameters));
+
+        VkBuffer commandBufferHandle = mCommandBuffers[frameIndex]->getBuffer();
+        VkBuffer countBuffer         = mCountBuffers[frameIndex]->getBuffer();
+
+        // 上一次使用这些缓冲的间接绘制必须先读完
+        commandBuffer->bufferMemoryBarrier(commandBufferHandle,
+                                           VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+
+        commandBuffer->fillBuffer(countBuffer, 0, sizeof(uint32_t), 0);
+
+        commandBuffer->bufferMemoryBarrier(countBuffer,
+                                           VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        commandBuffer->bindComputePipeline(mPipeline->getPipeline());
+        commandBuffer->bindDescriptorSet(VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline->getLayout(), mDescriptorSet->getDescriptorSet(static_cast<int>(frameIndex)));
+        commandBuffer->dispatch((mObjectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE);
+
+        commandBuffer->bufferMemoryBarrier(commandBufferHandle,
+                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                           VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+
+        commandBuffer->bufferMemoryBarrier(countBuffer,
+                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                           VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+    }
+
+    void GpuCulling::draw(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex) const
+    {
+        VkBuffer commandBufferHandle = mCommandBuffers[frameIndex]->getBuffer();
+        uint32_t stride              = sizeof(VkDrawIndexedIndirectCommand);
+
+        if (mUseDrawCount)
+        {
+            commandBuffer->drawIndexedIndirectCount(commandBufferHandle, 0, mCountBuffers[frameIndex]->getBuffer(), 0, mObjectCount, stride);
+            return;
+        }
+
+        // 回退路径：不可见物体的命令 instanceCount 为 0，由 GPU 跳过
+        for (uint32_t first = 0; first < mObjectCount; first += mMaxDrawsPerCall)
+        {
+            uint32_t count = std::min(mMaxDrawsPerCall, mObjectCount - first);
+            commandBuffer->drawIndexedIndirect(commandBufferHandle, VkDeviceSize(first) * stride, count, stride);
+        }
+    }
+
+    uint32_t GpuCulling::getIndirectCallCount() const
+    {
+        return mUseDrawCount ? 1u : (mObjectCount + mMaxDrawsPerCall - 1) / mMaxDrawsPerCall;
+    }
+
+    // Gribb-Hartmann：从 VP 矩阵的行组合出 6 个平面（深度范围 0..1），并归一化使 w 为真实距离；
+    // 反向 Z 下近、远两个平面互换，但平面集合不变
+    void GpuCulling::extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+    {
+        glm::mat4 m = glm::transpose(viewProjection);   // m[i] 即原矩阵的第 i 行
+
+        planes[0] = m[3] + m[0];   // 左
+        planes[1] = m[3] - m[0];   // 右
+        planes[2] = m[3] + m[1];   // 下
+        planes[3] = m[3] - m[1];   // 上
+        planes[4] = m[2];          // z >= 0（反向 Z 时为远平面）
+        planes[5] = m[3] - m[2];   // z <= w（反向 Z 时为近平面）
+
+        for (int i = 0; i < 6; ++i)
+        {
+            planes[i] /= glm::length(glm::vec3(planes[i]));
+        }
+    }
+}
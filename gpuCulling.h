@@ -0,0 +1,78 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+#include "vulkanWrapper/device.h"
+#include "vulkanWrapper/buffer.h"
+#include "vulkanWrapper/uploadEngine.h"
+#include "vulkanWrapper/commandBuffer.h"
+#include "vulkanWrapper/computePipeline.h"
+#include "vulkanWrapper/descriptorSetLayout.h"
+#include "vulkanWrapper/descriptorPool.h"
+#include "vulkanWrapper/descriptorSet.h"
+#include "model.h"
+
+namespace LearnVulkan
+{
+    /// 与 cull.comp 中 CullParameters 的 std140 布局一致
+    struct CullParameters
+    {
+        glm::vec4 mFrustumPlanes[6];
+        glm::mat4 mModelMatrix;
+        uint32_t  mObjectCount{ 0 };
+        uint32_t  mIndexCount{ 0 };
+        uint32_t  mCompact{ 0 };
+        uint32_t  mPadding{ 0 };
+    };
+
+    // ==================================================================
+    // GPU 驱动的绘制提交
+    // 计算着色器读取逐物体变换与包围球做视锥剔除，写出 VkDrawIndexedIndirectCommand 与可见数量；
+    // 支持 drawIndirectCount 时由 GPU 决定绘制数量，否则每个物体一条命令、不可见的 instanceCount 为 0。
+    // CPU 每帧只录制一次 dispatch 和一次（或按 maxDrawIndirectCount 分段的几次）间接绘制，与物体数量无关
+    // ==================================================================
+    class GpuCulling
+    {
+    public:
+        using Ptr = std::shared_ptr<GpuCulling>;
+
+        static Ptr create(const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine, const Model::Ptr& model, uint32_t frameCount)
+        {
+            return std::make_shared<GpuCulling>(device, uploadEngine, model, frameCount);
+        }
+
+        GpuCulling(const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine, const Model::Ptr& model, uint32_t frameCount);
+
+        ~GpuCulling() = default;
+
+        /// 在渲染通道之外录制：清零计数、剔除、再让结果对间接绘制可见
+        void cull(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex, const glm::mat4& viewProjection, const glm::mat4& modelMatrix);
+
+        /// 在渲染通道之内录制，顶点 / 索引缓冲与描述符需已绑定
+        void draw(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex) const;
+
+        /// 本路径每帧录制的间接绘制调用次数
+        [[nodiscard]] uint32_t getIndirectCallCount() const;
+
+    private:
+        static void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+
+    private:
+        Wrapper::Device::Ptr mDevice{ nullptr };
+        Model::Ptr           mModel{ nullptr };
+        uint32_t             mObjectCount{ 0 };
+        bool                 mUseDrawCount{ false };
+        uint32_t             mMaxDrawsPerCall{ 1 };
+
+        Wrapper::ComputePipeline::Ptr     mPipeline{ nullptr };
+        Wrapper::DescriptorSetLayout::Ptr mDescriptorSetLayout{ nullptr };
+        Wrapper::DescriptorPool::Ptr      mDescriptorPool{ nullptr };
+        Wrapper::DescriptorSet::Ptr       mDescriptorSet{ nullptr };
+
+        std::vector<Wrapper::UniformParameter::Ptr> mParams{};
+
+        Wrapper::Buffer::Ptr              mBoundsBuffer{ nullptr };
+        std::vector<Wrapper::Buffer::Ptr> mParameterBuffers{};
+        std::vector<Wrapper::Buffer::Ptr> mCommandBuffers{};
+        std::vector<Wrapper::Buffer::Ptr> mCountBuffers{};
+    };
+}
@@ -1,9 +1,9 @@
 ﻿#include <iostream>
 #include "application.h"
 
-int main()
+int main(int argc, char** argv)
 {
-    LearnVulkan::Application app;
+    LearnVulkan::Application app(LearnVulkan::AppConfig::parse(argc, argv));
 
     try
     {
@@ -0,0 +1,119 @@
+﻿#include "mappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LearnVulkan
+{
+    MappedFile::Ptr MappedFile::open(const std::string& path)
+    {
+        auto file = std::make_shared<MappedFile>();
+
+#ifdef _WIN32
+        HANDLE fileHandle = CreateFileA(path.c_str(),
+                                        GENERIC_READ,
+                                        FILE_SHARE_READ,
+                                        nullptr,
+                                        OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                        nullptr);
+
+        if (fileHandle == INVALID_HANDLE_VALUE)
+        {
+            return nullptr;
+        }
+
+        file->mFileHandle = fileHandle;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+        {
+            return nullptr;
+        }
+
+        HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr)
+        {
+            return nullptr;
+        }
+
+        file->mMappingHandle = mappingHandle;
+
+        void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr)
+        {
+            return nullptr;
+        }
+
+        file->mData = static_cast<const uint8_t*>(data);
+        file->mSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fileDescriptor = ::open(path.c_str(), O_RDONLY);
+        if (fileDescriptor < 0)
+        {
+            return nullptr;
+        }
+
+        file->mFileDescriptor = fileDescriptor;
+
+        struct stat fileStat{};
+        if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            return nullptr;
+        }
+
+        void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (data == MAP_FAILED)
+        {
+            return nullptr;
+        }
+
+        // 整个文件会被顺序读一遍（拷进暂存环），提示内核预读
+        madvise(data, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+        file->mData = static_cast<const uint8_t*>(data);
+        file->mSize = static_cast<size_t>(fileStat.st_size);
+#endif
+
+        return file;
+    }
+
+    MappedFile::~MappedFile()
+    {
+#ifdef _WIN32
+        if (mData != nullptr)
+        {
+            UnmapViewOfFile(mData);
+        }
+
+        if (mMappingHandle != nullptr)
+        {
+            CloseHandle(mMappingHandle);
+        }
+
+        if (mFileHandle != nullptr)
+        {
+            CloseHandle(mFileHandle);
+        }
+#else
+        if (mData != nullptr)
+        {
+            munmap(const_cast<uint8_t*>(mData), mSize);
+        }
+
+        if (mFileDescriptor >= 0)
+        {
+            close(mFileDescriptor);
+        }
+#endif
+    }
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // 只读内存映射文件
+    // 文件内容按需由操作系统换页进来，调用方直接使用映射地址，不经过中间缓冲
+    // ==================================================================
+    class MappedFile
+    {
+    public:
+        using Ptr = std::shared_ptr<MappedFile>;
+
+        /// 打开失败（文件不存在、为空或映射失败）时返回 nullptr
+        static Ptr open(const std::string& path);
+
+        MappedFile() = default;
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        [[nodiscard]] const uint8_t* getData() const { return mData; }
+        [[nodiscard]] size_t         getSize() const { return mSize; }
+
+    private:
+        const uint8_t* mData{ nullptr };
+        size_t         mSize{ 0 };
+
+#ifdef _WIN32
+        void* mFileHandle{ nullptr };
+        void* mMappingHandle{ nullptr };
+#else
+        int mFileDescriptor{ -1 };
+#endif
+    };
+}
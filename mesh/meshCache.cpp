@@ -0,0 +1,161 @@
+﻿#include "meshCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace LearnVulkan
+{
+    static uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static bool getSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time)
+    {
+        std::error_code error;
+
+        auto fileSize = std::filesystem::file_size(sourcePath, error);
+        if (error)
+        {
+            return false;
+        }
+
+        auto writeTime = std::filesystem::last_write_time(sourcePath, error);
+        if (error)
+        {
+            return false;
+        }
+
+        size = static_cast<uint64_t>(fileSize);
+        time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+
+        return true;
+    }
+
+    MeshCache::Ptr MeshCache::load(const std::string& sourcePath)
+    {
+        uint64_t sourceSize = 0;
+        int64_t  sourceTime = 0;
+        if (!getSourceStamp(sourcePath, sourceSize, sourceTime))
+        {
+            return nullptr;
+        }
+
+        auto file = MappedFile::open(getCachePath(sourcePath));
+        if (file == nullptr || file->getSize() < sizeof(MeshCacheHeader))
+        {
+            return nullptr;
+        }
+
+        MeshCacheHeader header{};
+        memcpy(&header, file->getData(), sizeof(header));
+
+        if (header.mMagic != MAGIC ||
+            header.mVersion != VERSION ||
+            header.mSourceSize != sourceSize ||
+            header.mSourceTime != sourceTime ||
+            (header.mIndexSize != 2 && header.mIndexSize != 4))
+        {
+            return nullptr;
+        }
+
+        uint64_t positionSize = uint64_t(header.mVertexCount) * 3 * sizeof(float);
+        uint64_t uvSize       = uint64_t(header.mVertexCount) * 2 * sizeof(float);
+        uint64_t indexSize    = uint64_t(header.mIndexCount) * header.mIndexSize;
+        uint64_t fileSize     = file->getSize();
+
+        // 截断或损坏的文件不能让后续拷贝越界读取
+        if (header.mPositionOffset + positionSize > fileSize ||
+            header.mUVOffset + uvSize > fileSize ||
+            header.mIndexOffset + indexSize > fileSize ||
+            header.mPositionOffset % STREAM_ALIGNMENT != 0 ||
+            header.mUVOffset % STREAM_ALIGNMENT != 0 ||
+            header.mIndexOffset % STREAM_ALIGNMENT != 0)
+        {
+            return nullptr;
+        }
+
+        auto cache   = std::make_shared<MeshCache>();
+        cache->mFile = file;
+
+        auto& streams        = cache->mStreams;
+        streams.mPositions   = reinterpret_cast<const float*>(file->getData() + header.mPositionOffset);
+        streams.mUVs         = reinterpret_cast<const float*>(file->getData() + header.mUVOffset);
+        streams.mIndices     = file->getData() + header.mIndexOffset;
+        streams.mVertexCount = header.mVertexCount;
+        streams.mIndexCount  = header.mIndexCount;
+        streams.mIndexSize   = header.mIndexSize;
+        memcpy(streams.mBoundsMin, header.mBoundsMin, sizeof(streams.mBoundsMin));
+        memcpy(streams.mBoundsMax, header.mBoundsMax, sizeof(streams.mBoundsMax));
+
+        return cache;
+    }
+
+    bool MeshCache::write(const std::string& sourcePath, const MeshStreams& streams)
+    {
+        MeshCacheHeader header{};
+        header.mMagic       = MAGIC;
+        header.mVersion     = VERSION;
+        header.mVertexCount = streams.mVertexCount;
+        header.mIndexCount  = streams.mIndexCount;
+        header.mIndexSize   = streams.mIndexSize;
+        memcpy(header.mBoundsMin, streams.mBoundsMin, sizeof(header.mBoundsMin));
+        memcpy(header.mBoundsMax, streams.mBoundsMax, sizeof(header.mBoundsMax));
+
+        if (!getSourceStamp(sourcePath, header.mSourceSize, header.mSourceTime))
+        {
+            return false;
+        }
+
+        uint64_t positionSize = uint64_t(streams.mVertexCount) * 3 * sizeof(float);
+        uint64_t uvSize       = uint64_t(streams.mVertexCount) * 2 * sizeof(float);
+        uint64_t indexSize    = uint64_t(streams.mIndexCount) * streams.mIndexSize;
+
+        header.mPositionOffset = alignUp(sizeof(MeshCacheHeader), STREAM_ALIGNMENT);
+        header.mUVOffset       = alignUp(header.mPositionOffset + positionSize, STREAM_ALIGNMENT);
+        header.mIndexOffset    = alignUp(header.mUVOffset + uvSize, STREAM_ALIGNMENT);
+
+        // 先写临时文件再改名，中途退出不会留下半个缓存
+        std::string cachePath = getCachePath(sourcePath);
+        std::string tempPath  = cachePath + ".tmp";
+
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                return false;
+            }
+
+            static const char padding[STREAM_ALIGNMENT]{};
+
+            auto writeStream = [&file](uint64_t offset, const void* data, uint64_t size)
+            {
+                uint64_t position = static_cast<uint64_t>(file.tellp());
+                file.write(padding, static_cast<std::streamsize>(offset - position));
+                file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            };
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            writeStream(header.mPositionOffset, streams.mPositions, positionSize);
+            writeStream(header.mUVOffset, streams.mUVs, uvSize);
+            writeStream(header.mIndexOffset, streams.mIndices, indexSize);
+
+            if (!file)
+            {
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+        if (error)
+        {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+
+        return true;
+    }
+}
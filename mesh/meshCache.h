@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "mappedFile.h"
+
+namespace LearnVulkan
+{
+    /// 一份网格的 CPU 端数据视图，既可以指向解析结果，也可以直接指向缓存文件的映射
+    struct MeshStreams
+    {
+        const float* mPositions{ nullptr };   // XYZ，每顶点 3 个 float
+        const float* mUVs{ nullptr };         // UV，每顶点 2 个 float
+        const void*  mIndices{ nullptr };     // 16 或 32 位索引
+        uint32_t     mVertexCount{ 0 };
+        uint32_t     mIndexCount{ 0 };
+        uint32_t     mIndexSize{ 4 };         // 每个索引的字节数
+        float        mBoundsMin[3]{};
+        float        mBoundsMax[3]{};
+    };
+
+    /// 缓存文件头，文件里紧跟按 STREAM_ALIGNMENT 对齐的位置 / UV / 索引三段数据
+    struct MeshCacheHeader
+    {
+        uint32_t mMagic{ 0 };
+        uint32_t mVersion{ 0 };
+        uint64_t mSourceSize{ 0 };       // 源 .obj 的大小与修改时间，任一不同即视为过期
+        int64_t  mSourceTime{ 0 };
+        uint32_t mVertexCount{ 0 };
+        uint32_t mIndexCount{ 0 };
+        uint32_t mIndexSize{ 0 };
+        uint32_t mReserved{ 0 };
+        float    mBoundsMin[3]{};
+        float    mBoundsMax[3]{};
+        uint64_t mPositionOffset{ 0 };
+        uint64_t mUVOffset{ 0 };
+        uint64_t mIndexOffset{ 0 };
+    };
+
+    // ==================================================================
+    // 二进制网格缓存
+    // 第一次加载 .obj 后在旁边写出 <name>.obj.bmesh，之后直接映射该文件，
+    // 各数据段的地址原样交给暂存上传，不再解析文本或复制到中间数组
+    // ==================================================================
+    class MeshCache
+    {
+    public:
+        using Ptr = std::shared_ptr<MeshCache>;
+
+        static constexpr uint32_t MAGIC            = 0x48534D42;  // "BMSH"
+        static constexpr uint32_t VERSION          = 1;
+        static constexpr uint64_t STREAM_ALIGNMENT = 64;
+
+        static std::string getCachePath(const std::string& sourcePath) { return sourcePath + ".bmesh"; }
+
+        /// 缓存不存在、版本不符、源文件已改动或文件损坏时返回 nullptr
+        static Ptr load(const std::string& sourcePath);
+
+        /// 写入失败只影响下次启动速度，因此返回 false 而不抛异常
+        static bool write(const std::string& sourcePath, const MeshStreams& streams);
+
+        [[nodiscard]] const MeshStreams& getStreams() const { return mStreams; }
+
+    private:
+        MappedFile::Ptr mFile{ nullptr };
+        MeshStreams     mStreams{};
+    };
+}
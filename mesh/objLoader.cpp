@@ -0,0 +1,542 @@
+﻿#include "objLoader.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "mappedFile.h"
+
+namespace LearnVulkan
+{
+    namespace
+    {
+        struct ChunkInfo
+        {
+            size_t mBegin{ 0 };
+            size_t mEnd{ 0 };
+
+            // 第一遍统计的数量，前缀和之后变成写入偏移
+            size_t mPositionCount{ 0 };
+            size_t mTexcoordCount{ 0 };
+            size_t mNormalCount{ 0 };
+            size_t mTriangleCount{ 0 };
+
+            size_t mPositionOffset{ 0 };
+            size_t mTexcoordOffset{ 0 };
+            size_t mNormalOffset{ 0 };
+            size_t mTriangleOffset{ 0 };
+
+            std::string mError{};
+        };
+
+        inline bool isSpace(char c)
+        {
+            return c == ' ' || c == '\t';
+        }
+
+        inline bool isLineEnd(char c)
+        {
+            return c == '\n' || c == '\r';
+        }
+
+        inline const char* skipSpaces(const char* p, const char* end)
+        {
+            while (p < end && isSpace(*p))
+            {
+                ++p;
+            }
+            return p;
+        }
+
+        inline const char* findLineEnd(const char* p, const char* end)
+        {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+            return eol != nullptr ? eol : end;
+        }
+
+        /// 记录类型：只识别几何相关的 v / vt / vn / f
+        enum class Record
+        {
+            Other,
+            Position,
+            Texcoord,
+            Normal,
+            Face
+        };
+
+        inline Record classify(const char*& p, const char* end)
+        {
+            if (end - p < 2)
+            {
+                return Record::Other;
+            }
+
+            if (p[0] == 'v')
+            {
+                if (isSpace(p[1]))
+                {
+                    p += 2;
+                    return Record::Position;
+                }
+
+                if (end - p >= 3 && isSpace(p[2]))
+                {
+                    if (p[1] == 't')
+                    {
+                        p += 3;
+                        return Record::Texcoord;
+                    }
+
+                    if (p[1] == 'n')
+                    {
+                        p += 3;
+                        return Record::Normal;
+                    }
+                }
+            }
+            else if (p[0] == 'f' && isSpace(p[1]))
+            {
+                p += 2;
+                return Record::Face;
+            }
+
+            return Record::Other;
+        }
+
+        /// 面记录中的顶点个数（以空白分隔的token数）
+        inline size_t countFaceVertices(const char* p, const char* end)
+        {
+            size_t count = 0;
+            while (true)
+            {
+                p = skipSpaces(p, end);
+                if (p >= end || isLineEnd(*p) || *p == '#')
+                {
+                    return count;
+                }
+
+                ++count;
+                while (p < end && !isSpace(*p) && !isLineEnd(*p))
+                {
+                    ++p;
+                }
+            }
+        }
+
+        /// 不依赖 locale 的浮点解析，返回解析结束的位置；没有数字时返回 nullptr
+        inline const char* parseFloat(const char* p, const char* end, float& value)
+        {
+            static const double powersOf10[] =
+            {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+
+            p = skipSpaces(p, end);
+
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+'))
+            {
+                negative = *p == '-';
+                ++p;
+            }
+
+            uint64_t mantissa = 0;
+            int      exponent = 0;
+            int      digits   = 0;
+
+            while (p < end && *p >= '0' && *p <= '9')
+            {
+                if (mantissa < 1000000000000000000ull)
+                {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                }
+                else
+                {
+                    ++exponent;
+                }
+                ++p;
+                ++digits;
+            }
+
+            if (p < end && *p == '.')
+            {
+                ++p;
+                while (p < end && *p >= '0' && *p <= '9')
+                {
+                    if (mantissa < 1000000000000000000ull)
+                    {
+                        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                        --exponent;
+                    }
+                    ++p;
+                    ++digits;
+                }
+            }
+
+            if (digits == 0)
+            {
+                return nullptr;
+            }
+
+            if (p < end && (*p == 'e' || *p == 'E'))
+            {
+                const char* q = p + 1;
+
+                bool negativeExponent = false;
+                if (q < end && (*q == '-' || *q == '+'))
+                {
+                    negativeExponent = *q == '-';
+                    ++q;
+                }
+
+                if (q < end && *q >= '0' && *q <= '9')
+                {
+                    int e = 0;
+                    while (q < end && *q >= '0' && *q <= '9')
+                    {
+                        e = std::min(e * 10 + (*q - '0'), 10000);
+                        ++q;
+                    }
+
+                    exponent += negativeExponent ? -e : e;
+                    p = q;
+                }
+            }
+
+            double result = static_cast<double>(mantissa);
+            if (exponent < 0)
+            {
+                result = -exponent <= 22 ? result / powersOf10[-exponent] : result * std::pow(10.0, exponent);
+            }
+            else if (exponent > 0)
+            {
+                result = exponent <= 22 ? result * powersOf10[exponent] : result * std::pow(10.0, exponent);
+            }
+
+            value = static_cast<float>(negative ? -result : result);
+
+            return p;
+        }
+
+        inline const char* parseInt(const char* p, const char* end, int64_t& value)
+        {
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+'))
+            {
+                negative = *p == '-';
+                ++p;
+            }
+
+            if (p >= end || *p < '0' || *p > '9')
+            {
+                return nullptr;
+            }
+
+            int64_t result = 0;
+            while (p < end && *p >= '0' && *p <= '9')
+            {
+                // 超出范围的下标之后会被 resolveIndex 拒绝，这里只需避免溢出
+                result = std::min<int64_t>(result * 10 + (*p - '0'), INT64_C(1) << 40);
+                ++p;
+            }
+
+            value = negative ? -result : result;
+
+            return p;
+        }
+
+        /// OBJ 下标从 1 开始，负数表示相对当前已定义的数量；转换为从 0 开始的绝对下标
+        inline bool resolveIndex(int64_t index, size_t definedCount, size_t totalCount, int32_t& resolved)
+        {
+            int64_t absolute = index > 0 ? index - 1 : static_cast<int64_t>(definedCount) + index;
+
+            if (index == 0 || absolute < 0 || absolute >= static_cast<int64_t>(totalCount))
+            {
+                return false;
+            }
+
+            resolved = static_cast<int32_t>(absolute);
+            return true;
+        }
+
+        void countChunk(const char* data, ChunkInfo& chunk)
+        {
+            const char* p   = data + chunk.mBegin;
+            const char* end = data + chunk.mEnd;
+
+            while (p < end)
+            {
+                const char* eol  = findLineEnd(p, end);
+                const char* line = skipSpaces(p, eol);
+
+                switch (classify(line, eol))
+                {
+                case Record::Position:
+                    ++chunk.mPositionCount;
+                    break;
+                case Record::Texcoord:
+                    ++chunk.mTexcoordCount;
+                    break;
+                case Record::Normal:
+                    ++chunk.mNormalCount;
+                    break;
+                case Record::Face:
+                {
+                    size_t vertexCount = countFaceVertices(line, eol);
+                    if (vertexCount >= 3)
+                    {
+                        chunk.mTriangleCount += vertexCount - 2;
+                    }
+                    break;
+                }
+                default:
+                    break;
+                }
+
+                p = eol < end ? eol + 1 : end;
+            }
+        }
+
+        void parseChunk(const char* data, ChunkInfo& chunk, ObjMesh& mesh)
+        {
+            const char* p   = data + chunk.mBegin;
+            const char* end = data + chunk.mEnd;
+
+            size_t positionIndex = chunk.mPositionOffset;
+            size_t texcoordIndex = chunk.mTexcoordOffset;
+            size_t normalIndex   = chunk.mNormalOffset;
+            ObjIndex* triangles  = mesh.mIndices.data() + chunk.mTriangleOffset * 3;
+
+            const size_t positionTotal = mesh.mPositions.size() / 3;
+            const size_t texcoordTotal = mesh.mTexcoords.size() / 2;
+            const size_t normalTotal   = mesh.mNormals.size() / 3;
+
+            // 多边形按扇形三角化，最多缓存首顶点和上一个顶点
+            ObjIndex first{};
+            ObjIndex previous{};
+
+            while (p < end)
+            {
+                const char* eol  = findLineEnd(p, end);
+                const char* line = skipSpaces(p, eol);
+
+                switch (classify(line, eol))
+                {
+                case Record::Position:
+                {
+                    float* out = mesh.mPositions.data() + positionIndex * 3;
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        line = line != nullptr ? parseFloat(line, eol, out[i]) : nullptr;
+                    }
+
+                    if (line == nullptr)
+                    {
+                        chunk.mError = "invalid vertex position";
+                        return;
+                    }
+
+                    ++positionIndex;
+                    break;
+                }
+                case Record::Texcoord:
+                {
+                    float* out = mesh.mTexcoords.data() + texcoordIndex * 2;
+
+                    line = parseFloat(line, eol, out[0]);
+                    if (line == nullptr)
+                    {
+                        chunk.mError = "invalid texture coordinate";
+                        return;
+                    }
+
+                    if (parseFloat(line, eol, out[1]) == nullptr)
+                    {
+                        out[1] = 0.0f;
+                    }
+
+                    ++texcoordIndex;
+                    break;
+                }
+                case Record::Normal:
+                {
+                    float* out = mesh.mNormals.data() + normalIndex * 3;
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        line = line != nullptr ? parseFloat(line, eol, out[i]) : nullptr;
+                    }
+
+                    if (line == nullptr)
+                    {
+                        chunk.mError = "invalid vertex normal";
+                        return;
+                    }
+
+                    ++normalIndex;
+                    break;
+                }
+                case Record::Face:
+                {
+                    size_t vertex = 0;
+
+                    while (true)
+                    {
+                        line = skipSpaces(line, eol);
+                        if (line >= eol || isLineEnd(*line) || *line == '#')
+                        {
+                            break;
+                        }
+
+                        ObjIndex index{};
+                        int64_t  value = 0;
+
+                        line = parseInt(line, eol, value);
+                        if (line == nullptr || !resolveIndex(value, positionIndex, positionTotal, index.mPosition))
+                        {
+                            chunk.mError = "invalid face position index";
+                            return;
+                        }
+
+                        if (line < eol && *line == '/')
+                        {
+                            ++line;
+
+                            if (line < eol && *line != '/')
+                            {
+                                line = parseInt(line, eol, value);
+                                if (line == nullptr || !resolveIndex(value, texcoordIndex, texcoordTotal, index.mTexcoord))
+                                {
+                                    chunk.mError = "invalid face texcoord index";
+                                    return;
+                                }
+                            }
+
+                            if (line < eol && *line == '/')
+                            {
+                                ++line;
+
+                                line = parseInt(line, eol, value);
+                                if (line == nullptr || !resolveIndex(value, normalIndex, normalTotal, index.mNormal))
+                                {
+                                    chunk.mError = "invalid face normal index";
+                                    return;
+                                }
+                            }
+                        }
+
+                        if (vertex == 0)
+                        {
+                            first = index;
+                        }
+                        else if (vertex >= 2)
+                        {
+                            triangles[0] = first;
+                            triangles[1] = previous;
+                            triangles[2] = index;
+                            triangles += 3;
+                        }
+
+                        previous = index;
+                        ++vertex;
+                    }
+                    break;
+                }
+                default:
+                    break;
+                }
+
+                p = eol < end ? eol + 1 : end;
+            }
+        }
+    }
+
+    bool ObjLoader::load(const std::string& path, ObjMesh& mesh, ThreadPool& threadPool, std::string& error)
+    {
+        auto file = MappedFile::open(path);
+        if (file == nullptr)
+        {
+            error = "Error: failed to open " + path;
+            return false;
+        }
+
+        if (!parse(reinterpret_cast<const char*>(file->getData()), file->getSize(), mesh, threadPool, error))
+        {
+            error += " in " + path;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool ObjLoader::parse(const char* data, size_t size, ObjMesh& mesh, ThreadPool& threadPool, std::string& error)
+    {
+        // 每个线程分到若干块以平衡负载，块也不宜过小
+        constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+        size_t chunkCount = std::max<size_t>(1, std::min<size_t>(size / MIN_CHUNK_SIZE, (threadPool.getThreadCount() + 1) * 4));
+
+        // 切块边界对齐到换行之后，保证每行只属于一个块
+        std::vector<ChunkInfo> chunks(chunkCount);
+        size_t begin = 0;
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            size_t target = i + 1 == chunkCount ? size : std::max(begin, size / chunkCount * (i + 1));
+
+            if (target < size)
+            {
+                const char* eol = static_cast<const char*>(memchr(data + target, '\n', size - target));
+                target = eol != nullptr ? static_cast<size_t>(eol - data) + 1 : size;
+            }
+
+            chunks[i].mBegin = begin;
+            chunks[i].mEnd   = target;
+            begin            = target;
+        }
+
+        threadPool.parallelFor(chunkCount, [&](size_t i) { countChunk(data, chunks[i]); });
+
+        // 前缀和：每块的写入偏移
+        size_t positionCount = 0;
+        size_t texcoordCount = 0;
+        size_t normalCount   = 0;
+        size_t triangleCount = 0;
+
+        for (auto& chunk : chunks)
+        {
+            chunk.mPositionOffset = positionCount;
+            chunk.mTexcoordOffset = texcoordCount;
+            chunk.mNormalOffset   = normalCount;
+            chunk.mTriangleOffset = triangleCount;
+
+            positionCount += chunk.mPositionCount;
+            texcoordCount += chunk.mTexcoordCount;
+            normalCount   += chunk.mNormalCount;
+            triangleCount += chunk.mTriangleCount;
+        }
+
+        if (positionCount > static_cast<size_t>(INT32_MAX))
+        {
+            error = "Error: too many vertices";
+            return false;
+        }
+
+        // 一次性分配到最终大小，第二遍各块直接写入自己的区间
+        mesh.mPositions.resize(positionCount * 3);
+        mesh.mTexcoords.resize(texcoordCount * 2);
+        mesh.mNormals.resize(normalCount * 3);
+        mesh.mIndices.resize(triangleCount * 3);
+
+        threadPool.parallelFor(chunkCount, [&](size_t i) { parseChunk(data, chunks[i], mesh); });
+
+        for (const auto& chunk : chunks)
+        {
+            if (!chunk.mError.empty())
+            {
+                error = "Error: " + chunk.mError;
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../threadPool.h"
+
+namespace LearnVulkan
+{
+    /// 一个三角形顶点引用的属性下标（已转换为从 0 开始的绝对下标，缺省为 -1）
+    struct ObjIndex
+    {
+        int32_t mPosition{ -1 };
+        int32_t mTexcoord{ -1 };
+        int32_t mNormal{ -1 };
+    };
+
+    /// 解析结果：属性数组与三角化后的索引，布局与 tinyobj::attrib_t 一致
+    struct ObjMesh
+    {
+        std::vector<float>    mPositions{};   // XYZ
+        std::vector<float>    mTexcoords{};   // UV
+        std::vector<float>    mNormals{};     // XYZ
+        std::vector<ObjIndex> mIndices{};     // 每 3 个构成一个三角形
+    };
+
+    // ==================================================================
+    // 多线程 OBJ 解析器
+    // 文件按行边界切块：第一遍各块并行统计 v / vt / vn / 三角形数量，
+    // 前缀和得到每块的写入偏移并一次性分配输出；第二遍各块并行解析直接写入最终位置。
+    // 只处理几何记录，o / g / s / usemtl / mtllib 等记录被忽略
+    // ==================================================================
+    class ObjLoader
+    {
+    public:
+        /// 失败时返回 false 并在 error 中给出原因
+        static bool load(const std::string& path, ObjMesh& mesh, ThreadPool& threadPool, std::string& error);
+
+        /// 直接解析一段内存中的 OBJ 文本
+        static bool parse(const char* data, size_t size, ObjMesh& mesh, ThreadPool& threadPool, std::string& error);
+    };
+}
@@ -1,40 +1,188 @@
 #include "model.h"
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
+#include <cstring>
+#include <limits>
+
+#include "mesh/objLoader.h"
+#include "vulkanWrapper/cpuProfiler.h"
 
 namespace LearnVulkan
 {
-    void Model::loadModel(const std::string& path, const Wrapper::Device::Ptr& device)
+    namespace
+    {
+        // 去重用的顶点键：位置 / UV 完全相同的 OBJ 顶点合并为一个；
+        // 顶点格式中没有法线，按法线区分只会多出上传内容相同的顶点
+        struct VertexKey
+        {
+            float mValues[5]{};
+
+            bool operator==(const VertexKey& other) const
+            {
+                return memcmp(mValues, other.mValues, sizeof(mValues)) == 0;
+            }
+        };
+
+        struct VertexKeyHash
+        {
+            size_t operator()(const VertexKey& key) const
+            {
+                size_t seed = 0;
+                for (float value : key.mValues)
+                {
+                    uint32_t bits = 0;
+                    memcpy(&bits, &value, sizeof(bits));
+                    seed ^= std::hash<uint32_t>()(bits) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                }
+                return seed;
+            }
+        };
+    }
+
+    void Model::loadModel(const std::string& path, const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine, ThreadPool& threadPool)
     {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string err;
-        std::string warn;
+        CPU_PROFILE_ZONE("Model::loadModel");
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        // 缓存有效时直接映射，各数据段地址原样交给暂存上传
+        if (auto cache = MeshCache::load(path))
+        {
+            uploadStreams(cache->getStreams(), device, uploadEngine);
+
+            auto loadTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+            std::cout << "Model " << path << ": loaded from " << MeshCache::getCachePath(path)
+                      << " in " << loadTime << " ms" << std::endl;
+            return;
+        }
+
+        parseObj(path, threadPool);
 
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str()))
+        MeshStreams streams{};
+        streams.mPositions   = mPositions.data();
+        streams.mUVs         = mUVs.data();
+        streams.mVertexCount = static_cast<uint32_t>(mPositions.size() / 3);
+        streams.mIndexCount  = static_cast<uint32_t>(mIndexDatas.size());
+
+        for (int axis = 0; axis < 3; ++axis)
         {
-            throw std::runtime_error(err);
+            streams.mBoundsMin[axis] = streams.mVertexCount > 0 ? std::numeric_limits<float>::max() : 0.0f;
+            streams.mBoundsMax[axis] = streams.mVertexCount > 0 ? std::numeric_limits<float>::lowest() : 0.0f;
         }
 
-        for (const auto& shape : shapes)
+        for (size_t i = 0; i < mPositions.size(); i += 3)
         {
-            for (const auto& index : shape.mesh.indices)
+            for (int axis = 0; axis < 3; ++axis)
             {
-                mPositions.push_back(attrib.vertices[3 * index.vertex_index + 0]);
-                mPositions.push_back(attrib.vertices[3 * index.vertex_index + 1]);
-                mPositions.push_back(attrib.vertices[3 * index.vertex_index + 2]);
+                streams.mBoundsMin[axis] = std::min(streams.mBoundsMin[axis], mPositions[i + axis]);
+                streams.mBoundsMax[axis] = std::max(streams.mBoundsMax[axis], mPositions[i + axis]);
+            }
+        }
+
+        // 顶点数不超过 65535 时改用 16 位索引，索引缓冲减半
+        std::vector<uint16_t> indices16{};
+        if (streams.mVertexCount <= std::numeric_limits<uint16_t>::max())
+        {
+            indices16.assign(mIndexDatas.begin(), mIndexDatas.end());
+
+            streams.mIndices   = indices16.data();
+            streams.mIndexSize = sizeof(uint16_t);
+        }
+        else
+        {
+            streams.mIndices   = mIndexDatas.data();
+            streams.mIndexSize = sizeof(uint32_t);
+        }
+
+        uploadStreams(streams, device, uploadEngine);
 
-                mUVs.push_back(attrib.texcoords[2 * index.texcoord_index + 0]);
-                mUVs.push_back(1.0f - attrib.texcoords[2 * index.texcoord_index + 1]);
+        if (!MeshCache::write(path, streams))
+        {
+            std::cout << "Warning: failed to write mesh cache " << MeshCache::getCachePath(path) << std::endl;
+        }
+
+        auto loadTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        std::cout << "Model " << path << ": parsed in " << loadTime << " ms" << std::endl;
+    }
 
-                mIndexDatas.push_back(mIndexDatas.size());
+    void Model::parseObj(const std::string& path, ThreadPool& threadPool)
+    {
+        // 多线程解析：按行切块并行处理，输出数组一次性分配到最终大小
+        ObjMesh     mesh{};
+        std::string error;
+
+        if (!ObjLoader::load(path, mesh, threadPool, error))
+        {
+            throw std::runtime_error(error);
+        }
+
+        size_t objIndexCount = mesh.mIndices.size();
+
+        std::unordered_map<VertexKey, uint32_t, VertexKeyHash> uniqueVertices{};
+        uniqueVertices.reserve(objIndexCount);
+
+        mIndexDatas.reserve(objIndexCount);
+        // 去重后的顶点数通常接近 OBJ 中的位置数，按它预留可避免大部分扩容
+        mPositions.reserve(mesh.mPositions.size());
+        mUVs.reserve(mesh.mPositions.size() / 3 * 2);
+
+        for (const auto& index : mesh.mIndices)
+        {
+            VertexKey key{};
+
+            key.mValues[0] = mesh.mPositions[3 * index.mPosition + 0];
+            key.mValues[1] = mesh.mPositions[3 * index.mPosition + 1];
+            key.mValues[2] = mesh.mPositions[3 * index.mPosition + 2];
+
+            if (index.mTexcoord >= 0)
+            {
+                key.mValues[3] = mesh.mTexcoords[2 * index.mTexcoord + 0];
+                key.mValues[4] = 1.0f - mesh.mTexcoords[2 * index.mTexcoord + 1];
+            }
+
+            auto [it, inserted] = uniqueVertices.try_emplace(key, static_cast<uint32_t>(uniqueVertices.size()));
+
+            if (inserted)
+            {
+                mPositions.insert(mPositions.end(), key.mValues, key.mValues + 3);
+                mUVs.insert(mUVs.end(), key.mValues + 3, key.mValues + 5);
             }
+
+            mIndexDatas.push_back(it->second);
+        }
+
+        size_t vertexCount = uniqueVertices.size();
+
+        std::cout << "Model " << path << ": vertices " << objIndexCount << " -> " << vertexCount
+                  << ", indices " << mIndexDatas.size() << std::endl;
+    }
+
+    void Model::uploadStreams(const MeshStreams& streams, const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine)
+    {
+        mIndexCount = streams.mIndexCount;
+        mIndexType  = streams.mIndexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        mBoundsMin  = glm::vec3(streams.mBoundsMin[0], streams.mBoundsMin[1], streams.mBoundsMin[2]);
+        mBoundsMax  = glm::vec3(streams.mBoundsMax[0], streams.mBoundsMax[1], streams.mBoundsMax[2]);
+
+        mPositionBuffer = Wrapper::Buffer::createVertexBuffer(device, streams.mVertexCount * 3 * sizeof(float), streams.mPositions, uploadEngine);
+        mUVBuffer       = Wrapper::Buffer::createVertexBuffer(device, streams.mVertexCount * 2 * sizeof(float), streams.mUVs, uploadEngine);
+        mIndexBuffer    = Wrapper::Buffer::createIndexBuffer(device, streams.mIndexCount * streams.mIndexSize, streams.mIndices, uploadEngine);
+
+        // 未设置实例时只有一个单位矩阵实例，与不实例化的绘制等价
+        if (mInstanceBuffer == nullptr)
+        {
+            setInstances({ glm::mat4(1.0f) }, device, uploadEngine);
+        }
+    }
+
+    void Model::setInstances(const std::vector<glm::mat4>& matrices, const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine)
+    {
+        if (matrices.empty())
+        {
+            throw std::runtime_error("Error: a model needs at least one instance!");
         }
 
-        mPositionBuffer = Wrapper::Buffer::createVertexBuffer(device, mPositions.size() * sizeof(float), mPositions.data());
-        mUVBuffer = Wrapper::Buffer::createVertexBuffer(device, mUVs.size() * sizeof(float), mUVs.data());
-        mIndexBuffer = Wrapper::Buffer::createIndexBuffer(device, mIndexDatas.size() * sizeof(float), mIndexDatas.data());
+        mInstanceMatrices = matrices;
+        mInstanceCount    = static_cast<uint32_t>(matrices.size());
+        mInstanceBuffer   = Wrapper::Buffer::createStorageBuffer(device, matrices.size() * sizeof(glm::mat4), matrices.data(), uploadEngine, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
     }
-}
\ No newline at end of file
+}
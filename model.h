@@ -3,8 +3,13 @@
 #include "vulkanWrapper/base.h"
 #include "vulkanWrapper/buffer.h"
 #include "vulkanWrapper/device.h"
+#include "vulkanWrapper/uploadEngine.h"
 #include "vulkanWrapper/descriptorSet.h"
 #include "vulkanWrapper/description.h"
+#include "mesh/meshCache.h"
+#include "threadPool.h"
+
+#include <algorithm>
 
 namespace LearnVulkan
 {
@@ -22,7 +27,8 @@ namespace LearnVulkan
         {
         }
 
-        void loadModel(const std::string& path, const Wrapper::Device::Ptr& device);
+        /// 缓存失效时在 threadPool 上并行解析 OBJ
+        void loadModel(const std::string& path, const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine, ThreadPool& threadPool);
 
         ~Model() {}
 
@@ -33,7 +39,7 @@ namespace LearnVulkan
         std::vector<VkVertexInputBindingDescription> getVertexInputBindingDescriptions()
         {
             std::vector<VkVertexInputBindingDescription> bindingDes{};
-            bindingDes.resize(2);
+            bindingDes.resize(3);
 
             // 位置属性绑定 (绑定点0)
             bindingDes[0].binding = 0;
@@ -50,13 +56,18 @@ namespace LearnVulkan
             bindingDes[1].stride = sizeof(float) * 2;
             bindingDes[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
+            // 实例矩阵绑定 (绑定点2，逐实例推进)
+            bindingDes[2].binding = 2;
+            bindingDes[2].stride = sizeof(glm::mat4);
+            bindingDes[2].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
             return bindingDes;
         }
 
         std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions()
         {
             std::vector<VkVertexInputAttributeDescription> attributeDes{};
-            attributeDes.resize(2);
+            attributeDes.resize(6);
 
             // 位置属性 (绑定点0, 位置索引0)
             attributeDes[0].binding  = 0;
@@ -80,6 +91,15 @@ namespace LearnVulkan
             //attributeDes[0].offset = offsetof(Vertex, mPosition);
             attributeDes[1].offset   = 0;                           // 在缓冲区起始位置
 
+            // 实例矩阵 (绑定点2, 位置索引2~5，每列一个 vec4)
+            for (uint32_t column = 0; column < 4; ++column)
+            {
+                attributeDes[2 + column].binding  = 2;
+                attributeDes[2 + column].location = 2 + column;
+                attributeDes[2 + column].format   = VK_FORMAT_R32G32B32A32_SFLOAT;
+                attributeDes[2 + column].offset   = column * sizeof(glm::vec4);
+            }
+
             return attributeDes;
         }
 
@@ -96,7 +116,8 @@ namespace LearnVulkan
             {
                 mPositionBuffer->getBuffer(),
                 //mColorBuffer->getBuffer(),
-                mUVBuffer->getBuffer()
+                mUVBuffer->getBuffer(),
+                mInstanceBuffer->getBuffer()
             };
 
             return buffers;
@@ -111,7 +132,50 @@ namespace LearnVulkan
         /// 获取索引数量
         [[nodiscard]] auto getIndexCount() const
         {
-            return mIndexDatas.size();
+            return mIndexCount;
+        }
+
+        /// 获取模型空间包围盒
+        [[nodiscard]] auto getBoundsMin() const { return mBoundsMin; }
+        [[nodiscard]] auto getBoundsMax() const { return mBoundsMax; }
+
+        /// 获取索引类型（顶点数允许时为 16 位）
+        [[nodiscard]] auto getIndexType() const
+        {
+            return mIndexType;
+        }
+
+        /// 上传逐实例的模型矩阵，实例数随之设为 matrices.size()
+        void setInstances(const std::vector<glm::mat4>& matrices, const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine);
+
+        /// 只绘制前 count 个实例（不超过已上传的实例数）
+        void setInstanceCount(uint32_t count)
+        {
+            mInstanceCount = std::min(count, static_cast<uint32_t>(mInstanceMatrices.size()));
+        }
+
+        [[nodiscard]] auto getInstanceCount() const { return mInstanceCount; }
+
+        [[nodiscard]] const auto& getInstanceMatrices() const { return mInstanceMatrices; }
+
+        /// 实例矩阵缓冲，同时可作为顶点输入与计算着色器的存储缓冲
+        [[nodiscard]] auto getInstanceBuffer() const { return mInstanceBuffer; }
+
+        /// 相机到原点的距离，实例铺开时需要拉远；同时把相机放回 +Z 轴上注视原点
+        void setCameraDistance(float distance)
+        {
+            mCameraDistance = distance;
+            mCameraEye      = glm::vec3(0.0f, 0.0f, distance);
+            mCameraTarget   = glm::vec3(0.0f);
+        }
+
+        [[nodiscard]] auto getCameraDistance() const { return mCameraDistance; }
+
+        /// 由相机路径驱动时每帧设置相机位置与注视点
+        void setCamera(const glm::vec3& eye, const glm::vec3& target)
+        {
+            mCameraEye    = eye;
+            mCameraTarget = target;
         }
 
         /// 获取模型统一变量
@@ -131,24 +195,28 @@ namespace LearnVulkan
             mUniform.mModelMatrix = matrix;
         }
 
-        /// 每帧更新模型（旋转动画）
-        void update(unsigned int width, unsigned int height)
+        /// 每帧更新模型（旋转动画）；time 为动画时间（秒），由调用方决定取墙钟还是固定步长，保证基准可复现
+        void update(unsigned int width, unsigned int height, float time)
         {
-            static auto startTime = std::chrono::high_resolution_clock::now();
-            auto currentTime      = std::chrono::high_resolution_clock::now();
-            float time            = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-   
             mUniform.mModelMatrix = glm::rotate(glm::mat4(1.0f), time * glm::radians(10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 
-            mVPUniform.mProjectionMatrix = glm::perspective(glm::radians(60.0f), width / (float)height, 0.1f, 1000.0f);
+            // 反向 Z：近、远平面对调，近处映射到深度 1、远处映射到 0，配合浮点深度缓冲使精度均匀分布
+            mVPUniform.mProjectionMatrix = glm::perspective(glm::radians(60.0f), width / (float)height, std::max(1000.0f, (glm::length(mCameraEye - mCameraTarget) + mCameraDistance) * 2.0f), 0.1f);
 
-            mVPUniform.mViewMatrix = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            mVPUniform.mViewMatrix = glm::lookAt(mCameraEye, mCameraTarget, glm::vec3(0.0f, 1.0f, 0.0f));
         }
     private:
-        // 原始模型数据
+        /// 解析 OBJ 文本并按 (位置, UV, 法线) 去重
+        void parseObj(const std::string& path, ThreadPool& threadPool);
+
+        /// 把网格数据（解析结果或缓存文件的映射）上传到 GPU 缓冲
+        void uploadStreams(const MeshStreams& streams, const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine);
+
+    private:
+        // 原始模型数据（从缓存加载时为空）
         std::vector<float>        mPositions{};          // 顶点位置数据 (XYZ)
         std::vector<float>        mColors{};             // 顶点颜色数据 (RGB)
-        std::vector<unsigned int> mIndexDatas{};         // 索引数据 (uint32_t)
+        std::vector<unsigned int> mIndexDatas{};         // 去重后的索引数据 (uint32_t)
         std::vector<float>        mUVs{};                // 纹理UV坐标 (UV)
         
         // GPU缓冲区对象
@@ -157,9 +225,20 @@ namespace LearnVulkan
         Wrapper::Buffer::Ptr mColorBuffer{ nullptr };     // 颜色数据缓冲区
         Wrapper::Buffer::Ptr mUVBuffer{ nullptr };        // UV数据缓冲区
         Wrapper::Buffer::Ptr mIndexBuffer{ nullptr };     // 索引数据缓冲区
+        Wrapper::Buffer::Ptr mInstanceBuffer{ nullptr };  // 实例矩阵缓冲区（逐实例顶点绑定）
+        VkIndexType          mIndexType{ VK_INDEX_TYPE_UINT32 };
+        size_t               mIndexCount{ 0 };
+        glm::vec3            mBoundsMin{ 0.0f };
+        glm::vec3            mBoundsMax{ 0.0f };
 
         ObjectUniform        mUniform;                    // 模型统一变量
         VPMatrices           mVPUniform;                  // 视图投影矩阵统一变量
         float                mAngle{ 0.0f };              // 当前旋转角度（度）
+        float                mCameraDistance{ 2.0f };     // 相机到原点的距离
+        glm::vec3            mCameraEye{ 0.0f, 0.0f, 2.0f };
+        glm::vec3            mCameraTarget{ 0.0f };
+
+        std::vector<glm::mat4> mInstanceMatrices{};       // 实例矩阵的 CPU 副本
+        uint32_t               mInstanceCount{ 0 };       // 每次绘制的实例数
     };
 }
@@ -0,0 +1,269 @@
+﻿// 计算管线示例：阈值压缩 + 间接派发，并与 CPU 参考结果比对
+//
+// 第一步 sampleCompact.comp 把大于阈值的元素压缩到连续区间，同时写出第二步的 VkDispatchIndirectCommand；
+// 第二步 sampleScale.comp 由 vkCmdDispatchIndirect 派发，借用第一步的管线布局，只处理压缩后的元素。
+// 不创建窗口与表面，可以在软件 ICD 上运行，例如 lavapipe：
+//   VK_DRIVER_FILES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./Bona_compute_sample
+//
+// 用法：Bona_compute_sample [--count N] [--threshold T] [--device NAME|INDEX] [--validation]
+// 结果一致时返回 0，否则返回 1
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../vulkanWrapper/base.h"
+#include "../vulkanWrapper/instance.h"
+#include "../vulkanWrapper/device.h"
+#include "../vulkanWrapper/buffer.h"
+#include "../vulkanWrapper/commandPool.h"
+#include "../vulkanWrapper/commandBuffer.h"
+#include "../vulkanWrapper/computePipeline.h"
+#include "../vulkanWrapper/descriptorSetLayout.h"
+#include "../vulkanWrapper/descriptorPool.h"
+#include "../vulkanWrapper/descriptorSet.h"
+
+using namespace LearnVulkan;
+
+namespace
+{
+    constexpr uint32_t GROUP_SIZE = 64;
+
+    /// 与两个着色器中的 SampleConstants 一致
+    struct SampleConstants
+    {
+        uint32_t mCount{ 0 };
+        float    mThreshold{ 0.5f };
+        float    mScale{ 3.0f };
+        float    mBias{ -1.0f };
+    };
+
+    /// 与着色器中的 Arguments 一致，前三个成员即 VkDispatchIndirectCommand
+    struct SampleArguments
+    {
+        uint32_t mGroupCountX{ 0 };
+        uint32_t mGroupCountY{ 1 };
+        uint32_t mGroupCountZ{ 1 };
+        uint32_t mCompactedCount{ 0 };
+    };
+
+    /// 固定种子的线性同余序列，保证每次运行输入相同
+    std::vector<float> makeInput(uint32_t count)
+    {
+        std::vector<float> values(count);
+
+        uint32_t state = 12345u;
+        for (auto& value : values)
+        {
+            state = state * 1664525u + 1013904223u;
+            value = static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+        }
+
+        return values;
+    }
+
+    Wrapper::Buffer::Ptr createHostStorageBuffer(const Wrapper::Device::Ptr& device, VkDeviceSize size, VkBufferUsageFlags extraUsage = 0)
+    {
+        // 示例数据量小，直接用常驻映射的主机可见内存，省去暂存拷贝，结果也可以直接读回
+        return Wrapper::Buffer::create(device,
+                                       size,
+                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | extraUsage,
+                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    }
+
+    template<typename T>
+    const T* mapped(const Wrapper::Buffer::Ptr& buffer)
+    {
+        return static_cast<const T*>(buffer->getAllocation().mMappedData);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t count      = 1u << 20;
+    float    threshold  = 0.5f;
+    bool     validation = false;
+
+    std::string deviceSelector{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--count" && i + 1 < argc)
+        {
+            count = static_cast<uint32_t>(std::max(1ul, std::stoul(argv[++i])));
+        }
+        else if (arg == "--threshold" && i + 1 < argc)
+        {
+            threshold = std::stof(argv[++i]);
+        }
+        else if (arg == "--device" && i + 1 < argc)
+        {
+            deviceSelector = argv[++i];
+        }
+        else if (arg == "--validation")
+        {
+            validation = true;
+        }
+        else
+        {
+            std::cout << "Warning: unknown argument " << arg << std::endl;
+        }
+    }
+
+    try
+    {
+        auto                        instance = Wrapper::Instance::create(validation);
+        Wrapper::WindowSurface::Ptr surface{ nullptr };
+        auto                        device   = Wrapper::Device::create(instance, surface, deviceSelector);
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(device->getPhysicalDevice(), &properties);
+        std::cout << "Device: " << properties.deviceName << std::endl;
+
+        SampleConstants constants{};
+        constants.mCount     = count;
+        constants.mThreshold = threshold;
+
+        std::vector<float> input = makeInput(count);
+
+        auto inputBuffer     = createHostStorageBuffer(device, count * sizeof(float));
+        auto compactedBuffer = createHostStorageBuffer(device, count * sizeof(float));
+        auto argumentBuffer  = createHostStorageBuffer(device, sizeof(SampleArguments), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+        auto outputBuffer    = createHostStorageBuffer(device, count * sizeof(float));
+
+        SampleArguments arguments{};
+        inputBuffer->updateBufferByMap(input.data(), input.size() * sizeof(float));
+        argumentBuffer->updateBufferByMap(&arguments, sizeof(arguments));
+
+        // 四个存储缓冲对应着色器的绑定点 0~3
+        std::vector<Wrapper::UniformParameter::Ptr> params{};
+        for (const auto& buffer : { inputBuffer, compactedBuffer, argumentBuffer, outputBuffer })
+        {
+            auto param             = Wrapper::UniformParameter::create();
+            param->mBinding        = static_cast<uint32_t>(params.size());
+            param->mCount          = 1;
+            param->mDescriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            param->mStage          = VK_SHADER_STAGE_COMPUTE_BIT;
+            param->mBuffers.push_back(buffer);
+            params.push_back(param);
+        }
+
+        auto descriptorSetLayout = Wrapper::DescriptorSetLayout::create(device);
+        descriptorSetLayout->build(params);
+
+        auto descriptorPool = Wrapper::DescriptorPool::create(device);
+        descriptorPool->build(params, 1);
+
+        auto descriptorSet = Wrapper::DescriptorSet::create(device, params, descriptorSetLayout, descriptorPool, 1);
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset     = 0;
+        pushConstantRange.size       = sizeof(SampleConstants);
+
+        auto layout = descriptorSetLayout->getLayout();
+
+        auto compactPipeline = Wrapper::ComputePipeline::create(device);
+        compactPipeline->setShader(Wrapper::Shader::create(device, "shaders/sample_compact.spv", VK_SHADER_STAGE_COMPUTE_BIT, "main"));
+        compactPipeline->mLayoutState.setLayoutCount         = 1;
+        compactPipeline->mLayoutState.pSetLayouts            = &layout;
+        compactPipeline->mLayoutState.pushConstantRangeCount = 1;
+        compactPipeline->mLayoutState.pPushConstantRanges    = &pushConstantRange;
+        compactPipeline->build();
+
+        // 第二步沿用第一步的布局，绑定的描述符集与推送常量在两次派发之间保持有效
+        auto scalePipeline = Wrapper::ComputePipeline::create(device);
+        scalePipeline->setShader(Wrapper::Shader::create(device, "shaders/sample_scale.spv", VK_SHADER_STAGE_COMPUTE_BIT, "main"));
+        scalePipeline->setLayout(compactPipeline->getLayout());
+        scalePipeline->build();
+
+        auto commandPool   = Wrapper::CommandPool::create(device);
+        auto commandBuffer = Wrapper::CommandBuffer::create(device, commandPool);
+
+        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        commandBuffer->bindComputePipeline(compactPipeline->getPipeline());
+        commandBuffer->bindDescriptorSet(VK_PIPELINE_BIND_POINT_COMPUTE, compactPipeline->getLayout(), descriptorSet->getDescriptorSet(0));
+        commandBuffer->pushConstants(compactPipeline->getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+        commandBuffer->dispatch((count + GROUP_SIZE - 1) / GROUP_SIZE);
+
+        commandBuffer->bufferMemoryBarrier(compactedBuffer->getBuffer(),
+                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+        commandBuffer->bufferMemoryBarrier(argumentBuffer->getBuffer(),
+                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                           VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                           VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+
+        commandBuffer->bindComputePipeline(scalePipeline->getPipeline());
+        commandBuffer->dispatchIndirect(argumentBuffer->getBuffer());
+
+        // 结果由主机读回
+        commandBuffer->bufferMemoryBarrier(outputBuffer->getBuffer(),
+                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                           VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+
+        commandBuffer->end();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        commandBuffer->submitSync(device->getGraphicQueue());
+        double gpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        // CPU 参考：压缩顺序由原子操作决定，排序后再逐个比较
+        start = std::chrono::high_resolution_clock::now();
+
+        std::vector<float> expected{};
+        for (float value : input)
+        {
+            if (value > threshold)
+            {
+                expected.push_back(value * constants.mScale + constants.mBias);
+            }
+        }
+
+        double cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        const auto* gpuArguments = mapped<SampleArguments>(argumentBuffer);
+        uint32_t    gpuCount     = gpuArguments->mCompactedCount;
+
+        bool  countMatches = gpuCount == expected.size();
+        bool  groupsMatch  = gpuArguments->mGroupCountX == (expected.size() + GROUP_SIZE - 1) / GROUP_SIZE;
+        float maxError     = 0.0f;
+
+        if (countMatches)
+        {
+            const float*       gpuOutput = mapped<float>(outputBuffer);
+            std::vector<float> actual(gpuOutput, gpuOutput + gpuCount);
+
+            std::sort(actual.begin(), actual.end());
+            std::sort(expected.begin(), expected.end());
+
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                maxError = std::max(maxError, std::abs(actual[i] - expected[i]));
+            }
+        }
+
+        bool passed = countMatches && groupsMatch && maxError <= 1e-5f;
+
+        std::cout << "Elements: " << count << ", above threshold: " << expected.size() << " (GPU " << gpuCount << ")" << std::endl;
+        std::cout << "Indirect groups: " << gpuArguments->mGroupCountX << (groupsMatch ? "" : " (MISMATCH)") << std::endl;
+        std::cout << "GPU submit + wait: " << gpuMilliseconds << " ms, CPU reference: " << cpuMilliseconds << " ms" << std::endl;
+        std::cout << "Max error: " << maxError << std::endl;
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+
+        return passed ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -8,6 +8,7 @@
 layout(location = 0) in vec3 inPosition;  // 顶点位置（模型空间）
 //layout(location = 1) in vec3 inColor;     // 顶点颜色（RGB）
 layout(location = 1) in vec2 inUV;        // 纹理坐标（UV）
+layout(location = 2) in mat4 inInstance;  // 实例变换矩阵（逐实例，占用 location 2~5）
 
 // ---- 输出到片段着色器的数据 ----
 //layout(location = 0) out vec3 outColor;   // 传递顶点颜色
@@ -31,10 +32,10 @@ layout(binding = 1) uniform ObjectUniform
 void main()
 {
     // 顶点位置变换流水线：
-    // 1. 模型空间 -> 世界空间 (mModelMatrix)
+    // 1. 模型空间 -> 世界空间 (mModelMatrix，再叠加逐实例的 inInstance)
     // 2. 世界空间 -> 观察空间 (mViewMatrix)
     // 3. 观察空间 -> 裁剪空间 (mProjectionMatrix)
-    gl_Position = vpUBO.mProjectionMatrix * vpUBO.mViewMatrix * objectUBO.mModelMatrix * vec4(inPosition, 1.0);
+    gl_Position = vpUBO.mProjectionMatrix * vpUBO.mViewMatrix * inInstance * objectUBO.mModelMatrix * vec4(inPosition, 1.0);
 
     // 传递颜色和纹理坐标到片段着色器
     //outColor = inColor;  // 输出原始顶点颜色
@@ -2,4 +2,10 @@ C:\VulkanSDK\1.4.313.0\Bin\glslangValidator.exe  -V VertexShader.vert -o vs.spv
 
 C:\VulkanSDK\1.4.313.0\Bin\glslangValidator.exe  -V FragmentShader.frag -o fs.spv
 
+C:\VulkanSDK\1.4.313.0\Bin\glslangValidator.exe  -V cull.comp -o cull.spv
+
+C:\VulkanSDK\1.4.313.0\Bin\glslangValidator.exe  -V sampleCompact.comp -o sample_compact.spv
+
+C:\VulkanSDK\1.4.313.0\Bin\glslangValidator.exe  -V sampleScale.comp -o sample_scale.spv
+
 pause
\ No newline at end of file
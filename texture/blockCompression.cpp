@@ -0,0 +1,843 @@
+﻿#include "blockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace LearnVulkan
+{
+    // BC7 4 位索引的插值权重（/64）
+    static const uint32_t BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    /// 点集在前 channels 个通道上的均值与主成分方向（幂迭代）
+    static void principalAxis(const float (*points)[4], uint32_t count, uint32_t channels, float* mean, float* axis)
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            mean[c] = 0.0f;
+            axis[c] = 0.0f;
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                mean[c] += points[i][c];
+            }
+        }
+
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            mean[c] /= static_cast<float>(count);
+        }
+
+        float covariance[4][4]{};
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            for (uint32_t a = 0; a < channels; ++a)
+            {
+                for (uint32_t b = 0; b < channels; ++b)
+                {
+                    covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+                }
+            }
+        }
+
+        // 从方差最大的通道出发，几次迭代即可收敛到足够好的方向
+        uint32_t largest = 0;
+        for (uint32_t c = 1; c < channels; ++c)
+        {
+            if (covariance[c][c] > covariance[largest][largest])
+            {
+                largest = c;
+            }
+        }
+
+        float vector[4]{};
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            vector[c] = covariance[largest][c];
+        }
+
+        for (uint32_t iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4]{};
+            float length = 0.0f;
+            for (uint32_t a = 0; a < channels; ++a)
+            {
+                for (uint32_t b = 0; b < channels; ++b)
+                {
+                    next[a] += covariance[a][b] * vector[b];
+                }
+                length += next[a] * next[a];
+            }
+
+            if (length < 1e-12f)
+            {
+                break;
+            }
+
+            length = std::sqrt(length);
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                vector[c] = next[c] / length;
+            }
+        }
+
+        float length = 0.0f;
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            length += vector[c] * vector[c];
+        }
+
+        // 所有点重合时方向无关紧要
+        if (length < 1e-12f)
+        {
+            axis[0] = 1.0f;
+            return;
+        }
+
+        length = std::sqrt(length);
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            axis[c] = vector[c] / length;
+        }
+    }
+
+    /// 沿主成分方向取两端作为初始端点
+    static void fitEndpoints(const float (*points)[4], uint32_t count, uint32_t channels, float* endpoint0, float* endpoint1)
+    {
+        float mean[4];
+        float axis[4];
+        principalAxis(points, count, channels, mean, axis);
+
+        float minT = 0.0f;
+        float maxT = 0.0f;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float t = 0.0f;
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                t += (points[i][c] - mean[c]) * axis[c];
+            }
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            endpoint0[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+            endpoint1[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        }
+    }
+
+    /// 已知每个点的插值权重 weights[i]（端点 1 的占比）时，按最小二乘求两个端点；方程退化时返回 false
+    static bool leastSquaresEndpoints(const float (*points)[4], const float* weights, uint32_t count, uint32_t channels, float* endpoint0, float* endpoint1)
+    {
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        float ax[4]{};
+        float bx[4]{};
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float b = weights[i];
+            float a = 1.0f - b;
+
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                ax[c] += a * points[i][c];
+                bx[c] += b * points[i][c];
+            }
+        }
+
+        float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6f)
+        {
+            return false;
+        }
+
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            endpoint0[c] = std::clamp((bb * ax[c] - ab * bx[c]) / determinant, 0.0f, 255.0f);
+            endpoint1[c] = std::clamp((aa * bx[c] - ab * ax[c]) / determinant, 0.0f, 255.0f);
+        }
+
+        return true;
+    }
+
+    static void loadPoints(const uint8_t* pixels, float (*points)[4])
+    {
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                points[i][c] = static_cast<float>(pixels[i * 4 + c]);
+            }
+        }
+    }
+
+    // -------------------- BC1 --------------------
+
+    static uint16_t packRGB565(const float* color)
+    {
+        uint32_t r = static_cast<uint32_t>(std::lround(color[0] * 31.0f / 255.0f));
+        uint32_t g = static_cast<uint32_t>(std::lround(color[1] * 63.0f / 255.0f));
+        uint32_t b = static_cast<uint32_t>(std::lround(color[2] * 31.0f / 255.0f));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    static void unpackRGB565(uint16_t packed, int* color)
+    {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    /// 四色模式的调色板
+    static void paletteBC1(uint16_t color0, uint16_t color1, int (*palette)[3])
+    {
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    }
+
+    /// 为每个点选最近的调色板项，返回总误差
+    static uint32_t assignIndicesBC1(const float (*points)[4], const int (*palette)[3], uint32_t* indices)
+    {
+        uint32_t totalError = 0;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t bestError = UINT32_MAX;
+            for (uint32_t p = 0; p < 4; ++p)
+            {
+                uint32_t error = 0;
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    int d  = static_cast<int>(points[i][c]) - palette[p][c];
+                    error += static_cast<uint32_t>(d * d);
+                }
+
+                if (error < bestError)
+                {
+                    bestError  = error;
+                    indices[i] = p;
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    void BlockCompression::encodeBlockBC1(const uint8_t* pixels, uint8_t* block)
+    {
+        static const float WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+        float points[16][4];
+        loadPoints(pixels, points);
+
+        float endpoint0[4]{};
+        float endpoint1[4]{};
+        fitEndpoints(points, 16, 3, endpoint0, endpoint1);
+
+        uint16_t bestColor0 = 0;
+        uint16_t bestColor1 = 0;
+        uint32_t bestIndices[16]{};
+        uint32_t bestError  = UINT32_MAX;
+
+        // 第一轮用主成分端点，第二轮用最小二乘重新拟合的端点，保留误差较小的一组
+        for (uint32_t pass = 0; pass < 2; ++pass)
+        {
+            uint16_t color0 = packRGB565(endpoint1);
+            uint16_t color1 = packRGB565(endpoint0);
+
+            // 四色模式要求 color0 > color1
+            if (color0 < color1)
+            {
+                std::swap(color0, color1);
+            }
+
+            int palette[4][3];
+            paletteBC1(color0, color1, palette);
+
+            uint32_t indices[16];
+            uint32_t error = assignIndicesBC1(points, palette, indices);
+
+            if (color0 == color1)
+            {
+                std::fill(indices, indices + 16, 0u);
+            }
+
+            if (error < bestError)
+            {
+                bestError  = error;
+                bestColor0 = color0;
+                bestColor1 = color1;
+                std::copy(indices, indices + 16, bestIndices);
+            }
+
+            float weights[16];
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                weights[i] = WEIGHTS[indices[i]];
+            }
+
+            // 权重是相对 color0 -> color1 的占比，对应 endpoint0 -> endpoint1 时需要对调
+            if (!leastSquaresEndpoints(points, weights, 16, 3, endpoint1, endpoint0))
+            {
+                break;
+            }
+        }
+
+        uint32_t packedIndices = 0;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            packedIndices |= bestIndices[i] << (i * 2);
+        }
+
+        block[0] = static_cast<uint8_t>(bestColor0 & 0xFF);
+        block[1] = static_cast<uint8_t>(bestColor0 >> 8);
+        block[2] = static_cast<uint8_t>(bestColor1 & 0xFF);
+        block[3] = static_cast<uint8_t>(bestColor1 >> 8);
+        memcpy(block + 4, &packedIndices, 4);
+    }
+
+    void BlockCompression::decodeBlockBC1(const uint8_t* block, uint8_t* pixels, bool allowTransparent)
+    {
+        uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+        uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+
+        uint32_t packedIndices = 0;
+        memcpy(&packedIndices, block + 4, 4);
+
+        int palette[4][3];
+        paletteBC1(color0, color1, palette);
+
+        // 三色模式：第三项取中点，第四项为透明黑（BC3 的颜色块总是四色模式）
+        bool threeColor = allowTransparent && color0 <= color1;
+        if (threeColor)
+        {
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t index = (packedIndices >> (i * 2)) & 3;
+            pixels[i * 4 + 0] = static_cast<uint8_t>(palette[index][0]);
+            pixels[i * 4 + 1] = static_cast<uint8_t>(palette[index][1]);
+            pixels[i * 4 + 2] = static_cast<uint8_t>(palette[index][2]);
+            pixels[i * 4 + 3] = threeColor && index == 3 ? 0 : 255;
+        }
+    }
+
+    // -------------------- BC4 / BC3 / BC5 --------------------
+
+    static void paletteBC4(uint32_t value0, uint32_t value1, uint32_t* palette)
+    {
+        palette[0] = value0;
+        palette[1] = value1;
+
+        if (value0 > value1)
+        {
+            for (uint32_t i = 2; i < 8; ++i)
+            {
+                palette[i] = ((8 - i) * value0 + (i - 1) * value1) / 7;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 2; i < 6; ++i)
+            {
+                palette[i] = ((6 - i) * value0 + (i - 1) * value1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void BlockCompression::encodeBlockBC4(const uint8_t* pixels, uint32_t channel, uint8_t* block)
+    {
+        uint32_t minValue = 255;
+        uint32_t maxValue = 0;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            minValue = std::min<uint32_t>(minValue, pixels[i * 4 + channel]);
+            maxValue = std::max<uint32_t>(maxValue, pixels[i * 4 + channel]);
+        }
+
+        // 八值模式（value0 > value1）；整块同值时所有索引为 0
+        uint32_t palette[8];
+        paletteBC4(maxValue, minValue, palette);
+
+        uint64_t packedIndices = 0;
+        if (maxValue != minValue)
+        {
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                int      value     = pixels[i * 4 + channel];
+                uint32_t bestIndex = 0;
+                int      bestError = 256;
+
+                for (uint32_t p = 0; p < 8; ++p)
+                {
+                    int error = std::abs(value - static_cast<int>(palette[p]));
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        bestIndex = p;
+                    }
+                }
+
+                packedIndices |= uint64_t(bestIndex) << (i * 3);
+            }
+        }
+
+        block[0] = static_cast<uint8_t>(maxValue);
+        block[1] = static_cast<uint8_t>(minValue);
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            block[2 + i] = static_cast<uint8_t>(packedIndices >> (i * 8));
+        }
+    }
+
+    void BlockCompression::decodeBlockBC4(const uint8_t* block, uint32_t channel, uint8_t* pixels)
+    {
+        uint32_t palette[8];
+        paletteBC4(block[0], block[1], palette);
+
+        uint64_t packedIndices = 0;
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            packedIndices |= uint64_t(block[2 + i]) << (i * 8);
+        }
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            pixels[i * 4 + channel] = static_cast<uint8_t>(palette[(packedIndices >> (i * 3)) & 7]);
+        }
+    }
+
+    void BlockCompression::encodeBlockBC3(const uint8_t* pixels, uint8_t* block)
+    {
+        encodeBlockBC4(pixels, 3, block);
+        encodeBlockBC1(pixels, block + 8);
+    }
+
+    void BlockCompression::encodeBlockBC5(const uint8_t* pixels, uint8_t* block)
+    {
+        encodeBlockBC4(pixels, 0, block);
+        encodeBlockBC4(pixels, 1, block + 8);
+    }
+
+    // -------------------- BC7（模式 6） --------------------
+
+    /// 低位在前的位写入 / 读取，BC7 块按 128 位小端整数解释
+    struct BitStream
+    {
+        uint8_t* mData{ nullptr };
+        uint32_t mPosition{ 0 };
+
+        void write(uint32_t value, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; ++i, ++mPosition)
+            {
+                if ((value >> i) & 1)
+                {
+                    mData[mPosition >> 3] |= static_cast<uint8_t>(1u << (mPosition & 7));
+                }
+            }
+        }
+
+        uint32_t read(uint32_t count)
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < count; ++i, ++mPosition)
+            {
+                value |= ((mData[mPosition >> 3] >> (mPosition & 7)) & 1u) << i;
+            }
+            return value;
+        }
+    };
+
+    /// 端点量化为 7 位 + 共享 P 位（四个通道共用），选误差较小的 P 位
+    static void quantizeEndpointBC7(const float* endpoint, uint32_t* quantized, uint32_t& pBit)
+    {
+        float bestError = INFINITY;
+
+        for (uint32_t p = 0; p < 2; ++p)
+        {
+            uint32_t candidate[4];
+            float    error = 0.0f;
+
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                int q = static_cast<int>(std::lround((endpoint[c] - static_cast<float>(p)) / 2.0f));
+                candidate[c] = static_cast<uint32_t>(std::clamp(q, 0, 127));
+
+                float d = static_cast<float>((candidate[c] << 1) | p) - endpoint[c];
+                error  += d * d;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                pBit      = p;
+                std::copy(candidate, candidate + 4, quantized);
+            }
+        }
+    }
+
+    static void paletteBC7(const uint32_t* endpoint0, const uint32_t* endpoint1, uint32_t (*palette)[4])
+    {
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t w = BC7_WEIGHTS4[i];
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                palette[i][c] = ((64 - w) * endpoint0[c] + w * endpoint1[c] + 32) >> 6;
+            }
+        }
+    }
+
+    static uint32_t assignIndicesBC7(const float (*points)[4], const uint32_t (*palette)[4], uint32_t* indices)
+    {
+        uint32_t totalError = 0;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t bestError = UINT32_MAX;
+            for (uint32_t p = 0; p < 16; ++p)
+            {
+                uint32_t error = 0;
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    int d  = static_cast<int>(points[i][c]) - static_cast<int>(palette[p][c]);
+                    error += static_cast<uint32_t>(d * d);
+                }
+
+                if (error < bestError)
+                {
+                    bestError  = error;
+                    indices[i] = p;
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    void BlockCompression::encodeBlockBC7(const uint8_t* pixels, uint8_t* block)
+    {
+        float points[16][4];
+        loadPoints(pixels, points);
+
+        float endpoint0[4]{};
+        float endpoint1[4]{};
+        fitEndpoints(points, 16, 4, endpoint0, endpoint1);
+
+        uint32_t bestEndpoints[2][4]{};
+        uint32_t bestPBits[2]{};
+        uint32_t bestIndices[16]{};
+        uint32_t bestError = UINT32_MAX;
+
+        for (uint32_t pass = 0; pass < 2; ++pass)
+        {
+            uint32_t quantized[2][4];
+            uint32_t pBits[2];
+            quantizeEndpointBC7(endpoint0, quantized[0], pBits[0]);
+            quantizeEndpointBC7(endpoint1, quantized[1], pBits[1]);
+
+            uint32_t expanded[2][4];
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                expanded[0][c] = (quantized[0][c] << 1) | pBits[0];
+                expanded[1][c] = (quantized[1][c] << 1) | pBits[1];
+            }
+
+            uint32_t palette[16][4];
+            paletteBC7(expanded[0], expanded[1], palette);
+
+            uint32_t indices[16];
+            uint32_t error = assignIndicesBC7(points, palette, indices);
+
+            if (error < bestError)
+            {
+                bestError = error;
+                memcpy(bestEndpoints, quantized, sizeof(bestEndpoints));
+                memcpy(bestPBits, pBits, sizeof(bestPBits));
+                std::copy(indices, indices + 16, bestIndices);
+            }
+
+            float weights[16];
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                weights[i] = BC7_WEIGHTS4[indices[i]] / 64.0f;
+            }
+
+            if (!leastSquaresEndpoints(points, weights, 16, 4, endpoint0, endpoint1))
+            {
+                break;
+            }
+        }
+
+        // 第一个纹素是锚点，索引最高位隐含为 0：超过 7 时交换端点并翻转全部索引
+        if (bestIndices[0] >= 8)
+        {
+            std::swap(bestEndpoints[0], bestEndpoints[1]);
+            std::swap(bestPBits[0], bestPBits[1]);
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                bestIndices[i] = 15 - bestIndices[i];
+            }
+        }
+
+        memset(block, 0, 16);
+
+        BitStream stream{ block, 0 };
+        stream.write(1u << 6, 7);  // 模式 6：6 个 0 之后一个 1
+
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            stream.write(bestEndpoints[0][c], 7);
+            stream.write(bestEndpoints[1][c], 7);
+        }
+
+        stream.write(bestPBits[0], 1);
+        stream.write(bestPBits[1], 1);
+
+        stream.write(bestIndices[0], 3);
+        for (uint32_t i = 1; i < 16; ++i)
+        {
+            stream.write(bestIndices[i], 4);
+        }
+    }
+
+    bool BlockCompression::decodeBlockBC7(const uint8_t* block, uint8_t* pixels)
+    {
+        uint8_t data[16];
+        memcpy(data, block, 16);
+
+        BitStream stream{ data, 0 };
+
+        uint32_t mode = 0;
+        while (mode < 8 && stream.read(1) == 0)
+        {
+            ++mode;
+        }
+
+        if (mode != 6)
+        {
+            return false;
+        }
+
+        uint32_t endpoints[2][4];
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] = stream.read(7);
+            endpoints[1][c] = stream.read(7);
+        }
+
+        uint32_t pBit0 = stream.read(1);
+        uint32_t pBit1 = stream.read(1);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] = (endpoints[0][c] << 1) | pBit0;
+            endpoints[1][c] = (endpoints[1][c] << 1) | pBit1;
+        }
+
+        uint32_t palette[16][4];
+        paletteBC7(endpoints[0], endpoints[1], palette);
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t index = stream.read(i == 0 ? 3 : 4);
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                pixels[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+            }
+        }
+
+        return true;
+    }
+
+    // -------------------- 整级编解码 --------------------
+
+    uint32_t BlockCompression::getBlockBytes(VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            return 8;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    VkDeviceSize BlockCompression::getLevelSize(VkFormat format, uint32_t width, uint32_t height)
+    {
+        uint32_t blockBytes = getBlockBytes(format);
+        if (blockBytes == 0)
+        {
+            return VkDeviceSize(width) * height * 4;
+        }
+
+        return VkDeviceSize((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+    }
+
+    std::vector<uint8_t> BlockCompression::encode(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format, ThreadPool& threadPool)
+    {
+        uint32_t blockBytes = getBlockBytes(format);
+        if (blockBytes == 0)
+        {
+            throw std::runtime_error("Error: unsupported block compression format!");
+        }
+
+        uint32_t blocksX = (width + 3) / 4;
+        uint32_t blocksY = (height + 3) / 4;
+
+        std::vector<uint8_t> blocks(size_t(blocksX) * blocksY * blockBytes);
+
+        threadPool.parallelFor(blocksY, [&](size_t by)
+        {
+            uint8_t pixels[64];
+
+            for (uint32_t bx = 0; bx < blocksX; ++bx)
+            {
+                // 边缘不满 4x4 的块复制最后一行 / 列
+                for (uint32_t y = 0; y < 4; ++y)
+                {
+                    uint32_t sy = std::min(static_cast<uint32_t>(by) * 4 + y, height - 1);
+                    for (uint32_t x = 0; x < 4; ++x)
+                    {
+                        uint32_t sx = std::min(bx * 4 + x, width - 1);
+                        memcpy(pixels + (y * 4 + x) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+                    }
+                }
+
+                uint8_t* block = blocks.data() + (by * blocksX + bx) * blockBytes;
+
+                switch (format)
+                {
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                case VK_FORMAT_BC3_SRGB_BLOCK:
+                    encodeBlockBC3(pixels, block);
+                    break;
+                case VK_FORMAT_BC4_UNORM_BLOCK:
+                    encodeBlockBC4(pixels, 0, block);
+                    break;
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                    encodeBlockBC5(pixels, block);
+                    break;
+                case VK_FORMAT_BC7_UNORM_BLOCK:
+                case VK_FORMAT_BC7_SRGB_BLOCK:
+                    encodeBlockBC7(pixels, block);
+                    break;
+                default:
+                    encodeBlockBC1(pixels, block);
+                    break;
+                }
+            }
+        });
+
+        return blocks;
+    }
+
+    bool BlockCompression::decode(const uint8_t* blocks, uint32_t width, uint32_t height, VkFormat format, uint8_t* rgba)
+    {
+        uint32_t blockBytes = getBlockBytes(format);
+        if (blockBytes == 0)
+        {
+            return false;
+        }
+
+        uint32_t blocksX = (width + 3) / 4;
+        uint32_t blocksY = (height + 3) / 4;
+
+        for (uint32_t by = 0; by < blocksY; ++by)
+        {
+            for (uint32_t bx = 0; bx < blocksX; ++bx)
+            {
+                const uint8_t* block = blocks + (size_t(by) * blocksX + bx) * blockBytes;
+
+                uint8_t pixels[64];
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    pixels[i * 4 + 0] = 0;
+                    pixels[i * 4 + 1] = 0;
+                    pixels[i * 4 + 2] = 0;
+                    pixels[i * 4 + 3] = 255;
+                }
+
+                switch (format)
+                {
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                    decodeBlockBC1(block, pixels, false);
+                    break;
+                case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                    decodeBlockBC1(block, pixels, true);
+                    break;
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                case VK_FORMAT_BC3_SRGB_BLOCK:
+                    decodeBlockBC1(block + 8, pixels, false);
+                    decodeBlockBC4(block, 3, pixels);
+                    break;
+                case VK_FORMAT_BC4_UNORM_BLOCK:
+                    decodeBlockBC4(block, 0, pixels);
+                    for (uint32_t i = 0; i < 16; ++i)
+                    {
+                        pixels[i * 4 + 1] = pixels[i * 4];
+                        pixels[i * 4 + 2] = pixels[i * 4];
+                    }
+                    break;
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                    decodeBlockBC4(block, 0, pixels);
+                    decodeBlockBC4(block + 8, 1, pixels);
+                    break;
+                default:
+                    if (!decodeBlockBC7(block, pixels))
+                    {
+                        return false;
+                    }
+                    break;
+                }
+
+                for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+                {
+                    for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x)
+                    {
+                        memcpy(rgba + ((size_t(by) * 4 + y) * width + bx * 4 + x) * 4, pixels + (y * 4 + x) * 4, 4);
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+}
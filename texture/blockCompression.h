@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include "../vulkanWrapper/base.h"
+#include "../threadPool.h"
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // BCn 块压缩：每 4x4 个纹素编码为 8 字节（BC1 / BC4）或 16 字节（BC3 / BC5 / BC7）
+    // BC1 / BC3 / BC7 用于颜色（sRGB 或线性），BC4 用于单通道，BC5 只存法线的 XY（着色器重建 Z）
+    // 编码：端点取主成分方向上的两端，量化后按最小二乘再拟合一次；BC7 只使用模式 6（单子集 RGBA）
+    // 解码用于设备不支持 BCn 时的回退，BC7 只能解码模式 6 的块（即本编码器的输出）
+    // ==================================================================
+    class BlockCompression
+    {
+    public:
+        /// 每个 4x4 块的字节数，非 BCn 格式返回 0
+        static uint32_t getBlockBytes(VkFormat format);
+
+        static bool isBlockCompressed(VkFormat format) { return getBlockBytes(format) != 0; }
+
+        /// 一级 mip 的字节数（块数向上取整），非 BCn 格式按 RGBA8 计算
+        static VkDeviceSize getLevelSize(VkFormat format, uint32_t width, uint32_t height);
+
+        /// RGBA8 像素整级编码，按块行分给线程池
+        static std::vector<uint8_t> encode(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format, ThreadPool& threadPool);
+
+        /// 解码为 RGBA8（BC4 复制到 RGB，BC5 的 B 为 0）；遇到无法解码的块返回 false
+        static bool decode(const uint8_t* blocks, uint32_t width, uint32_t height, VkFormat format, uint8_t* rgba);
+
+        /// 单块编解码，pixels 为 16 个按行排列的 RGBA8 纹素
+        static void encodeBlockBC1(const uint8_t* pixels, uint8_t* block);
+        static void encodeBlockBC3(const uint8_t* pixels, uint8_t* block);
+        static void encodeBlockBC4(const uint8_t* pixels, uint32_t channel, uint8_t* block);
+        static void encodeBlockBC5(const uint8_t* pixels, uint8_t* block);
+        static void encodeBlockBC7(const uint8_t* pixels, uint8_t* block);
+
+        static void decodeBlockBC1(const uint8_t* block, uint8_t* pixels, bool allowTransparent = true);
+        static void decodeBlockBC4(const uint8_t* block, uint32_t channel, uint8_t* pixels);
+        static bool decodeBlockBC7(const uint8_t* block, uint8_t* pixels);
+    };
+}
@@ -0,0 +1,285 @@
+﻿#include "ddsFile.h"
+#include "blockCompression.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace LearnVulkan
+{
+    static constexpr uint32_t DDS_MAGIC = 0x20534444;  // "DDS "
+
+    static constexpr uint32_t DDSD_CAPS        = 0x1;
+    static constexpr uint32_t DDSD_HEIGHT      = 0x2;
+    static constexpr uint32_t DDSD_WIDTH       = 0x4;
+    static constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+    static constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    static constexpr uint32_t DDSD_LINEARSIZE  = 0x80000;
+
+    static constexpr uint32_t DDPF_FOURCC = 0x4;
+
+    static constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+    static constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+    static constexpr uint32_t DDSCAPS_MIPMAP  = 0x400000;
+
+    static constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+    struct DdsPixelFormat
+    {
+        uint32_t mSize;
+        uint32_t mFlags;
+        uint32_t mFourCC;
+        uint32_t mRGBBitCount;
+        uint32_t mRBitMask;
+        uint32_t mGBitMask;
+        uint32_t mBBitMask;
+        uint32_t mABitMask;
+    };
+
+    struct DdsHeader
+    {
+        uint32_t       mSize;
+        uint32_t       mFlags;
+        uint32_t       mHeight;
+        uint32_t       mWidth;
+        uint32_t       mPitchOrLinearSize;
+        uint32_t       mDepth;
+        uint32_t       mMipMapCount;
+        uint32_t       mReserved1[11];
+        DdsPixelFormat mPixelFormat;
+        uint32_t       mCaps;
+        uint32_t       mCaps2;
+        uint32_t       mCaps3;
+        uint32_t       mCaps4;
+        uint32_t       mReserved2;
+    };
+
+    struct DdsHeaderDX10
+    {
+        uint32_t mDxgiFormat;
+        uint32_t mResourceDimension;
+        uint32_t mMiscFlag;
+        uint32_t mArraySize;
+        uint32_t mMiscFlags2;
+    };
+
+    static_assert(sizeof(DdsHeader) == 124, "DDS header must be 124 bytes");
+    static_assert(sizeof(DdsHeaderDX10) == 20, "DDS DX10 header must be 20 bytes");
+
+    static constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+    {
+        return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+    }
+
+    /// DXGI_FORMAT 与 VkFormat 的对应（只列出本项目会读写的格式）
+    static const struct
+    {
+        uint32_t mDxgi;
+        VkFormat mFormat;
+    } DXGI_FORMATS[] =
+    {
+        { 28, VK_FORMAT_R8G8B8A8_UNORM },
+        { 29, VK_FORMAT_R8G8B8A8_SRGB },
+        { 71, VK_FORMAT_BC1_RGBA_UNORM_BLOCK },
+        { 72, VK_FORMAT_BC1_RGBA_SRGB_BLOCK },
+        { 77, VK_FORMAT_BC3_UNORM_BLOCK },
+        { 78, VK_FORMAT_BC3_SRGB_BLOCK },
+        { 80, VK_FORMAT_BC4_UNORM_BLOCK },
+        { 83, VK_FORMAT_BC5_UNORM_BLOCK },
+        { 98, VK_FORMAT_BC7_UNORM_BLOCK },
+        { 99, VK_FORMAT_BC7_SRGB_BLOCK },
+    };
+
+    static VkFormat formatFromDxgi(uint32_t dxgi)
+    {
+        for (const auto& entry : DXGI_FORMATS)
+        {
+            if (entry.mDxgi == dxgi)
+            {
+                return entry.mFormat;
+            }
+        }
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    static uint32_t dxgiFromFormat(VkFormat format)
+    {
+        // BC1 的 RGB 变体在 DXGI 中与 RGBA 共用一个格式
+        if (format == VK_FORMAT_BC1_RGB_UNORM_BLOCK)
+        {
+            format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        }
+        else if (format == VK_FORMAT_BC1_RGB_SRGB_BLOCK)
+        {
+            format = VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+        }
+
+        for (const auto& entry : DXGI_FORMATS)
+        {
+            if (entry.mFormat == format)
+            {
+                return entry.mDxgi;
+            }
+        }
+        return 0;
+    }
+
+    static VkFormat formatFromFourCC(uint32_t fourCC)
+    {
+        switch (fourCC)
+        {
+        case makeFourCC('D', 'X', 'T', '1'): return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case makeFourCC('D', 'X', 'T', '5'): return VK_FORMAT_BC3_UNORM_BLOCK;
+        case makeFourCC('A', 'T', 'I', '1'):
+        case makeFourCC('B', 'C', '4', 'U'): return VK_FORMAT_BC4_UNORM_BLOCK;
+        case makeFourCC('A', 'T', 'I', '2'):
+        case makeFourCC('B', 'C', '5', 'U'): return VK_FORMAT_BC5_UNORM_BLOCK;
+        default:                             return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    DdsFile::Ptr DdsFile::load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to open " + path);
+        }
+
+        std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+        uint32_t  magic = 0;
+        DdsHeader header{};
+        if (bytes.size() < sizeof(magic) + sizeof(header))
+        {
+            throw std::runtime_error("Error: " + path + " is not a DDS file!");
+        }
+
+        memcpy(&magic, bytes.data(), sizeof(magic));
+        memcpy(&header, bytes.data() + sizeof(magic), sizeof(header));
+
+        if (magic != DDS_MAGIC || header.mSize != sizeof(DdsHeader) || header.mPixelFormat.mSize != sizeof(DdsPixelFormat))
+        {
+            throw std::runtime_error("Error: " + path + " is not a DDS file!");
+        }
+
+        size_t   dataOffset = sizeof(magic) + sizeof(header);
+        VkFormat format     = VK_FORMAT_UNDEFINED;
+
+        if ((header.mPixelFormat.mFlags & DDPF_FOURCC) && header.mPixelFormat.mFourCC == makeFourCC('D', 'X', '1', '0'))
+        {
+            DdsHeaderDX10 headerDX10{};
+            if (bytes.size() < dataOffset + sizeof(headerDX10))
+            {
+                throw std::runtime_error("Error: " + path + " is truncated!");
+            }
+
+            memcpy(&headerDX10, bytes.data() + dataOffset, sizeof(headerDX10));
+            dataOffset += sizeof(headerDX10);
+
+            if (headerDX10.mResourceDimension != DDS_DIMENSION_TEXTURE2D || headerDX10.mArraySize > 1)
+            {
+                throw std::runtime_error("Error: " + path + " is not a single 2D texture!");
+            }
+
+            format = formatFromDxgi(headerDX10.mDxgiFormat);
+        }
+        else if (header.mPixelFormat.mFlags & DDPF_FOURCC)
+        {
+            format = formatFromFourCC(header.mPixelFormat.mFourCC);
+        }
+        else if (header.mPixelFormat.mRGBBitCount == 32 &&
+                 header.mPixelFormat.mRBitMask == 0x000000FF &&
+                 header.mPixelFormat.mGBitMask == 0x0000FF00 &&
+                 header.mPixelFormat.mBBitMask == 0x00FF0000)
+        {
+            format = VK_FORMAT_R8G8B8A8_UNORM;
+        }
+
+        if (format == VK_FORMAT_UNDEFINED)
+        {
+            throw std::runtime_error("Error: unsupported pixel format in " + path);
+        }
+
+        auto dds     = std::make_shared<DdsFile>();
+        dds->mFormat = format;
+        dds->mWidth  = header.mWidth;
+        dds->mHeight = header.mHeight;
+
+        uint32_t levelCount = (header.mFlags & DDSD_MIPMAPCOUNT) ? std::max(1u, header.mMipMapCount) : 1;
+
+        VkDeviceSize totalSize = 0;
+        for (uint32_t level = 0, w = header.mWidth, h = header.mHeight; level < levelCount; ++level)
+        {
+            VkBufferImageCopy region{};
+            region.bufferOffset                    = totalSize;
+            region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel       = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount     = 1;
+            region.imageExtent                     = { w, h, 1 };
+            dds->mRegions.push_back(region);
+
+            totalSize += BlockCompression::getLevelSize(format, w, h);
+
+            w = std::max(1u, w / 2);
+            h = std::max(1u, h / 2);
+        }
+
+        if (bytes.size() < dataOffset + totalSize)
+        {
+            throw std::runtime_error("Error: " + path + " is truncated!");
+        }
+
+        dds->mData.assign(bytes.begin() + dataOffset, bytes.begin() + dataOffset + static_cast<size_t>(totalSize));
+
+        return dds;
+    }
+
+    void DdsFile::write(const std::string& path, VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels)
+    {
+        uint32_t dxgi = dxgiFromFormat(format);
+        if (dxgi == 0 || levels.empty())
+        {
+            throw std::runtime_error("Error: cannot write " + path + " in the requested format!");
+        }
+
+        DdsHeader header{};
+        header.mSize                     = sizeof(DdsHeader);
+        header.mFlags                    = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+        header.mHeight                   = height;
+        header.mWidth                    = width;
+        header.mPitchOrLinearSize        = static_cast<uint32_t>(levels[0].size());
+        header.mMipMapCount              = static_cast<uint32_t>(levels.size());
+        header.mPixelFormat.mSize        = sizeof(DdsPixelFormat);
+        header.mPixelFormat.mFlags       = DDPF_FOURCC;
+        header.mPixelFormat.mFourCC      = makeFourCC('D', 'X', '1', '0');
+        header.mCaps                     = DDSCAPS_TEXTURE | (levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+        DdsHeaderDX10 headerDX10{};
+        headerDX10.mDxgiFormat        = dxgi;
+        headerDX10.mResourceDimension = DDS_DIMENSION_TEXTURE2D;
+        headerDX10.mArraySize         = 1;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to create " + path);
+        }
+
+        file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+
+        for (const auto& level : levels)
+        {
+            file.write(reinterpret_cast<const char*>(level.data()), static_cast<std::streamsize>(level.size()));
+        }
+
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to write " + path);
+        }
+    }
+}
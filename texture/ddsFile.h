@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include "../vulkanWrapper/base.h"
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // DDS 读写（单个 2D 图像 + mip 链）
+    // 读取支持 DX10 扩展头（DXGI 格式）与旧式 FourCC（DXT1 / DXT5 / ATI1 / ATI2 等）；
+    // 写出总是带 DX10 头，以区分 sRGB 与线性格式。各级数据紧密排列，顺序从第 0 级开始
+    // ==================================================================
+    class DdsFile
+    {
+    public:
+        using Ptr = std::shared_ptr<DdsFile>;
+
+        /// 文件不存在、格式不受支持或数据被截断时抛出异常
+        static Ptr load(const std::string& path);
+
+        /// levels[i] 为第 i 级的完整数据
+        static void write(const std::string& path, VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels);
+
+        DdsFile() = default;
+
+        [[nodiscard]] auto getFormat()    const { return mFormat; }
+        [[nodiscard]] auto getWidth()     const { return mWidth; }
+        [[nodiscard]] auto getHeight()    const { return mHeight; }
+        [[nodiscard]] auto getMipLevels() const { return static_cast<uint32_t>(mRegions.size()); }
+
+        /// 所有级别的数据，regions 的 bufferOffset 相对它，可直接用于一次多区域拷贝
+        [[nodiscard]] const std::vector<uint8_t>&           getData()    const { return mData; }
+        [[nodiscard]] const std::vector<VkBufferImageCopy>& getRegions() const { return mRegions; }
+
+    private:
+        VkFormat                       mFormat{ VK_FORMAT_UNDEFINED };
+        uint32_t                       mWidth{ 0 };
+        uint32_t                       mHeight{ 0 };
+        std::vector<uint8_t>           mData{};
+        std::vector<VkBufferImageCopy> mRegions{};
+    };
+}
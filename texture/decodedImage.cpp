@@ -0,0 +1,236 @@
+﻿#include "decodedImage.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../stb_image.h"
+
+// RGB→RGBA 内核在运行时按 CPU 选择：默认构建（MSVC 不带 /arch、GCC / Clang 不带 -mssse3）也能用上 SIMD。
+// GCC / Clang 用 target 属性单独为内核打开指令集；MSVC 不需要，内建函数总是可用
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BONA_DECODE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BONA_DECODE_TARGET(isa)
+#else
+#define BONA_DECODE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace LearnVulkan
+{
+    namespace
+    {
+        /// 内核处理能整块处理的前若干个像素，返回处理的像素数，剩余的由调用方逐像素处理
+        using ExpandKernel = size_t (*)(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+
+        size_t expandScalar(const uint8_t*, uint8_t*, size_t)
+        {
+            return 0;
+        }
+
+#ifdef BONA_DECODE_X86
+        BONA_DECODE_TARGET("ssse3")
+        size_t expandSSSE3(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+        {
+            const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m128i alpha   = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+            size_t i = 0;
+            for (; i + 4 <= pixelCount && (pixelCount - i) * 3 >= 16; i += 4)
+            {
+                __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+            }
+
+            return i;
+        }
+
+        BONA_DECODE_TARGET("avx2")
+        size_t expandAVX2(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+        {
+            // 两个 128 位通道各取 4 个像素（12 字节），源的第二次加载从第 12 字节开始；
+            // pshufb 在通道内把 RGB 散开到 RGBx，再或上不透明的 alpha
+            const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                     0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m256i alpha   = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+            // 每次加载读 16 字节但只用 12 字节，留出 4 字节余量避免越界
+            size_t i = 0;
+            for (; i + 8 <= pixelCount && (pixelCount - i) * 3 >= 28; i += 8)
+            {
+                __m128i low  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+                __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + 12));
+
+                __m256i rgb  = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+                __m256i rgba = _mm256_or_si256(_mm256_shuffle_epi8(rgb, shuffle), alpha);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), rgba);
+            }
+
+            // 不足 8 个像素的部分再按 4 个一组处理
+            const __m128i shuffle128 = _mm256_castsi256_si128(shuffle);
+            const __m128i alpha128   = _mm256_castsi256_si128(alpha);
+
+            for (; i + 4 <= pixelCount && (pixelCount - i) * 3 >= 16; i += 4)
+            {
+                __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle128), alpha128));
+            }
+
+            return i;
+        }
+#endif
+
+        struct ExpandDispatch
+        {
+            ExpandKernel mKernel{ expandScalar };
+            const char*  mName{ "scalar" };
+        };
+
+        ExpandDispatch selectExpandKernel()
+        {
+            ExpandDispatch dispatch{};
+
+#ifdef BONA_DECODE_X86
+            bool ssse3 = false;
+            bool avx2  = false;
+
+#if defined(_MSC_VER)
+            // AVX2 还要求操作系统保存 YMM 寄存器（OSXSAVE 且 XCR0 的 SSE / AVX 位都打开）
+            int info[4];
+            __cpuid(info, 0);
+            int maxLeaf = info[0];
+
+            __cpuid(info, 1);
+            ssse3 = (info[2] & (1 << 9)) != 0;
+
+            bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            if (osAvx && maxLeaf >= 7)
+            {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+            }
+#else
+            __builtin_cpu_init();
+            ssse3 = __builtin_cpu_supports("ssse3");
+            avx2  = __builtin_cpu_supports("avx2");
+#endif
+
+            if (avx2)
+            {
+                dispatch = { expandAVX2, "avx2" };
+            }
+            else if (ssse3)
+            {
+                dispatch = { expandSSSE3, "ssse3" };
+            }
+#endif
+
+            return dispatch;
+        }
+
+        const ExpandDispatch& getExpandDispatch()
+        {
+            static const ExpandDispatch dispatch = selectExpandKernel();
+            return dispatch;
+        }
+    }
+
+    DecodedImage::Ptr DecodedImage::decode(const std::string& path)
+    {
+        int width, height, channels;
+
+        // 最后一个参数为 0：保持文件中的通道数，RGB 图像不在 stb 内部扩展
+        stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, 0);
+
+        if (!pixels)
+        {
+            throw std::runtime_error("Error: failed to read image data from " + path + " (" + stbi_failure_reason() + ")");
+        }
+
+        auto image       = std::make_shared<DecodedImage>();
+        image->mPixels   = pixels;
+        image->mWidth    = static_cast<uint32_t>(width);
+        image->mHeight   = static_cast<uint32_t>(height);
+        image->mChannels = static_cast<uint32_t>(channels);
+
+        return image;
+    }
+
+    DecodedImage::~DecodedImage()
+    {
+        if (mPixels != nullptr)
+        {
+            stbi_image_free(mPixels);
+        }
+    }
+
+    void DecodedImage::convertToRGBA8(uint8_t* dst, bool flipVertically) const
+    {
+        convertToRGBA8(mPixels, mChannels, mWidth, mHeight, dst, flipVertically);
+    }
+
+    const char* DecodedImage::getExpandKernelName()
+    {
+        return getExpandDispatch().mName;
+    }
+
+    void DecodedImage::expandRGBToRGBA8(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+    {
+        size_t i = getExpandDispatch().mKernel(src, dst, pixelCount);
+
+        for (; i < pixelCount; ++i)
+        {
+            dst[i * 4 + 0] = src[i * 3 + 0];
+            dst[i * 4 + 1] = src[i * 3 + 1];
+            dst[i * 4 + 2] = src[i * 3 + 2];
+            dst[i * 4 + 3] = 255;
+        }
+    }
+
+    void DecodedImage::convertToRGBA8(const uint8_t* src, uint32_t channels, uint32_t width, uint32_t height, uint8_t* dst, bool flipVertically)
+    {
+        size_t srcPitch = size_t(width) * channels;
+        size_t dstPitch = size_t(width) * 4;
+
+        // RGBA 且不翻转时整块拷贝，其余情况逐行处理（翻转只是改变目标行，不额外遍历）
+        if (channels == 4 && !flipVertically)
+        {
+            memcpy(dst, src, dstPitch * height);
+            return;
+        }
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const uint8_t* in  = src + srcPitch * y;
+            uint8_t*       out = dst + dstPitch * (flipVertically ? height - 1 - y : y);
+
+            switch (channels)
+            {
+            case 4:
+                memcpy(out, in, dstPitch);
+                break;
+            case 3:
+                expandRGBToRGBA8(in, out, width);
+                break;
+            case 2:
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    out[x * 4 + 0] = out[x * 4 + 1] = out[x * 4 + 2] = in[x * 2];
+                    out[x * 4 + 3] = in[x * 2 + 1];
+                }
+                break;
+            default:
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    out[x * 4 + 0] = out[x * 4 + 1] = out[x * 4 + 2] = in[x];
+                    out[x * 4 + 3] = 255;
+                }
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // 解码后的源图像（stb_image），保留文件中的通道数
+    // 解码不再要求 stb 输出 RGBA：它的通道扩展是逐像素的标量循环，并且会另外分配一块缓冲；
+    // 扩展与翻转改由 convertToRGBA8 的 SIMD 内核（运行时按 CPU 选择）完成，目标可以直接是映射的暂存内存。
+    // 解码本身只访问自己的数据，多张图像可以在线程池中并行解码
+    // ==================================================================
+    class DecodedImage
+    {
+    public:
+        using Ptr = std::shared_ptr<DecodedImage>;
+
+        /// 读取并解码文件，失败时抛出异常
+        static Ptr decode(const std::string& path);
+
+        DecodedImage() = default;
+
+        ~DecodedImage();
+
+        DecodedImage(const DecodedImage&) = delete;
+        DecodedImage& operator=(const DecodedImage&) = delete;
+
+        [[nodiscard]] auto getWidth()    const { return mWidth; }
+        [[nodiscard]] auto getHeight()   const { return mHeight; }
+        [[nodiscard]] auto getChannels() const { return mChannels; }
+        [[nodiscard]] auto getPixels()   const { return mPixels; }
+
+        /// 转换为 RGBA8 后的字节数
+        [[nodiscard]] size_t getRGBA8Size() const { return size_t(mWidth) * mHeight * 4; }
+
+        /// 转换为 RGBA8 写入 dst（getRGBA8Size() 字节）；flipVertically 时源图像第 0 行写到最后一行
+        void convertToRGBA8(uint8_t* dst, bool flipVertically = false) const;
+
+        /// 任意通道数（1 灰度 / 2 灰度 + alpha / 3 RGB / 4 RGBA）的像素转为 RGBA8
+        static void convertToRGBA8(const uint8_t* src, uint32_t channels, uint32_t width, uint32_t height, uint8_t* dst, bool flipVertically = false);
+
+        /// 一行 RGB 扩展为 RGBA（alpha 为 255）：AVX2 每次 8 个像素，SSSE3 每次 4 个，剩余的逐像素处理
+        static void expandRGBToRGBA8(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+
+        /// 当前 CPU 上 expandRGBToRGBA8 使用的内核："avx2" / "ssse3" / "scalar"
+        static const char* getExpandKernelName();
+
+    private:
+        uint8_t* mPixels{ nullptr };  // stb_image 分配，析构时释放
+        uint32_t mWidth{ 0 };
+        uint32_t mHeight{ 0 };
+        uint32_t mChannels{ 0 };
+    };
+}
@@ -0,0 +1,359 @@
+﻿#include "ktx2File.h"
+#include "blockCompression.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../stb_image.h"
+
+namespace LearnVulkan
+{
+    static constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    static constexpr uint32_t SUPERCOMPRESSION_NONE = 0;
+    static constexpr uint32_t SUPERCOMPRESSION_ZLIB = 3;
+
+    struct Ktx2Header
+    {
+        uint8_t  mIdentifier[12];
+        uint32_t mVkFormat;
+        uint32_t mTypeSize;
+        uint32_t mPixelWidth;
+        uint32_t mPixelHeight;
+        uint32_t mPixelDepth;
+        uint32_t mLayerCount;
+        uint32_t mFaceCount;
+        uint32_t mLevelCount;
+        uint32_t mSupercompressionScheme;
+        uint32_t mDfdByteOffset;
+        uint32_t mDfdByteLength;
+        uint32_t mKvdByteOffset;
+        uint32_t mKvdByteLength;
+        uint64_t mSgdByteOffset;
+        uint64_t mSgdByteLength;
+    };
+
+    struct Ktx2LevelIndex
+    {
+        uint64_t mByteOffset;
+        uint64_t mByteLength;
+        uint64_t mUncompressedByteLength;
+    };
+
+    static_assert(sizeof(Ktx2Header) == 80, "KTX2 header must be 80 bytes");
+    static_assert(sizeof(Ktx2LevelIndex) == 24, "KTX2 level index entry must be 24 bytes");
+
+    /// 读取支持的格式：块压缩格式与 RGBA8
+    static bool isSupportedFormat(VkFormat format)
+    {
+        return BlockCompression::isBlockCompressed(format) ||
+               format == VK_FORMAT_R8G8B8A8_UNORM ||
+               format == VK_FORMAT_R8G8B8A8_SRGB;
+    }
+
+    static bool isSrgbFormat(VkFormat format)
+    {
+        return format == VK_FORMAT_R8G8B8A8_SRGB ||
+               format == VK_FORMAT_BC1_RGB_SRGB_BLOCK ||
+               format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK ||
+               format == VK_FORMAT_BC3_SRGB_BLOCK ||
+               format == VK_FORMAT_BC7_SRGB_BLOCK;
+    }
+
+    static uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    /// 数据格式描述（Khronos Data Format 1.3 基本描述块），读取时以 vkFormat 为准不解析它
+    static std::vector<uint32_t> buildDataFormatDescriptor(VkFormat format)
+    {
+        struct Sample
+        {
+            uint32_t mBitOffset;
+            uint32_t mBitLength;
+            uint32_t mChannel;
+            uint32_t mUpper;
+        };
+
+        // 颜色模型：KHR_DF_MODEL_RGBSDA 为 1，BC1A ~ BC7 为 128 ~ 134
+        uint32_t            colorModel = 1;
+        uint32_t            blockBytes = BlockCompression::getBlockBytes(format);
+        std::vector<Sample> samples{};
+
+        switch (format)
+        {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            colorModel = 128;
+            samples    = { { 0, 64, 0, 0xFFFFFFFF } };
+            break;
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            colorModel = 128;
+            samples    = { { 0, 64, 1, 0xFFFFFFFF } };
+            break;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            colorModel = 130;
+            samples    = { { 0, 64, 15, 0xFFFFFFFF }, { 64, 64, 0, 0xFFFFFFFF } };
+            break;
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            colorModel = 131;
+            samples    = { { 0, 64, 0, 0xFFFFFFFF } };
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            colorModel = 132;
+            samples    = { { 0, 64, 0, 0xFFFFFFFF }, { 64, 64, 1, 0xFFFFFFFF } };
+            break;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            colorModel = 134;
+            samples    = { { 0, 128, 0, 0xFFFFFFFF } };
+            break;
+        default:
+            blockBytes = 4;
+            samples    = { { 0, 8, 0, 255 }, { 8, 8, 1, 255 }, { 16, 8, 2, 255 }, { 24, 8, 15, 255 } };
+            break;
+        }
+
+        bool     srgb      = isSrgbFormat(format);
+        uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+        uint32_t blockDim  = colorModel == 1 ? 0 : 3;  // 维度减一：BCn 为 4x4
+
+        std::vector<uint32_t> words{};
+        words.push_back(4 + blockSize);                                    // dfdTotalSize
+        words.push_back(0);                                                // vendorId = KHRONOS, descriptorType = BASICFORMAT
+        words.push_back(2 | (blockSize << 16));                            // versionNumber = 1.3
+        words.push_back(colorModel | (1u << 8) | ((srgb ? 2u : 1u) << 16));  // 原色 BT709，传输函数 sRGB / 线性，非预乘
+        words.push_back(blockDim | (blockDim << 8));
+        words.push_back(blockBytes);                                       // bytesPlane0
+        words.push_back(0);
+
+        for (const auto& sample : samples)
+        {
+            // sRGB 格式的 alpha 通道仍是线性的
+            uint32_t channel = sample.mChannel | (srgb && sample.mChannel == 15 ? 0x10u : 0u);
+
+            words.push_back(sample.mBitOffset | ((sample.mBitLength - 1) << 16) | (channel << 24));
+            words.push_back(0);  // samplePosition
+            words.push_back(0);  // sampleLower
+            words.push_back(sample.mUpper);
+        }
+
+        return words;
+    }
+
+    Ktx2File::Ptr Ktx2File::load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to open " + path);
+        }
+
+        uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+        file.seekg(0);
+
+        Ktx2Header header{};
+        if (fileSize < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            memcmp(header.mIdentifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+        {
+            throw std::runtime_error("Error: " + path + " is not a KTX2 file!");
+        }
+
+        auto ktx = std::make_shared<Ktx2File>();
+        ktx->mPath             = path;
+        ktx->mFormat           = static_cast<VkFormat>(header.mVkFormat);
+        ktx->mWidth            = header.mPixelWidth;
+        ktx->mHeight           = std::max(1u, header.mPixelHeight);
+        ktx->mDepth            = std::max(1u, header.mPixelDepth);
+        ktx->mLayerCount       = std::max(1u, header.mLayerCount);
+        ktx->mFaceCount        = header.mFaceCount;
+        ktx->mSupercompression = header.mSupercompressionScheme;
+
+        if (!isSupportedFormat(ktx->mFormat))
+        {
+            throw std::runtime_error("Error: unsupported vkFormat " + std::to_string(header.mVkFormat) + " in " + path);
+        }
+
+        if (header.mSupercompressionScheme != SUPERCOMPRESSION_NONE && header.mSupercompressionScheme != SUPERCOMPRESSION_ZLIB)
+        {
+            throw std::runtime_error("Error: unsupported supercompression scheme " + std::to_string(header.mSupercompressionScheme) + " in " + path);
+        }
+
+        if (header.mPixelWidth == 0 || ktx->mDepth > 1 || (header.mFaceCount != 1 && header.mFaceCount != 6))
+        {
+            throw std::runtime_error("Error: " + path + " is not a 2D, array or cubemap texture!");
+        }
+
+        // levelCount 为 0 表示要求加载方自己生成 mip 链，这里只有第 0 级
+        uint32_t levelCount = std::max(1u, header.mLevelCount);
+
+        std::vector<Ktx2LevelIndex> index(levelCount);
+        if (!file.read(reinterpret_cast<char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(Ktx2LevelIndex))))
+        {
+            throw std::runtime_error("Error: " + path + " is truncated!");
+        }
+
+        for (uint32_t level = 0; level < levelCount; ++level)
+        {
+            uint32_t     width    = std::max(1u, ktx->mWidth >> level);
+            uint32_t     height   = std::max(1u, ktx->mHeight >> level);
+            VkDeviceSize expected = BlockCompression::getLevelSize(ktx->mFormat, width, height) * ktx->getArrayLayers();
+
+            // 未超压缩时 uncompressedByteLength 与 byteLength 相同
+            const auto& entry = index[level];
+            if (entry.mByteOffset + entry.mByteLength > fileSize || entry.mUncompressedByteLength != expected ||
+                (header.mSupercompressionScheme == SUPERCOMPRESSION_NONE && entry.mByteLength != expected))
+            {
+                throw std::runtime_error("Error: invalid level index in " + path);
+            }
+
+            ktx->mLevels.push_back({ entry.mByteOffset, entry.mByteLength, entry.mUncompressedByteLength });
+        }
+
+        return ktx;
+    }
+
+    Ktx2File::Ptr Ktx2File::fromLevels(VkFormat format, uint32_t width, uint32_t height, std::vector<std::vector<uint8_t>> levels)
+    {
+        auto ktx     = std::make_shared<Ktx2File>();
+        ktx->mFormat = format;
+        ktx->mWidth  = width;
+        ktx->mHeight = height;
+
+        for (const auto& level : levels)
+        {
+            Level entry{};
+            entry.mLength             = level.size();
+            entry.mUncompressedLength = level.size();
+            ktx->mLevels.push_back(entry);
+        }
+
+        ktx->mMemoryLevels = std::move(levels);
+
+        return ktx;
+    }
+
+    VkBufferImageCopy Ktx2File::readLevel(uint32_t level, std::vector<uint8_t>& data) const
+    {
+        const Level& entry = mLevels[level];
+
+        if (!mMemoryLevels.empty())
+        {
+            data = mMemoryLevels[level];
+        }
+        else
+        {
+            readFileLevel(level, entry, data);
+        }
+
+        // 各层与各面在一级内紧密排列，与 Vulkan 数组层的顺序一致，一个区域即可覆盖
+        VkBufferImageCopy region{};
+        region.bufferOffset                    = 0;
+        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel       = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount     = getArrayLayers();
+        region.imageExtent                     = { std::max(1u, mWidth >> level), std::max(1u, mHeight >> level), 1 };
+
+        return region;
+    }
+
+    void Ktx2File::readFileLevel(uint32_t level, const Level& entry, std::vector<uint8_t>& data) const
+    {
+        std::ifstream file(mPath, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to open " + mPath);
+        }
+
+        std::vector<uint8_t> bytes(static_cast<size_t>(entry.mLength));
+        file.seekg(static_cast<std::streamoff>(entry.mOffset));
+        if (!file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+        {
+            throw std::runtime_error("Error: " + mPath + " is truncated!");
+        }
+
+        if (mSupercompression == SUPERCOMPRESSION_ZLIB)
+        {
+            data.resize(static_cast<size_t>(entry.mUncompressedLength));
+
+            int length = stbi_zlib_decode_buffer(reinterpret_cast<char*>(data.data()),
+                                                 static_cast<int>(data.size()),
+                                                 reinterpret_cast<const char*>(bytes.data()),
+                                                 static_cast<int>(bytes.size()));
+
+            if (length != static_cast<int>(data.size()))
+            {
+                throw std::runtime_error("Error: failed to inflate level " + std::to_string(level) + " of " + mPath);
+            }
+        }
+        else
+        {
+            data = std::move(bytes);
+        }
+    }
+
+    void Ktx2File::write(const std::string& path, VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels)
+    {
+        if (!isSupportedFormat(format) || levels.empty())
+        {
+            throw std::runtime_error("Error: cannot write " + path + " in the requested format!");
+        }
+
+        std::vector<uint32_t> dfd = buildDataFormatDescriptor(format);
+
+        Ktx2Header header{};
+        memcpy(header.mIdentifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+        header.mVkFormat      = static_cast<uint32_t>(format);
+        header.mTypeSize      = 1;
+        header.mPixelWidth    = width;
+        header.mPixelHeight   = height;
+        header.mFaceCount     = 1;
+        header.mLevelCount    = static_cast<uint32_t>(levels.size());
+        header.mDfdByteOffset = static_cast<uint32_t>(sizeof(Ktx2Header) + levels.size() * sizeof(Ktx2LevelIndex));
+        header.mDfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+        // 各级按从小到大的顺序存放，起始位置对齐到 lcm(纹素块大小, 4)
+        uint64_t alignment = BlockCompression::isBlockCompressed(format) ? BlockCompression::getBlockBytes(format) : 4;
+
+        std::vector<Ktx2LevelIndex> index(levels.size());
+        uint64_t                    offset = header.mDfdByteOffset + header.mDfdByteLength;
+        for (size_t level = levels.size(); level-- > 0;)
+        {
+            offset = alignUp(offset, alignment);
+
+            index[level].mByteOffset             = offset;
+            index[level].mByteLength             = levels[level].size();
+            index[level].mUncompressedByteLength = levels[level].size();
+
+            offset += levels[level].size();
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to create " + path);
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(Ktx2LevelIndex)));
+        file.write(reinterpret_cast<const char*>(dfd.data()), static_cast<std::streamsize>(dfd.size() * sizeof(uint32_t)));
+
+        static const char padding[16]{};
+
+        for (size_t level = levels.size(); level-- > 0;)
+        {
+            uint64_t position = static_cast<uint64_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(index[level].mByteOffset - position));
+            file.write(reinterpret_cast<const char*>(levels[level].data()), static_cast<std::streamsize>(levels[level].size()));
+        }
+
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to write " + path);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include "../vulkanWrapper/base.h"
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // KTX2 容器读取（2D 纹理、数组纹理与立方体贴图）
+    // 文件中各级数据从最小一级开始存放，级别索引按第 0 级在前给出；
+    // 头与索引在 load 时读入，各级数据由 readLevel 按需读取，流式加载可以先上传尾部的小级别。
+    // 超压缩只支持 ZLIB（用 stb_image 自带的 inflate 解压），Zstandard / BasisLZ 需要外部库，
+    // 与 vkFormat 为 UNDEFINED 的通用压缩格式一样会抛出异常
+    // ==================================================================
+    class Ktx2File
+    {
+    public:
+        using Ptr = std::shared_ptr<Ktx2File>;
+
+        /// 只读取头与级别索引；文件不存在、格式或超压缩方式不受支持、索引越界时抛出异常
+        static Ptr load(const std::string& path);
+
+        /// 写出单个 2D 图像与 mip 链（不做超压缩），levels[i] 为第 i 级的完整数据
+        static void write(const std::string& path, VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels);
+
+        /// 不对应文件、各级数据保存在内存中的 2D 图像（levels[i] 为第 i 级），readLevel 返回其副本；
+        /// 由源图像创建的纹理用它保留 mip 链，常驻管理降级 / 恢复时与 .ktx2 一样按级别重新上传
+        static Ptr fromLevels(VkFormat format, uint32_t width, uint32_t height, std::vector<std::vector<uint8_t>> levels);
+
+        Ktx2File() = default;
+
+        [[nodiscard]] auto getFormat()     const { return mFormat; }
+        [[nodiscard]] auto getWidth()      const { return mWidth; }
+        [[nodiscard]] auto getHeight()     const { return mHeight; }
+        [[nodiscard]] auto getDepth()      const { return mDepth; }
+        [[nodiscard]] auto getLayerCount() const { return mLayerCount; }
+        [[nodiscard]] auto getFaceCount()  const { return mFaceCount; }
+        [[nodiscard]] auto getMipLevels()  const { return static_cast<uint32_t>(mLevels.size()); }
+
+        [[nodiscard]] bool isCubemap() const { return mFaceCount == 6; }
+
+        /// Vulkan 图像的数组层数：层数 x 面数（立方体数组的第 i 层第 f 面为 i * 6 + f）
+        [[nodiscard]] uint32_t getArrayLayers() const { return mLayerCount * mFaceCount; }
+
+        /// 第 level 级解压后的字节数（所有层与面）
+        [[nodiscard]] VkDeviceSize getLevelSize(uint32_t level) const { return mLevels[level].mUncompressedLength; }
+
+        /// 读取并按需解压第 level 级，返回覆盖该级所有层与面的拷贝区域（bufferOffset 为 0）
+        VkBufferImageCopy readLevel(uint32_t level, std::vector<uint8_t>& data) const;
+
+    private:
+        struct Level
+        {
+            uint64_t mOffset{ 0 };
+            uint64_t mLength{ 0 };
+            uint64_t mUncompressedLength{ 0 };
+        };
+
+        /// 从文件读取第 level 级并按需解压
+        void readFileLevel(uint32_t level, const Level& entry, std::vector<uint8_t>& data) const;
+
+        std::string        mPath{};
+        VkFormat           mFormat{ VK_FORMAT_UNDEFINED };
+        uint32_t           mWidth{ 0 };
+        uint32_t           mHeight{ 0 };
+        uint32_t           mDepth{ 1 };
+        uint32_t           mLayerCount{ 1 };
+        uint32_t           mFaceCount{ 1 };
+        uint32_t           mSupercompression{ 0 };
+        std::vector<Level> mLevels{};
+
+        std::vector<std::vector<uint8_t>> mMemoryLevels{};  // fromLevels 创建时的各级数据，为空时从 mPath 读取
+    };
+}
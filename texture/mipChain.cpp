@@ -0,0 +1,105 @@
+﻿#include "mipChain.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BONA_MIP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace LearnVulkan
+{
+    void MipChain::downsampleRGBA8(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst)
+    {
+        uint32_t dstWidth  = std::max(1u, srcWidth / 2);
+        uint32_t dstHeight = std::max(1u, srcHeight / 2);
+
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+            const uint8_t* row0 = src + size_t(std::min(y * 2, srcHeight - 1)) * srcWidth * 4;
+            const uint8_t* row1 = src + size_t(std::min(y * 2 + 1, srcHeight - 1)) * srcWidth * 4;
+            uint8_t*       out  = dst + size_t(y) * dstWidth * 4;
+
+            uint32_t x = 0;
+
+#ifdef BONA_MIP_SSE2
+            // 每次读两行各 4 个像素，输出 2 个像素：通道扩展到 16 位后竖直相加，再把相邻像素横向相加
+            const __m128i zero  = _mm_setzero_si128();
+            const __m128i round = _mm_set1_epi16(2);
+
+            for (; x + 2 <= dstWidth && x * 2 + 4 <= srcWidth; x += 2)
+            {
+                __m128i top    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+                __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+                __m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+                __m128i sum23 = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+                __m128i pixel0 = _mm_add_epi16(sum01, _mm_srli_si128(sum01, 8));
+                __m128i pixel1 = _mm_add_epi16(sum23, _mm_srli_si128(sum23, 8));
+
+                __m128i result = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(pixel0, pixel1), round), 2);
+
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(result, result));
+            }
+#endif
+
+            for (; x < dstWidth; ++x)
+            {
+                uint32_t x0 = std::min(x * 2, srcWidth - 1) * 4;
+                uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1) * 4;
+
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    uint32_t sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                    out[x * 4 + c] = static_cast<uint8_t>((sum + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> MipChain::buildRGBA8(const uint8_t* pixels,
+                                              uint32_t width,
+                                              uint32_t height,
+                                              uint32_t levelCount,
+                                              std::vector<VkBufferImageCopy>& regions)
+    {
+        regions.clear();
+        regions.reserve(levelCount);
+
+        // 先排布所有级别，一次分配
+        VkDeviceSize totalSize = 0;
+        for (uint32_t level = 0, w = width, h = height; level < levelCount; ++level)
+        {
+            VkBufferImageCopy region{};
+            region.bufferOffset                    = totalSize;
+            region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel       = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount     = 1;
+            region.imageExtent                     = { w, h, 1 };
+            regions.push_back(region);
+
+            totalSize += (VkDeviceSize(w) * h * 4 + 15) & ~VkDeviceSize(15);
+
+            w = std::max(1u, w / 2);
+            h = std::max(1u, h / 2);
+        }
+
+        std::vector<uint8_t> data(static_cast<size_t>(totalSize));
+        memcpy(data.data(), pixels, size_t(width) * height * 4);
+
+        for (uint32_t level = 1; level < levelCount; ++level)
+        {
+            const auto& previous = regions[level - 1];
+
+            downsampleRGBA8(data.data() + previous.bufferOffset,
+                            previous.imageExtent.width,
+                            previous.imageExtent.height,
+                            data.data() + regions[level].bufferOffset);
+        }
+
+        return data;
+    }
+}
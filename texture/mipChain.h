@@ -0,0 +1,26 @@
+﻿#pragma once
+
+#include "../vulkanWrapper/base.h"
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // CPU 端 mip 链生成（格式不支持线性 blit 时的回退路径）
+    // 每级对上一级做 2x2 盒式滤波，奇数边的最后一列 / 行与自身平均；
+    // 在 sRGB 编码值上直接平均，比 GPU blit（先转线性再过滤）略暗，但无需逐像素查表
+    // ==================================================================
+    class MipChain
+    {
+    public:
+        /// RGBA8 缩小一级，dst 大小为 max(1, srcWidth / 2) x max(1, srcHeight / 2)
+        static void downsampleRGBA8(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst);
+
+        /// 生成 levelCount 级 RGBA8 mip 链，各级按 16 字节对齐依次排放；
+        /// regions 给出每级的拷贝区域（bufferOffset 相对返回的数据），可直接交给一次 copyBufferToImage
+        static std::vector<uint8_t> buildRGBA8(const uint8_t* pixels,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               uint32_t levelCount,
+                                               std::vector<VkBufferImageCopy>& regions);
+    };
+}
@@ -1,94 +1,658 @@
 ﻿#include "texture.h"
+#include "mipChain.h"
+#include "blockCompression.h"
+#include "ddsFile.h"
+#include "ktx2File.h"
+#include "decodedImage.h"
+#include "../vulkanWrapper/cpuProfiler.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "../stb_image.h"
+#include <algorithm>
+#include <filesystem>
 
 namespace LearnVulkan
 {
-    Texture::Texture(const Wrapper::Device::Ptr& device, const Wrapper::CommandPool::Ptr& commandPool, const std::string& imageFilePath)
+    /// 采样纹理需要的格式特性
+    static constexpr VkFormatFeatureFlags SAMPLED_FEATURES = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                                                             VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+    VkFormat Texture::getUncompressedFormat(Usage usage)
+    {
+        return usage == Usage::Color ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
+
+    VkFormat Texture::getCompressedFormat(Usage usage)
+    {
+        switch (usage)
+        {
+        case Usage::Normal: return VK_FORMAT_BC5_UNORM_BLOCK;
+        case Usage::Data:   return VK_FORMAT_BC7_UNORM_BLOCK;
+        default:            return VK_FORMAT_BC7_SRGB_BLOCK;
+        }
+    }
+
+    Texture::Texture(const Wrapper::Device::Ptr& device,
+                     const Wrapper::UploadEngine::Ptr& uploadEngine,
+                     ThreadPool& threadPool,
+                     const std::string& imageFilePath,
+                     MipMode mipMode,
+                     Usage usage,
+                     bool compressOnLoad,
+                     VkDeviceSize streamBudget,
+                     bool evictable)
+    {
+        CPU_PROFILE_ZONE("Texture::load");
+
+        mDevice = device;
+
+        // -------------------- 步骤1：优先使用预压缩的 KTX2 / DDS --------------------
+        // 显式给出 .ktx2 / .dds，或源图像旁边有离线转换好的同名文件（见 tools/textureConvert.cpp）；
+        // 两者都存在时使用 KTX2，只有它支持数组、立方体贴图与流式加载
+        std::filesystem::path sourcePath(imageFilePath);
+        bool                  isKtx2   = sourcePath.extension() == ".ktx2";
+        bool                  isDds    = sourcePath.extension() == ".dds";
+        std::string           ktx2Path = isKtx2 ? imageFilePath : std::filesystem::path(sourcePath).replace_extension(".ktx2").string();
+        std::string           ddsPath  = isDds ? imageFilePath : std::filesystem::path(sourcePath).replace_extension(".dds").string();
+
+        if (!isDds && (isKtx2 || std::filesystem::exists(ktx2Path)))
+        {
+            auto ktx = Ktx2File::load(ktx2Path);
+
+            if (Wrapper::Image::isFormatSupported(mDevice, ktx->getFormat(), VK_IMAGE_TILING_OPTIMAL, SAMPLED_FEATURES))
+            {
+                createFromKtx2(ktx, streamBudget, uploadEngine);
+            }
+            else if (isKtx2)
+            {
+                throw std::runtime_error("Error: " + imageFilePath + " uses a format this device cannot sample!");
+            }
+        }
+
+        if (mImage == nullptr && !isKtx2 && (isDds || std::filesystem::exists(ddsPath)))
+        {
+            auto dds = DdsFile::load(ddsPath);
+
+            if (Wrapper::Image::isFormatSupported(mDevice, dds->getFormat(), VK_IMAGE_TILING_OPTIMAL, SAMPLED_FEATURES))
+            {
+                createFromLevels(dds->getData(), dds->getRegions(), dds->getFormat(), dds->getWidth(), dds->getHeight(), uploadEngine);
+            }
+            else if (isDds)
+            {
+                // 设备不支持该块压缩格式且没有源图像：CPU 解码第 0 级，再按未压缩纹理处理
+                std::vector<uint8_t> pixels(size_t(dds->getWidth()) * dds->getHeight() * 4);
+                if (!BlockCompression::decode(dds->getData().data(), dds->getWidth(), dds->getHeight(), dds->getFormat(), pixels.data()))
+                {
+                    throw std::runtime_error("Error: " + imageFilePath + " uses a format this device cannot sample or the CPU cannot decode!");
+                }
+
+                VkFormat format = dds->getFormat() == VK_FORMAT_BC1_RGB_SRGB_BLOCK ||
+                                  dds->getFormat() == VK_FORMAT_BC1_RGBA_SRGB_BLOCK ||
+                                  dds->getFormat() == VK_FORMAT_BC3_SRGB_BLOCK ||
+                                  dds->getFormat() == VK_FORMAT_BC7_SRGB_BLOCK ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+
+                createFromPixels(pixels.data(), 4, dds->getWidth(), dds->getHeight(), format, VK_FORMAT_UNDEFINED, mipMode, {}, uploadEngine, threadPool);
+            }
+        }
+
+        // -------------------- 步骤2：加载源图像文件数据（CPU 内存） --------------------
+        if (mImage == nullptr)
+        {
+            // 保持文件中的通道数解码，RGB 到 RGBA 的扩展在写入暂存内存时完成
+            auto image = DecodedImage::decode(imageFilePath);
+
+            createFromImage(*image, mipMode, usage, compressOnLoad, evictable ? imageFilePath : std::string{}, uploadEngine, threadPool);
+        }
+
+        createSampler();
+    }
+
+    Texture::Texture(const Wrapper::Device::Ptr& device,
+                     const Wrapper::UploadEngine::Ptr& uploadEngine,
+                     ThreadPool& threadPool,
+                     const DecodedImage& image,
+                     MipMode mipMode,
+                     Usage usage,
+                     bool compressOnLoad,
+                     const std::string& sourcePath)
     {
+        CPU_PROFILE_ZONE("Texture::upload");
+
         mDevice = device;
 
-        // -------------------- 步骤1：加载图像文件数据（CPU 内存） --------------------
-        int texWidth, texHeight, texSize, texChannles;
+        createFromImage(image, mipMode, usage, compressOnLoad, sourcePath, uploadEngine, threadPool);
+
+        createSampler();
+    }
+
+    Texture::~Texture() {}
+
+    std::vector<Texture::Ptr> Texture::loadAll(const Wrapper::Device::Ptr& device,
+                                               const Wrapper::UploadEngine::Ptr& uploadEngine,
+                                               const std::vector<std::pair<std::string, Usage>>& files,
+                                               ThreadPool& threadPool,
+                                               MipMode mipMode,
+                                               bool compressOnLoad,
+                                               VkDeviceSize streamBudget,
+                                               bool evictable)
+    {
+        CPU_PROFILE_ZONE("Texture::loadAll");
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        // 有预压缩文件的纹理不需要解码，交给按路径创建的流程（格式不受支持时它自己回退到源图像）
+        auto hasPrecompressed = [](const std::string& path)
+        {
+            std::filesystem::path sourcePath(path);
+            return sourcePath.extension() == ".ktx2" || sourcePath.extension() == ".dds" ||
+                   std::filesystem::exists(std::filesystem::path(sourcePath).replace_extension(".ktx2")) ||
+                   std::filesystem::exists(std::filesystem::path(sourcePath).replace_extension(".dds"));
+        };
+
+        // 解码在线程池中并行，各自只写自己的结果；上传引擎不是线程安全的，创建与上传留在调用线程
+        std::vector<DecodedImage::Ptr> images(files.size());
+        threadPool.parallelFor(files.size(), [&](size_t index)
+        {
+            if (!hasPrecompressed(files[index].first))
+            {
+                CPU_PROFILE_ZONE("DecodedImage::decode");
+                images[index] = DecodedImage::decode(files[index].first);
+            }
+        });
+
+        std::vector<Ptr> textures{};
+        textures.reserve(files.size());
+
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            if (images[i] != nullptr)
+            {
+                textures.push_back(create(device, uploadEngine, threadPool, *images[i], mipMode, files[i].second, compressOnLoad, evictable ? files[i].first : std::string{}));
+                images[i].reset();
+            }
+            else
+            {
+                textures.push_back(create(device, uploadEngine, threadPool, files[i].first, mipMode, files[i].second, compressOnLoad, streamBudget, evictable));
+            }
+        }
+
+        auto loadTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        std::cout << "Textures: " << files.size() << " loaded in " << loadTime << " ms on " << threadPool.getThreadCount() + 1 << " threads" << std::endl;
+
+        return textures;
+    }
+
+    void Texture::createSampler()
+    {
+        mSampler = Wrapper::Sampler::create(mDevice, mImage->getMipLevels());
+
+        mImageInfo.imageLayout = mImage->getLayout();
+        mImageInfo.imageView   = mImage->getImageView(mResidentLevel - mAllocatedLevel);
+        mImageInfo.sampler     = mSampler->getSampler();
+    }
+
+    void Texture::createFromImage(const DecodedImage& image, MipMode mipMode, Usage usage, bool compressOnLoad, const std::string& sourcePath, const Wrapper::UploadEngine::Ptr& uploadEngine, ThreadPool& threadPool)
+    {
+        // 设备不支持 BCn（例如只有 ASTC / ETC2 的移动 GPU）时保持未压缩
+        VkFormat compressedFormat = VK_FORMAT_UNDEFINED;
+        if (compressOnLoad && Wrapper::Image::isFormatSupported(mDevice, getCompressedFormat(usage), VK_IMAGE_TILING_OPTIMAL, SAMPLED_FEATURES))
+        {
+            compressedFormat = getCompressedFormat(usage);
+        }
+
+        createFromPixels(image.getPixels(),
+                         image.getChannels(),
+                         image.getWidth(),
+                         image.getHeight(),
+                         getUncompressedFormat(usage),
+                         compressedFormat,
+                         mipMode,
+                         sourcePath,
+                         uploadEngine,
+                         threadPool);
+    }
+
+    void Texture::createFromKtx2(const Ktx2File::Ptr& ktx, VkDeviceSize streamBudget, const Wrapper::UploadEngine::Ptr& uploadEngine)
+    {
+        uint32_t levelCount = ktx->getMipLevels();
+
+        // 保留来源，常驻管理降级后可以按级别重新读取
+        mStreamSource = ktx;
+
+        mImage = Wrapper::Image::create(mDevice,
+                                        ktx->getWidth(),
+                                        ktx->getHeight(),
+                                        ktx->getFormat(),
+                                        VK_IMAGE_TYPE_2D,
+                                        VK_IMAGE_TILING_OPTIMAL,
+                                        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                        VK_SAMPLE_COUNT_1_BIT,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                        VK_IMAGE_ASPECT_COLOR_BIT,
+                                        levelCount,
+                                        ktx->getArrayLayers(),
+                                        ktx->isCubemap() ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0);
+
+        if (streamBudget == 0 || levelCount == 1)
+        {
+            // 不流式加载：各级拼成一块暂存数据，一次多区域拷贝
+            std::vector<uint8_t>           data{};
+            std::vector<VkBufferImageCopy> regions{};
+
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                std::vector<uint8_t> levelData{};
+                VkBufferImageCopy    region = ktx->readLevel(level, levelData);
+
+                region.bufferOffset = data.size();
+                data.insert(data.end(), levelData.begin(), levelData.end());
+                regions.push_back(region);
+            }
+
+            mImage->fillImageData(data.size(),
+                                  data.data(),
+                                  regions,
+                                  uploadEngine,
+                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+            return;
+        }
+
+        // 流式加载：先上传预算内最小的几级，第一帧即可采样低分辨率的结果
+        mResidentLevel = levelCount;
+
+        streamLevels(uploadEngine, streamBudget);
+    }
+
+    VkDeviceSize Texture::streamLevels(const Wrapper::UploadEngine::Ptr& uploadEngine, VkDeviceSize budget)
+    {
+        if (mStreamSource == nullptr || !hasPendingLevels())
+        {
+            return 0;
+        }
+
+        CPU_PROFILE_ZONE("Texture::streamLevels");
+
+        VkDeviceSize uploaded = 0;
+
+        while (mResidentLevel > mAllocatedLevel)
+        {
+            uint32_t     level = mResidentLevel - 1;
+            VkDeviceSize size  = mStreamSource->getLevelSize(level);
+
+            // 单独一级超过预算时也要上传，否则永远无法常驻
+            if (uploaded > 0 && uploaded + size > budget)
+            {
+                break;
+            }
+
+            std::vector<uint8_t> data{};
+            VkBufferImageCopy    region = mStreamSource->readLevel(level, data);
+
+            region.imageSubresource.mipLevel = level - mAllocatedLevel;
+
+            // 渲染提交在片元着色器阶段等待上传；在这之前提交的帧仍使用旧视图，不会读到这一级
+            mImage->fillMipLevel(data.size(),
+                                 data.data(),
+                                 region,
+                                 uploadEngine,
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+            uploaded      += size;
+            mResidentLevel = level;
+        }
+
+        mImageInfo.imageView = mImage->getImageView(mResidentLevel - mAllocatedLevel);
+        return uploaded;
+    }
+
+    VkDeviceSize Texture::estimateMemorySize(uint32_t baseLevel) const
+    {
+        VkDeviceSize size = 0;
+
+        if (!mSourcePath.empty())
+        {
+            for (uint32_t level = baseLevel; level < getLevelCount(); ++level)
+            {
+                size += VkDeviceSize(std::max(1u, mSourceWidth >> level)) * std::max(1u, mSourceHeight >> level) * 4;
+            }
+            return size;
+        }
+
+        if (mStreamSource == nullptr)
+        {
+            return getMemorySize();
+        }
+
+        for (uint32_t level = baseLevel; level < mStreamSource->getMipLevels(); ++level)
+        {
+            size += mStreamSource->getLevelSize(level);
+        }
+        return size;
+    }
+
+    Wrapper::Image::Ptr Texture::reallocate(uint32_t baseLevel, const Wrapper::UploadEngine::Ptr& uploadEngine)
+    {
+        if (!isEvictable() || baseLevel == mAllocatedLevel)
+        {
+            return nullptr;
+        }
+
+        if (mStreamSource == nullptr)
+        {
+            return reallocateFromSource(baseLevel, uploadEngine);
+        }
+
+        CPU_PROFILE_ZONE("Texture::reallocate");
+
+        uint32_t levelCount = mStreamSource->getMipLevels();
+        baseLevel = std::min(baseLevel, levelCount - 1);
+
+        auto image = Wrapper::Image::create(mDevice,
+                                            std::max(1u, mStreamSource->getWidth() >> baseLevel),
+                                            std::max(1u, mStreamSource->getHeight() >> baseLevel),
+                                            mStreamSource->getFormat(),
+                                            VK_IMAGE_TYPE_2D,
+                                            VK_IMAGE_TILING_OPTIMAL,
+                                            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                            VK_SAMPLE_COUNT_1_BIT,
+                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                            VK_IMAGE_ASPECT_COLOR_BIT,
+                                            levelCount - baseLevel,
+                                            mStreamSource->getArrayLayers(),
+                                            mStreamSource->isCubemap() ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0);
+
+        // 降级时从新的第一级开始全部上传；扩大时先恢复原来已常驻的级别，保证新图像立即可以采样
+        uint32_t keepLevel = std::max(baseLevel, mResidentLevel);
+
+        std::vector<uint8_t>           data{};
+        std::vector<VkBufferImageCopy> regions{};
+
+        for (uint32_t level = keepLevel; level < levelCount; ++level)
+        {
+            std::vector<uint8_t> levelData{};
+            VkBufferImageCopy    region = mStreamSource->readLevel(level, levelData);
+
+            region.bufferOffset              = data.size();
+            region.imageSubresource.mipLevel = level - baseLevel;
+            data.insert(data.end(), levelData.begin(), levelData.end());
+            regions.push_back(region);
+        }
+
+        // 还没上传的更精细级别同样转换到着色器只读布局，视图不包含它们，之后 fillMipLevel 会丢弃其内容再写入
+        image->fillImageData(data.size(),
+                             data.data(),
+                             regions,
+                             uploadEngine,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        auto previous = mImage;
+
+        mImage          = image;
+        mAllocatedLevel = baseLevel;
+        mResidentLevel  = keepLevel;
+
+        mImageInfo.imageView = mImage->getImageView(mResidentLevel - mAllocatedLevel);
+        return previous;
+    }
+
+    Wrapper::Image::Ptr Texture::reallocateFromSource(uint32_t baseLevel, const Wrapper::UploadEngine::Ptr& uploadEngine)
+    {
+        CPU_PROFILE_ZONE("Texture::reallocateFromSource");
+
+        uint32_t levelCount = getLevelCount();
+        baseLevel = std::min(baseLevel, levelCount - 1);
+
+        auto source = DecodedImage::decode(mSourcePath);
+
+        std::vector<uint8_t> rgba{};
+        const uint8_t*       pixels = source->getPixels();
+        if (source->getChannels() != 4)
+        {
+            rgba.resize(source->getRGBA8Size());
+            source->convertToRGBA8(rgba.data());
+            pixels = rgba.data();
+        }
+
+        // 与 CPU 生成 mip 的路径相同的盒式滤波；GPU 生成 mip 时只需要缩小到新的第一级
+        std::vector<VkBufferImageCopy> regions{};
+        std::vector<uint8_t> mipData = MipChain::buildRGBA8(pixels, mSourceWidth, mSourceHeight, mGpuMips ? baseLevel + 1 : levelCount, regions);
+
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (mGpuMips)
+        {
+            usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+
+        auto image = Wrapper::Image::create(mDevice,
+                                            std::max(1u, mSourceWidth >> baseLevel),
+                                            std::max(1u, mSourceHeight >> baseLevel),
+                                            mImage->getFormat(),
+                                            VK_IMAGE_TYPE_2D,
+                                            VK_IMAGE_TILING_OPTIMAL,
+                                            usage,
+                                            VK_SAMPLE_COUNT_1_BIT,
+                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                            VK_IMAGE_ASPECT_COLOR_BIT,
+                                            levelCount - baseLevel);
+
+        // 比新的第一级更精细的数据不上传，偏移与级别编号都相对它
+        size_t   baseOffset = static_cast<size_t>(regions[baseLevel].bufferOffset);
+        uint8_t* baseData   = mipData.data() + baseOffset;
+
+        if (mGpuMips)
+        {
+            image->fillImageDataAndGenerateMips(size_t(regions[baseLevel].imageExtent.width) * regions[baseLevel].imageExtent.height * 4,
+                                                baseData,
+                                                uploadEngine,
+                                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+        else
+        {
+            std::vector<VkBufferImageCopy> levelRegions(regions.begin() + baseLevel, regions.end());
+            for (auto& region : levelRegions)
+            {
+                region.bufferOffset              -= baseOffset;
+                region.imageSubresource.mipLevel -= baseLevel;
+            }
+
+            image->fillImageData(mipData.size() - baseOffset,
+                                 baseData,
+                                 levelRegions,
+                                 uploadEngine,
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+
+        auto previous = mImage;
+
+        mImage          = image;
+        mAllocatedLevel = baseLevel;
+        mResidentLevel  = baseLevel;
+
+        mImageInfo.imageView = mImage->getImageView(0);
+        return previous;
+    }
+
+    void Texture::createFromLevels(const std::vector<uint8_t>& data,
+                                   const std::vector<VkBufferImageCopy>& regions,
+                                   VkFormat format,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   const Wrapper::UploadEngine::Ptr& uploadEngine)
+    {
+        mImage = Wrapper::Image::create(mDevice,
+                                        width,
+                                        height,
+                                        format,
+                                        VK_IMAGE_TYPE_2D,
+                                        VK_IMAGE_TILING_OPTIMAL,
+                                        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                        VK_SAMPLE_COUNT_1_BIT,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                        VK_IMAGE_ASPECT_COLOR_BIT,
+                                        static_cast<uint32_t>(regions.size()));
+
+        mImage->fillImageData(data.size(),
+                              const_cast<uint8_t*>(data.data()),
+                              regions,
+                              uploadEngine,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+
+    void Texture::createFromPixels(const uint8_t* pixels,
+                                   uint32_t channels,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   VkFormat format,
+                                   VkFormat compressedFormat,
+                                   MipMode mipMode,
+                                   const std::string& sourcePath,
+                                   const Wrapper::UploadEngine::Ptr& uploadEngine,
+                                   ThreadPool& threadPool)
+    {
+        size_t texSize = size_t(width) * height * 4;  // 计算图像总字节数（RGBA 每个像素 4 字节）
+
+        // 完整 mip 链：缩小采样时读取的纹素与屏幕像素数量相当，避免走样和纹理缓存抖动
+        uint32_t mipLevels = mipMode == MipMode::None ? 1 : Wrapper::Image::getMipLevelCount(width, height);
 
-        // 使用 stb_image 库加载图像文件（跨平台轻量级图像加载库）
-        // 参数说明：
-        //   imageFilePath.c_str(): 图像文件路径
-        //   &texWidth/&texHeight: 输出图像宽高（像素）
-        //   &texChannles: 输出原始通道数（如 RGB=3，RGBA=4）
-        //   STBI_rgb_alpha: 强制转换为 RGBA 格式（4 通道，忽略原始通道数）
-        stbi_uc* pixels = stbi_load(imageFilePath.c_str(),
-                                    &texWidth,
-                                    &texHeight,
-                                    &texChannles,
-                                    STBI_rgb_alpha);
+        bool gpuMips = mipLevels > 1 && mipMode == MipMode::Auto && Wrapper::Image::supportsLinearBlit(mDevice, format);
 
-        if (!pixels)  // 加载失败处理
+        // 只有 CPU 生成 mip 链或压缩时需要一份 RGBA 副本；其余路径在写暂存内存时直接转换
+        std::vector<uint8_t> rgba{};
+        if (channels != 4 && (compressedFormat != VK_FORMAT_UNDEFINED || (mipLevels > 1 && !gpuMips)))
         {
-            throw std::runtime_error("Error: failed to read image data!");
+            rgba.resize(texSize);
+            DecodedImage::convertToRGBA8(pixels, channels, width, height, rgba.data());
+            pixels   = rgba.data();
+            channels = 4;
         }
 
-        texSize = texWidth * texHeight * 4;  // 计算图像总字节数（RGBA 每个像素 4 字节）
+        // -------------------- 块压缩：CPU 上生成 mip 链后逐级编码 --------------------
+        if (compressedFormat != VK_FORMAT_UNDEFINED)
+        {
+            std::vector<VkBufferImageCopy> regions{};
+            std::vector<uint8_t> mipData = MipChain::buildRGBA8(pixels, width, height, mipLevels, regions);
+
+            std::vector<uint8_t> blocks{};
+            for (auto& region : regions)
+            {
+                auto encoded = BlockCompression::encode(mipData.data() + region.bufferOffset,
+                                                        region.imageExtent.width,
+                                                        region.imageExtent.height,
+                                                        compressedFormat,
+                                                        threadPool);
+
+                region.bufferOffset = blocks.size();
+                blocks.insert(blocks.end(), encoded.begin(), encoded.end());
+            }
 
-        // -------------------- 步骤2：创建 Vulkan 图像对象（GPU 内存） --------------------
+            createFromLevels(blocks, regions, compressedFormat, width, height, uploadEngine);
+
+            if (!sourcePath.empty() && regions.size() > 1)
+            {
+                keepLevels(blocks, regions, compressedFormat, width, height);
+            }
+            return;
+        }
+
+        // -------------------- 创建 Vulkan 图像对象（GPU 内存） --------------------
         // 创建一个 2D 纹理图像，用于存储 GPU 可访问的纹理数据
         // 参数说明（关键参数）：
         //   mDevice: Vulkan 设备
-        //   texWidth/texHeight: 图像宽高（像素）
-        //   VK_FORMAT_R8G8B8A8_SRGB: 图像格式（RGBA 8 位，sRGB 色彩空间）
+        //   width/height: 图像宽高（像素）
+        //   format: 图像格式（颜色为 RGBA 8 位 sRGB，法线与数据为线性）
         //   VK_IMAGE_TYPE_2D: 二维图像（非 1D/3D/立方体贴图）
         //   VK_IMAGE_TILING_OPTIMAL: 最优平铺方式（Vulkan 自动优化内存布局）
         //   VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT:
         //     图像用途
         //       - TRANSFER_DST_BIT: 允许作为传输操作的目标（接收缓冲区数据）
         //       - SAMPLED_BIT: 允许被采样器采样（用于着色器读取）
+        //       - TRANSFER_SRC_BIT: 仅 GPU 生成 mip 时需要，上一级作为 blit 源
         //   VK_SAMPLE_COUNT_1_BIT: 单采样（无多重采样）
         //   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT: 内存属性（GPU 本地内存，高性能）
         //   VK_IMAGE_ASPECT_COLOR_BIT: 图像子资源方面（仅颜色通道）
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (gpuMips)
+        {
+            usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+
         mImage = Wrapper::Image::create(mDevice,
-                                        texWidth,
-                                        texHeight,
-                                        VK_FORMAT_R8G8B8A8_SRGB,
+                                        width,
+                                        height,
+                                        format,
                                         VK_IMAGE_TYPE_2D,
                                         VK_IMAGE_TILING_OPTIMAL,
-                                        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                        usage,
                                         VK_SAMPLE_COUNT_1_BIT,
                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                        VK_IMAGE_ASPECT_COLOR_BIT);
+                                        VK_IMAGE_ASPECT_COLOR_BIT,
+                                        mipLevels);
 
+        // 布局转换、拷贝与队列族所有权转移都由上传引擎在传输队列上完成，
+        // 渲染提交在片元着色器阶段等待它；第 0 级在拷贝进暂存环时扩展为 RGBA
+        auto writeLevel0 = [pixels, channels, width, height](void* pStaging)
+        {
+            DecodedImage::convertToRGBA8(pixels, channels, width, height, static_cast<uint8_t*>(pStaging));
+        };
 
-        VkImageSubresourceRange region{};
-        region.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.baseArrayLayer = 0;
-        region.layerCount     = 1;
-        region.baseMipLevel   = 0;
-        region.levelCount     = 1;
+        if (mipLevels == 1)
+        {
+            mImage->fillImageData(texSize,
+                                  writeLevel0,
+                                  uploadEngine,
+                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+        else if (gpuMips)
+        {
+            // 只上传第 0 级，其余级别在图形队列上逐级 blit
+            mImage->fillImageDataAndGenerateMips(texSize,
+                                                 writeLevel0,
+                                                 uploadEngine,
+                                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+        else
+        {
+            // CPU 回退：整条链排在一块暂存数据中，一次多区域拷贝
+            std::vector<VkBufferImageCopy> regions{};
+            std::vector<uint8_t> mipData = MipChain::buildRGBA8(pixels, width, height, mipLevels, regions);
 
-        mImage->setImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                               VK_PIPELINE_STAGE_TRANSFER_BIT,
-                               VK_PIPELINE_STAGE_TRANSFER_BIT,
-                               region,
-                               commandPool);
+            mImage->fillImageData(mipData.size(),
+                                 mipData.data(),
+                                 regions,
+                                 uploadEngine,
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
 
-        mImage->fillImageData(texSize,
-                             (void*)pixels,
-                             commandPool);
+        // 不保留 mip 链，只记下源文件：降级与恢复都很少发生，到时重新解码
+        if (!sourcePath.empty() && mipLevels > 1)
+        {
+            mSourcePath   = sourcePath;
+            mSourceWidth  = width;
+            mSourceHeight = height;
+            mGpuMips      = gpuMips;
+        }
+    }
 
-        mImage->setImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                               VK_PIPELINE_STAGE_TRANSFER_BIT,
-                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                               region,
-                               commandPool);
+    void Texture::keepLevels(const std::vector<uint8_t>& data, const std::vector<VkBufferImageCopy>& regions, VkFormat format, uint32_t width, uint32_t height)
+    {
+        // 各级按顺序排放，相邻两级的偏移之差即该级（含对齐填充）的字节数
+        std::vector<std::vector<uint8_t>> levels(regions.size());
 
-        stbi_image_free(pixels);
+        for (size_t i = 0; i < regions.size(); ++i)
+        {
+            size_t begin = static_cast<size_t>(regions[i].bufferOffset);
+            size_t end   = i + 1 < regions.size() ? static_cast<size_t>(regions[i + 1].bufferOffset) : data.size();
 
-        mSampler = Wrapper::Sampler::create(mDevice);
+            levels[i].assign(data.begin() + begin, data.begin() + end);
+        }
 
-        mImageInfo.imageLayout = mImage->getLayout();
-        mImageInfo.imageView   = mImage->getImageView();
-        mImageInfo.sampler     = mSampler->getSampler();
+        mStreamSource = Ktx2File::fromLevels(format, width, height, std::move(levels));
     }
-
-    Texture::~Texture() {}
 }
@@ -4,7 +4,10 @@
 #include "../vulkanWrapper/image.h"
 #include "../vulkanWrapper/sampler.h"
 #include "../vulkanWrapper/device.h"
-#include "../vulkanWrapper/commandPool.h"
+#include "../vulkanWrapper/uploadEngine.h"
+#include "ktx2File.h"
+#include "decodedImage.h"
+#include "../threadPool.h"
 
 namespace LearnVulkan
 {
@@ -12,25 +15,188 @@ namespace LearnVulkan
     {
     public:
         using Ptr = std::shared_ptr<Texture>;
-        static Ptr create(const Wrapper::Device::Ptr& device, const Wrapper::CommandPool::Ptr& commandPool, const std::string& imageFilePath)
+
+        /// Auto：格式支持线性 blit 时在 GPU 上生成 mip 链，否则回退到 CPU；Cpu：总是在 CPU 上生成；None：只有第 0 级
+        enum class MipMode
+        {
+            None,
+            Auto,
+            Cpu
+        };
+
+        /// 纹理内容决定格式：Color 为 sRGB 颜色（BC7 / RGBA8 sRGB），Normal 为切线空间法线，
+        /// 只保留 XY（BC5 / RGBA8，着色器重建 Z），Data 为线性数据如高光、发光（BC7 / RGBA8）
+        enum class Usage
+        {
+            Color,
+            Normal,
+            Data
+        };
+
+        /// 同名的 .ktx2 / .dds 存在且设备支持其格式时直接上传预压缩数据；
+        /// 否则解码源图像，compressOnLoad 为 true 且设备支持 BCn 时在加载时压缩（在 threadPool 上并行编码）。
+        /// streamBudget 不为 0 时 .ktx2 的 mip 链流式加载：创建时只上传不超过该字节数的最小几级，
+        /// 其余级别由 streamLevels 每帧在同样的预算内从小到大补齐。
+        /// evictable 为 true（设置了纹理预算）时由源图像生成 mip 链的纹理也可以被常驻管理降级，见 reallocate
+        static Ptr create(const Wrapper::Device::Ptr& device,
+                          const Wrapper::UploadEngine::Ptr& uploadEngine,
+                          ThreadPool& threadPool,
+                          const std::string& imageFilePath,
+                          MipMode mipMode = MipMode::Auto,
+                          Usage usage = Usage::Color,
+                          bool compressOnLoad = false,
+                          VkDeviceSize streamBudget = 0,
+                          bool evictable = false)
+        {
+            return std::make_shared<Texture>(device, uploadEngine, threadPool, imageFilePath, mipMode, usage, compressOnLoad, streamBudget, evictable);
+        }
+
+        Texture(const Wrapper::Device::Ptr& device,
+                const Wrapper::UploadEngine::Ptr& uploadEngine,
+                ThreadPool& threadPool,
+                const std::string& imageFilePath,
+                MipMode mipMode = MipMode::Auto,
+                Usage usage = Usage::Color,
+                bool compressOnLoad = false,
+                VkDeviceSize streamBudget = 0,
+                bool evictable = false);
+
+        /// 从已解码的源图像创建（见 loadAll），不查找预压缩文件；
+        /// sourcePath 为该图像的文件，不为空时纹理可以被降级（恢复时重新解码），为空时只计入占用
+        static Ptr create(const Wrapper::Device::Ptr& device,
+                          const Wrapper::UploadEngine::Ptr& uploadEngine,
+                          ThreadPool& threadPool,
+                          const DecodedImage& image,
+                          MipMode mipMode = MipMode::Auto,
+                          Usage usage = Usage::Color,
+                          bool compressOnLoad = false,
+                          const std::string& sourcePath = {})
         {
-            return std::make_shared<Texture>(device, commandPool, imageFilePath);
+            return std::make_shared<Texture>(device, uploadEngine, threadPool, image, mipMode, usage, compressOnLoad, sourcePath);
         }
 
-        Texture(const Wrapper::Device::Ptr& device, const Wrapper::CommandPool::Ptr& commandPool, const std::string& imageFilePath);
+        Texture(const Wrapper::Device::Ptr& device,
+                const Wrapper::UploadEngine::Ptr& uploadEngine,
+                ThreadPool& threadPool,
+                const DecodedImage& image,
+                MipMode mipMode = MipMode::Auto,
+                Usage usage = Usage::Color,
+                bool compressOnLoad = false,
+                const std::string& sourcePath = {});
 
         ~Texture();
 
+        /// 一次加载一组纹理（例如一个模型的所有贴图）：源图像在线程池中并行解码（加载时压缩也用同一个线程池），
+        /// 之后在调用线程上依次创建图像并写入暂存环；有预压缩文件的纹理跳过解码，按路径创建
+        static std::vector<Ptr> loadAll(const Wrapper::Device::Ptr& device,
+                                        const Wrapper::UploadEngine::Ptr& uploadEngine,
+                                        const std::vector<std::pair<std::string, Usage>>& files,
+                                        ThreadPool& threadPool,
+                                        MipMode mipMode = MipMode::Auto,
+                                        bool compressOnLoad = false,
+                                        VkDeviceSize streamBudget = 0,
+                                        bool evictable = false);
+
         [[nodiscard]] auto getImage() const { return mImage; }
         
         [[nodiscard]] auto getSampler() const { return mSampler; }
 
         [[nodiscard]] VkDescriptorImageInfo& getImageInfo() { return mImageInfo; }
 
+        /// 已上传的最精细一级；描述符中的视图从这一级开始，未上传的级别不会被采样
+        [[nodiscard]] auto getResidentLevel() const { return mResidentLevel; }
+
+        [[nodiscard]] bool isFullyResident() const { return mResidentLevel == 0; }
+
+        /// 图像分配到的最精细一级（级别编号都相对完整 mip 链）：被常驻管理降级后大于 0，
+        /// 更精细的级别既不占显存也无法上传，直到 reallocate 重新分配
+        [[nodiscard]] auto getAllocatedLevel() const { return mAllocatedLevel; }
+
+        /// 已分配但还没有上传的级别，由 streamLevels 补齐
+        [[nodiscard]] bool hasPendingLevels() const { return mResidentLevel > mAllocatedLevel; }
+
+        /// 完整 mip 链的级数
+        [[nodiscard]] uint32_t getLevelCount() const { return mAllocatedLevel + mImage->getMipLevels(); }
+
+        /// 能否降级 / 恢复：需要能按级别重新读取数据的来源（.ktx2 文件、保留在内存中的压缩级别，或可以重新解码的源图像）
+        [[nodiscard]] bool isEvictable() const { return mStreamSource != nullptr || !mSourcePath.empty(); }
+
+        /// 当前图像占用的显存
+        [[nodiscard]] VkDeviceSize getMemorySize() const { return mImage->getMemorySize(); }
+
+        /// 从 baseLevel 开始分配时各级数据的字节数（不含对齐，作为显存占用的估计）
+        [[nodiscard]] VkDeviceSize estimateMemorySize(uint32_t baseLevel) const;
+
+        /// 记录纹理在第 frame 帧被采样（常驻管理按它做 LRU）
+        void markSampled(uint64_t frame) { mLastSampledFrame = frame; }
+
+        [[nodiscard]] auto getLastSampledFrame() const { return mLastSampledFrame; }
+
+        /// 按从小到大的顺序上传下一级，直到本次累计超过 budget 字节（每次至少一级），返回上传的字节数；
+        /// 常驻级别变化后 getImageInfo() 指向新视图，调用方需在该帧提交前更新描述符
+        VkDeviceSize streamLevels(const Wrapper::UploadEngine::Ptr& uploadEngine, VkDeviceSize budget);
+
+        /// 换成只包含 [baseLevel, 最后一级] 的新图像（需 isEvictable）：已常驻且仍在范围内的级别立即重新上传，
+        /// 比原来更精细的级别之后由 streamLevels 补齐；由源图像创建的纹理重新解码，所有级别一次上传。返回被替换的旧图像，
+        /// 调用方要保留它直到之前提交的帧不再使用（见 TextureResidency）
+        Wrapper::Image::Ptr reallocate(uint32_t baseLevel, const Wrapper::UploadEngine::Ptr& uploadEngine);
+
+        /// 该用途对应的未压缩 / 块压缩格式
+        static VkFormat getUncompressedFormat(Usage usage);
+        static VkFormat getCompressedFormat(Usage usage);
+
+    private:
+        /// 由 mImage 创建采样器并填写描述符信息
+        void createSampler();
+
+        /// 源图像按用途选择格式，compressOnLoad 且设备支持时压缩；sourcePath 见 create
+        void createFromImage(const DecodedImage& image, MipMode mipMode, Usage usage, bool compressOnLoad, const std::string& sourcePath, const Wrapper::UploadEngine::Ptr& uploadEngine, ThreadPool& threadPool);
+
+        /// KTX2 容器：streamBudget 为 0 时所有级别一次上传，否则只上传预算内的最小几级
+        void createFromKtx2(const Ktx2File::Ptr& ktx, VkDeviceSize streamBudget, const Wrapper::UploadEngine::Ptr& uploadEngine);
+
+        /// 已编码好的各级数据一次上传（预压缩文件或加载时压缩的结果）
+        void createFromLevels(const std::vector<uint8_t>& data,
+                              const std::vector<VkBufferImageCopy>& regions,
+                              VkFormat format,
+                              uint32_t width,
+                              uint32_t height,
+                              const Wrapper::UploadEngine::Ptr& uploadEngine);
+
+        /// 1 ~ 4 通道的像素按 mipMode 生成 mip 链；compressedFormat 不为 UNDEFINED 时在 CPU 上压缩每一级。
+        /// 只上传第 0 级的路径（无 mip 或 GPU 生成）在写暂存内存时直接扩展为 RGBA8，不经过中间缓冲。
+        /// sourcePath 不为空且有多级时纹理可以被降级：未压缩的只记下源文件，压缩后的各级保留在内存中（重新编码太慢）
+        void createFromPixels(const uint8_t* pixels,
+                              uint32_t channels,
+                              uint32_t width,
+                              uint32_t height,
+                              VkFormat format,
+                              VkFormat compressedFormat,
+                              MipMode mipMode,
+                              const std::string& sourcePath,
+                              const Wrapper::UploadEngine::Ptr& uploadEngine,
+                              ThreadPool& threadPool);
+
+        /// 把依次排放在 data 中的各级数据保留为 mStreamSource，之后 reallocate / streamLevels 从中读取
+        void keepLevels(const std::vector<uint8_t>& data, const std::vector<VkBufferImageCopy>& regions, VkFormat format, uint32_t width, uint32_t height);
+
+        /// reallocate 的源图像版本：重新解码 mSourcePath，在 CPU 上缩小到 baseLevel，
+        /// GPU 生成 mip 的纹理只上传这一级、其余照旧 blit（恢复到第 0 级时与加载时的结果相同）
+        Wrapper::Image::Ptr reallocateFromSource(uint32_t baseLevel, const Wrapper::UploadEngine::Ptr& uploadEngine);
+
     private:
         Wrapper::Device::Ptr  mDevice{ nullptr };
         Wrapper::Image::Ptr   mImage{ nullptr };
         Wrapper::Sampler::Ptr mSampler{ nullptr };
         VkDescriptorImageInfo mImageInfo{};
+
+        Ktx2File::Ptr mStreamSource{ nullptr };  // .ktx2 或内存中的压缩级别，流式加载与恢复被降级的级别时按需读取
+        std::string   mSourcePath{};             // 可降级的未压缩纹理的源图像，reallocate 时重新解码
+        uint32_t      mSourceWidth{ 0 };
+        uint32_t      mSourceHeight{ 0 };
+        bool          mGpuMips{ false };         // mip 链由 GPU blit 生成
+        uint32_t      mResidentLevel{ 0 };
+        uint32_t      mAllocatedLevel{ 0 };
+        uint64_t      mLastSampledFrame{ 0 };
     };
 }
@@ -0,0 +1,246 @@
+﻿#include "textureResidency.h"
+#include "../vulkanWrapper/cpuProfiler.h"
+
+#include <algorithm>
+
+namespace LearnVulkan
+{
+    /// 降级的下限：最大边不超过 minSize 的第一级（至少保留最后一级）
+    static uint32_t getMinResidentLevel(const Texture& texture, uint32_t minSize)
+    {
+        uint32_t level = texture.getAllocatedLevel();
+        size_t   size  = std::max(texture.getImage()->getWidth(), texture.getImage()->getHeight());
+
+        while (size > minSize && level + 1 < texture.getLevelCount())
+        {
+            size = std::max<size_t>(1, size / 2);
+            ++level;
+        }
+
+        return level;
+    }
+
+    TextureResidency::TextureResidency(const Wrapper::Device::Ptr& device, uint32_t framesInFlight, VkDeviceSize budget)
+    {
+        mDevice         = device;
+        mFramesInFlight = std::max(1u, framesInFlight);
+        mBudget         = budget;
+    }
+
+    TextureResidency::~TextureResidency()
+    {
+        mRetiredImages.clear();
+        mTextures.clear();
+    }
+
+    void TextureResidency::add(const Texture::Ptr& texture)
+    {
+        // 纹理都在设备本地内存中，以第一个纹理所在的堆为准
+        if (mTextures.empty())
+        {
+            mHeapIndex = texture->getImage()->getMemoryHeapIndex();
+        }
+
+        mTextures.push_back(texture);
+
+        mTextureBytes += texture->getMemorySize();
+        mPeakTextureBytes = std::max(mPeakTextureBytes, mTextureBytes);
+    }
+
+    void TextureResidency::update(const Wrapper::UploadEngine::Ptr& uploadEngine)
+    {
+        CPU_PROFILE_ZONE("TextureResidency::update");
+
+        ++mFrameNumber;
+
+        // 第 N 帧替换下来的图像只可能被第 N 帧之前提交的帧使用，再过 mFramesInFlight 帧它们都已完成
+        mRetiredImages.erase(std::remove_if(mRetiredImages.begin(), mRetiredImages.end(), [this](const RetiredImage& retired)
+        {
+            if (retired.mFrameNumber + mFramesInFlight > mFrameNumber)
+            {
+                return false;
+            }
+
+            mRetiredBytes -= retired.mImage->getMemorySize();
+            return true;
+        }), mRetiredImages.end());
+
+        if (mTextures.empty())
+        {
+            return;
+        }
+
+        mTextureBytes = 0;
+        for (const auto& texture : mTextures)
+        {
+            mTextureBytes += texture->getMemorySize();
+        }
+
+        mCurrentBudget = computeBudget(mTextureBytes + mRetiredBytes);
+
+        // 降级只看纹理当前图像的占用：被替换的图像几帧后就会释放，把它们算进来会降级过多
+        VkDeviceSize usedBytes = mTextureBytes;
+
+        bool changed = false;
+        if (usedBytes > mCurrentBudget)
+        {
+            changed = evict(usedBytes, mCurrentBudget, uploadEngine);
+        }
+        else
+        {
+            usedBytes += mRetiredBytes;
+            changed    = restore(usedBytes, mCurrentBudget, uploadEngine);
+        }
+
+        if (changed)
+        {
+            mTextureBytes = 0;
+            for (const auto& texture : mTextures)
+            {
+                mTextureBytes += texture->getMemorySize();
+            }
+        }
+
+        mPeakTextureBytes = std::max(mPeakTextureBytes, mTextureBytes);
+    }
+
+    VkDeviceSize TextureResidency::computeBudget(VkDeviceSize trackedBytes) const
+    {
+        auto heap = mDevice->getAllocator()->getHeapBudget(mHeapIndex);
+
+        // 其他资源（顶点 / 索引 / uniform / 附件）按分配器的实际子分配统计，纹理释放后立即反映出来
+        VkDeviceSize otherBytes = heap.mUsedBytes > trackedBytes ? heap.mUsedBytes - trackedBytes : 0;
+        VkDeviceSize available  = heap.mBudget > otherBytes ? heap.mBudget - otherBytes : 0;
+
+        // 留 10% 给大块内的碎片与驱动内部的分配
+        available = available / 10 * 9;
+
+        return mBudget != 0 ? std::min(mBudget, available) : available;
+    }
+
+    bool TextureResidency::evict(VkDeviceSize& usedBytes, VkDeviceSize budget, const Wrapper::UploadEngine::Ptr& uploadEngine)
+    {
+        std::vector<Texture::Ptr> candidates{};
+        for (const auto& texture : mTextures)
+        {
+            if (texture->isEvictable() && texture->getAllocatedLevel() < getMinResidentLevel(*texture, MIN_RESIDENT_SIZE))
+            {
+                candidates.push_back(texture);
+            }
+        }
+
+        // 最久没有被采样的先降级，同一帧采样的先降级占用大的
+        std::sort(candidates.begin(), candidates.end(), [](const Texture::Ptr& a, const Texture::Ptr& b)
+        {
+            if (a->getLastSampledFrame() != b->getLastSampledFrame())
+            {
+                return a->getLastSampledFrame() < b->getLastSampledFrame();
+            }
+            return a->getMemorySize() > b->getMemorySize();
+        });
+
+        bool changed = false;
+
+        for (const auto& texture : candidates)
+        {
+            if (usedBytes <= budget)
+            {
+                break;
+            }
+
+            VkDeviceSize currentBytes = texture->getMemorySize();
+            uint32_t     minLevel     = getMinResidentLevel(*texture, MIN_RESIDENT_SIZE);
+
+            // 一次降到足够的级别，同一个纹理每帧最多换一次图像
+            uint32_t level = texture->getAllocatedLevel();
+            while (level < minLevel)
+            {
+                ++level;
+                if (usedBytes - currentBytes + texture->estimateMemorySize(level) <= budget)
+                {
+                    break;
+                }
+            }
+
+            retire(texture->reallocate(level, uploadEngine));
+
+            usedBytes = usedBytes - currentBytes + texture->getMemorySize();
+            ++mEvictionCount;
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    bool TextureResidency::restore(VkDeviceSize& usedBytes, VkDeviceSize budget, const Wrapper::UploadEngine::Ptr& uploadEngine)
+    {
+        // 只恢复最近几帧仍在采样的纹理，上一次恢复的级别流式上传完之前不再扩大
+        std::vector<Texture::Ptr> candidates{};
+        for (const auto& texture : mTextures)
+        {
+            if (texture->isEvictable() &&
+                texture->getAllocatedLevel() > 0 &&
+                !texture->hasPendingLevels() &&
+                texture->getLastSampledFrame() + mFramesInFlight >= mFrameNumber)
+            {
+                candidates.push_back(texture);
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const Texture::Ptr& a, const Texture::Ptr& b)
+        {
+            return a->getLastSampledFrame() > b->getLastSampledFrame();
+        });
+
+        VkDeviceSize restoreLimit = budget - budget / 16;
+
+        for (const auto& texture : candidates)
+        {
+            // 新图像创建后旧图像还要保留几帧，两者同时占用显存
+            if (usedBytes + texture->estimateMemorySize(texture->getAllocatedLevel() - 1) > restoreLimit)
+            {
+                continue;
+            }
+
+            // 每帧最多恢复一个纹理，只重新上传原来已常驻的小级别，新增的一级交给 streamLevels
+            retire(texture->reallocate(texture->getAllocatedLevel() - 1, uploadEngine));
+
+            usedBytes += texture->getMemorySize();
+            ++mRestoreCount;
+            return true;
+        }
+
+        return false;
+    }
+
+    void TextureResidency::retire(const Wrapper::Image::Ptr& image)
+    {
+        if (image == nullptr)
+        {
+            return;
+        }
+
+        mRetiredBytes += image->getMemorySize();
+        mRetiredImages.push_back({ image, mFrameNumber });
+    }
+
+    void TextureResidency::printStats() const
+    {
+        constexpr VkDeviceSize MB = 1024 * 1024;
+
+        uint32_t degradedCount = 0;
+        for (const auto& texture : mTextures)
+        {
+            degradedCount += texture->getAllocatedLevel() > 0 ? 1 : 0;
+        }
+
+        auto heap = mDevice->getAllocator()->getHeapBudget(mHeapIndex);
+
+        std::cout << "Texture residency: " << mTextures.size() << " textures, " << degradedCount << " degraded"
+                  << ", " << mTextureBytes / MB << " MB (peak " << mPeakTextureBytes / MB << " MB)"
+                  << ", budget " << mCurrentBudget / MB << " MB"
+                  << ", evictions " << mEvictionCount << ", restores " << mRestoreCount
+                  << ", heap " << mHeapIndex << " usage " << heap.mUsage / MB << " / " << heap.mBudget / MB << " MB"
+                  << (mDevice->supportsMemoryBudget() ? " (VK_EXT_memory_budget)" : " (estimated)") << std::endl;
+    }
+}
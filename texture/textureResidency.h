@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include "../vulkanWrapper/base.h"
+#include "../vulkanWrapper/device.h"
+#include "../vulkanWrapper/image.h"
+#include "../vulkanWrapper/uploadEngine.h"
+#include "texture.h"
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // 纹理常驻管理：统计每个纹理的显存，超出预算时降低分辨率而不是让分配失败
+    // 预算来自纹理所在的内存堆（启用 VK_EXT_memory_budget 时由驱动给出，否则取堆大小的 80%），
+    // 扣除其他资源的占用，还可以用 budget 参数进一步限制。
+    // 超出预算时按最后一次被采样的帧从旧到新（LRU）逐个丢掉最精细的几级：纹理换成更小的图像，
+    // 旧图像在之前提交的帧完成后释放；有空余时最近被采样的纹理每帧恢复一级，数据由 streamLevels 补齐。
+    // 只有能按级别重新读取数据的纹理（.ktx2，或设置了 budget 时由源图像生成 mip 链的纹理，恢复时重新解码）会被降级，
+    // 其余纹理（单级、预压缩 .dds）只计入占用
+    // ==================================================================
+    class TextureResidency
+    {
+    public:
+        using Ptr = std::shared_ptr<TextureResidency>;
+
+        static Ptr create(const Wrapper::Device::Ptr& device, uint32_t framesInFlight, VkDeviceSize budget = 0)
+        {
+            return std::make_shared<TextureResidency>(device, framesInFlight, budget);
+        }
+
+        /// budget 为 0 时只使用设备给出的预算；framesInFlight 决定被替换的图像要保留几帧
+        TextureResidency(const Wrapper::Device::Ptr& device, uint32_t framesInFlight, VkDeviceSize budget = 0);
+
+        ~TextureResidency();
+
+        void add(const Texture::Ptr& texture);
+
+        /// 每帧在该帧上一次的提交完成之后、录制之前调用一次：进入下一帧，释放不再使用的旧图像，
+        /// 超出预算时降级，有空余时恢复；纹理换了图像后 getImageInfo() 指向新视图，调用方需在提交前更新描述符
+        void update(const Wrapper::UploadEngine::Ptr& uploadEngine);
+
+        /// 标记纹理在当前帧被采样
+        void markSampled(const Texture::Ptr& texture) const { texture->markSampled(mFrameNumber); }
+
+        [[nodiscard]] auto getFrameNumber()  const { return mFrameNumber; }
+        [[nodiscard]] auto getTextureBytes() const { return mTextureBytes; }
+        [[nodiscard]] auto getBudget()       const { return mCurrentBudget; }
+
+        void printStats() const;
+
+    private:
+        /// 本帧纹理可用的字节数
+        VkDeviceSize computeBudget(VkDeviceSize trackedBytes) const;
+
+        /// 按 LRU 降级，直到占用不超过预算或没有可降级的纹理
+        bool evict(VkDeviceSize& usedBytes, VkDeviceSize budget, const Wrapper::UploadEngine::Ptr& uploadEngine);
+
+        /// 最近被采样、被降级过的纹理恢复一级（留出余量，避免在预算边缘反复降级 / 恢复）
+        bool restore(VkDeviceSize& usedBytes, VkDeviceSize budget, const Wrapper::UploadEngine::Ptr& uploadEngine);
+
+        /// 保留被替换的图像直到之前提交的帧完成
+        void retire(const Wrapper::Image::Ptr& image);
+
+    private:
+        /// 降级时至少保留到最大边不超过该尺寸的一级，画面只会变模糊而不会丢失
+        static constexpr uint32_t MIN_RESIDENT_SIZE = 64;
+
+        struct RetiredImage
+        {
+            Wrapper::Image::Ptr mImage{ nullptr };
+            uint64_t            mFrameNumber{ 0 };
+        };
+
+        Wrapper::Device::Ptr      mDevice{ nullptr };
+        std::vector<Texture::Ptr> mTextures{};
+        std::vector<RetiredImage> mRetiredImages{};
+
+        uint32_t     mFramesInFlight{ 1 };
+        uint64_t     mFrameNumber{ 0 };
+        VkDeviceSize mBudget{ 0 };
+        VkDeviceSize mCurrentBudget{ 0 };
+        VkDeviceSize mTextureBytes{ 0 };
+        VkDeviceSize mRetiredBytes{ 0 };
+        uint32_t     mHeapIndex{ 0 };
+
+        uint64_t     mEvictionCount{ 0 };
+        uint64_t     mRestoreCount{ 0 };
+        VkDeviceSize mPeakTextureBytes{ 0 };
+    };
+}
@@ -0,0 +1,174 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace LearnVulkan
+{
+    // ==================================================================
+    // 固定大小的工作线程池
+    // submit 投递单个任务；parallelFor 把 [0, count) 切给所有线程（调用线程也参与）并等待完成
+    // ==================================================================
+    class ThreadPool
+    {
+    public:
+        using Ptr = std::shared_ptr<ThreadPool>;
+
+        static Ptr create(uint32_t threadCount = 0)
+        {
+            return std::make_shared<ThreadPool>(threadCount);
+        }
+
+        /// threadCount 为 0 时使用硬件线程数
+        explicit ThreadPool(uint32_t threadCount = 0)
+        {
+            if (threadCount == 0)
+            {
+                threadCount = std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            mWorkers.reserve(threadCount);
+            for (uint32_t i = 0; i < threadCount; ++i)
+            {
+                mWorkers.emplace_back([this]() { workerLoop(); });
+            }
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStopping = true;
+            }
+
+            mCondition.notify_all();
+
+            for (auto& worker : mWorkers)
+            {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        template<typename Function>
+        auto submit(Function&& function) -> std::future<decltype(function())>
+        {
+            using Result = decltype(function());
+
+            auto task   = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+            auto future = task->get_future();
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mTasks.emplace([task]() { (*task)(); });
+            }
+
+            mCondition.notify_one();
+
+            return future;
+        }
+
+        /// 对 [0, count) 中的每个下标调用 function，返回前全部完成；function 抛出的第一个异常会重新抛出
+        void parallelFor(size_t count, const std::function<void(size_t)>& function)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            auto next = std::make_shared<std::atomic<size_t>>(0);
+
+            auto worker = [next, count, &function]()
+            {
+                for (size_t index = next->fetch_add(1); index < count; index = next->fetch_add(1))
+                {
+                    function(index);
+                }
+            };
+
+            size_t helperCount = std::min(count, mWorkers.size() + 1) - 1;
+
+            std::vector<std::future<void>> helpers{};
+            helpers.reserve(helperCount);
+            for (size_t i = 0; i < helperCount; ++i)
+            {
+                helpers.push_back(submit(worker));
+            }
+
+            std::exception_ptr error{};
+
+            try
+            {
+                worker();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+                next->store(count);
+            }
+
+            for (auto& helper : helpers)
+            {
+                try
+                {
+                    helper.get();
+                }
+                catch (...)
+                {
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        [[nodiscard]] uint32_t getThreadCount() const { return static_cast<uint32_t>(mWorkers.size()); }
+
+    private:
+        void workerLoop()
+        {
+            while (true)
+            {
+                std::function<void()> task;
+
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mCondition.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+
+                    if (mStopping && mTasks.empty())
+                    {
+                        return;
+                    }
+
+                    task = std::move(mTasks.front());
+                    mTasks.pop();
+                }
+
+                task();
+            }
+        }
+
+    private:
+        std::vector<std::thread>          mWorkers{};
+        std::queue<std::function<void()>> mTasks{};
+        std::mutex                        mMutex;
+        std::condition_variable           mCondition;
+        bool                              mStopping{ false };
+    };
+}
@@ -0,0 +1,184 @@
+﻿// 纹理离线压缩：把 .tga / .png / .jpg 转成带完整 mip 链的 BCn .dds / .ktx2，Texture 加载时优先使用同名文件
+//
+// 用法：Bona_texconv [--format bc1|bc3|bc4|bc5|bc7] [--normal | --linear] [--no-mips] [--ktx2] [--threads N] input... [-o output.dds|.ktx2]
+// 未指定格式时按文件名推断：*_nm* 为法线（BC5），*_spec* / *_gloss* 为线性数据（BC7 UNORM），其余为 sRGB 颜色（BC7 sRGB）
+// -o 只在单个输入时可用，按扩展名选择容器；缺省输出到输入旁边，--ktx2 时为 .ktx2（可流式加载），否则为 .dds
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../stb_image.h"
+
+#include "../texture/texture.h"
+#include "../texture/mipChain.h"
+#include "../texture/blockCompression.h"
+#include "../texture/ddsFile.h"
+#include "../texture/ktx2File.h"
+
+using namespace LearnVulkan;
+
+namespace
+{
+    Texture::Usage guessUsage(const std::string& path)
+    {
+        std::string stem = std::filesystem::path(path).stem().string();
+        std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (stem.find("_nm") != std::string::npos)
+        {
+            return Texture::Usage::Normal;
+        }
+
+        if (stem.find("_spec") != std::string::npos || stem.find("_gloss") != std::string::npos)
+        {
+            return Texture::Usage::Data;
+        }
+
+        return Texture::Usage::Color;
+    }
+
+    /// 命令行格式名转 VkFormat；颜色格式按用途选 sRGB 或线性
+    VkFormat parseFormat(const std::string& name, Texture::Usage usage)
+    {
+        bool srgb = usage == Texture::Usage::Color;
+
+        if (name == "bc1") return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        if (name == "bc3") return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+        if (name == "bc4") return VK_FORMAT_BC4_UNORM_BLOCK;
+        if (name == "bc5") return VK_FORMAT_BC5_UNORM_BLOCK;
+        if (name == "bc7") return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+
+        throw std::runtime_error("Error: unknown format " + name);
+    }
+
+    void convert(const std::string& input, const std::string& output, const std::string& formatName, bool forceNormal, bool forceLinear, bool mips, ThreadPool& threadPool)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        int width, height, channels;
+        stbi_uc* pixels = stbi_load(input.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            throw std::runtime_error("Error: failed to read " + input);
+        }
+
+        Texture::Usage usage = forceNormal ? Texture::Usage::Normal : (forceLinear ? Texture::Usage::Data : guessUsage(input));
+        VkFormat       format = formatName.empty() ? Texture::getCompressedFormat(usage) : parseFormat(formatName, usage);
+
+        uint32_t levelCount = mips ? Wrapper::Image::getMipLevelCount(width, height) : 1;
+
+        std::vector<VkBufferImageCopy> regions{};
+        std::vector<uint8_t> mipData = MipChain::buildRGBA8(pixels, width, height, levelCount, regions);
+        stbi_image_free(pixels);
+
+        std::vector<std::vector<uint8_t>> levels{};
+        for (const auto& region : regions)
+        {
+            levels.push_back(BlockCompression::encode(mipData.data() + region.bufferOffset,
+                                                      region.imageExtent.width,
+                                                      region.imageExtent.height,
+                                                      format,
+                                                      threadPool));
+        }
+
+        if (std::filesystem::path(output).extension() == ".ktx2")
+        {
+            Ktx2File::write(output, format, width, height, levels);
+        }
+        else
+        {
+            DdsFile::write(output, format, width, height, levels);
+        }
+
+        size_t compressedSize = 0;
+        for (const auto& level : levels)
+        {
+            compressedSize += level.size();
+        }
+
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        std::cout << input << " -> " << output << " (" << width << "x" << height << ", " << levelCount << " levels, "
+                  << mipData.size() / 1024 << " KB -> " << compressedSize / 1024 << " KB, " << milliseconds << " ms)" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string formatName{};
+    std::string output{};
+    bool        forceNormal = false;
+    bool        forceLinear = false;
+    bool        mips        = true;
+    bool        ktx2        = false;
+    uint32_t    threadCount = 0;
+
+    std::vector<std::string> inputs{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--format" && i + 1 < argc)
+        {
+            formatName = argv[++i];
+        }
+        else if (arg == "-o" && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else if (arg == "--normal")
+        {
+            forceNormal = true;
+        }
+        else if (arg == "--linear")
+        {
+            forceLinear = true;
+        }
+        else if (arg == "--no-mips")
+        {
+            mips = false;
+        }
+        else if (arg == "--ktx2")
+        {
+            ktx2 = true;
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            threadCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else
+        {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty() || (!output.empty() && inputs.size() > 1))
+    {
+        std::cout << "Usage: Bona_texconv [--format bc1|bc3|bc4|bc5|bc7] [--normal | --linear] [--no-mips] [--ktx2] [--threads N] input... [-o output.dds|.ktx2]" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        ThreadPool threadPool(threadCount);
+
+        for (const auto& input : inputs)
+        {
+            std::string target = output.empty() ? std::filesystem::path(input).replace_extension(ktx2 ? ".ktx2" : ".dds").string() : output;
+            convert(input, target, formatName, forceNormal, forceLinear, mips, threadPool);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
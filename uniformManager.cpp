@@ -1,4 +1,7 @@
 ﻿#include "uniformManager.h"
+#include "vulkanWrapper/cpuProfiler.h"
+
+#include <algorithm>
 
 UniformManager::UniformManager()
 {
@@ -8,35 +11,42 @@ UniformManager::~UniformManager()
 {
 }
 
-void UniformManager::init(const Wrapper::Device::Ptr& device, const Wrapper::CommandPool::Ptr& commandPool, int frameCount)
+void UniformManager::init(const Wrapper::Device::Ptr& device, const Wrapper::UploadEngine::Ptr& uploadEngine, ThreadPool& threadPool, int frameCount, VkDeviceSize arenaSize, Texture::MipMode mipMode, bool compressTextures, VkDeviceSize textureStreamBudget, VkDeviceSize textureBudget)
 {
-    mDevice = device;
+    mDevice              = device;
+    mTextureStreamBudget = textureStreamBudget;
+
+    // 相机与物体 uniform 共用每帧一块 arena，描述符只指向 arena，具体位置由动态偏移决定
+    for (int i = 0; i < frameCount; ++i)
+    {
+        mArenas.push_back(Wrapper::UniformArena::create(device, arenaSize));
+    }
+    mVPOffsets.resize(frameCount, 0);
+    mObjectOffsets.resize(frameCount, 0);
 
     auto vpParam             = Wrapper::UniformParameter::create();  
     vpParam->mBinding        = 0;                                    
     vpParam->mCount          = 1;                                   
-    vpParam->mDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    vpParam->mDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     vpParam->mSize           = sizeof(VPMatrices);
     vpParam->mStage          = VK_SHADER_STAGE_VERTEX_BIT;
 
     for (int i = 0; i < frameCount; ++i)
     {
-        auto buffer = Wrapper::Buffer::createUniformBuffer(device, vpParam->mSize, nullptr);
-        vpParam->mBuffers.push_back(buffer);
+        vpParam->mBuffers.push_back(mArenas[i]->getBuffer());
     }
     mUniformParams.push_back(vpParam);
 
     auto objectParam             = Wrapper::UniformParameter::create();
     objectParam->mBinding        = 1;
     objectParam->mCount          = 1;
-    objectParam->mDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    objectParam->mDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     objectParam->mSize           = sizeof(ObjectUniform);
     objectParam->mStage          = VK_SHADER_STAGE_VERTEX_BIT;
 
     for (int i = 0; i < frameCount; ++i)
     {
-        auto buffer = Wrapper::Buffer::createUniformBuffer(device, objectParam->mSize, nullptr);
-        objectParam->mBuffers.push_back(buffer);
+        objectParam->mBuffers.push_back(mArenas[i]->getBuffer());
     }
     mUniformParams.push_back(objectParam);
 
@@ -45,9 +55,25 @@ void UniformManager::init(const Wrapper::Device::Ptr& device, const Wrapper::Com
     textureParam->mCount          = 1;
     textureParam->mDescriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     textureParam->mStage          = VK_SHADER_STAGE_FRAGMENT_BIT;
-    textureParam->mTexture        = Texture::create(mDevice, commandPool, "assets/models/diablo3_pose/diablo3_pose_diffuse.tga");
     mUniformParams.push_back(textureParam);
 
+    // 模型用到的贴图一起加载，源图像在线程池中并行解码；目前着色器只采样漫反射贴图（绑定 2）
+    std::vector<std::pair<std::string, Texture::Usage>> textureFiles =
+    {
+        { "assets/models/diablo3_pose/diablo3_pose_diffuse.tga", Texture::Usage::Color },
+    };
+
+    // 只有设置了纹理预算时由源图像创建的纹理才需要能被降级，否则不为它保留任何数据
+    auto textures = Texture::loadAll(mDevice, uploadEngine, textureFiles, threadPool, mipMode, compressTextures, textureStreamBudget, textureBudget != 0);
+
+    textureParam->mTexture = textures[0];
+
+    mTextureResidency = TextureResidency::create(device, static_cast<uint32_t>(frameCount), textureBudget);
+    for (const auto& texture : textures)
+    {
+        mTextureResidency->add(texture);
+    }
+
     mDescriptorSetLayout = Wrapper::DescriptorSetLayout::create(device);
     mDescriptorSetLayout->build(mUniformParams);
 
@@ -55,15 +81,78 @@ void UniformManager::init(const Wrapper::Device::Ptr& device, const Wrapper::Com
     mDescriptorPool->build(mUniformParams, frameCount);
 
     mDescriptorSet = Wrapper::DescriptorSet::create(device, mUniformParams, mDescriptorSetLayout, mDescriptorPool, frameCount);
+
+    // 记录每帧描述符集创建时写入的纹理视图，流式加载换视图后逐帧补写
+    mWrittenTextureViews.resize(frameCount, std::vector<VkImageView>(mUniformParams.size(), VK_NULL_HANDLE));
+    for (int i = 0; i < frameCount; ++i)
+    {
+        for (size_t p = 0; p < mUniformParams.size(); ++p)
+        {
+            if (mUniformParams[p]->mTexture != nullptr)
+            {
+                mWrittenTextureViews[i][p] = mUniformParams[p]->mTexture->getImageInfo().imageView;
+            }
+        }
+    }
+}
+
+void UniformManager::streamTextures(const Wrapper::UploadEngine::Ptr& uploadEngine, const int& frameCount)
+{
+    CPU_PROFILE_ZONE("UniformManager::streamTextures");
+
+    // 降级换下的图像只会被之前提交的帧使用；恢复一级后新增的级别与流式加载一样由下面补齐
+    mTextureResidency->update(uploadEngine);
+
+    // 预算由本帧所有纹理共享，从小到大逐级上传；不流式加载时恢复的级别一次补齐
+    VkDeviceSize budget = mTextureStreamBudget != 0 ? mTextureStreamBudget : VK_WHOLE_SIZE;
+
+    for (size_t p = 0; p < mUniformParams.size(); ++p)
+    {
+        const auto& texture = mUniformParams[p]->mTexture;
+        if (texture == nullptr)
+        {
+            continue;
+        }
+
+        if (budget > 0 && texture->hasPendingLevels())
+        {
+            budget -= std::min(budget, texture->streamLevels(uploadEngine, budget));
+        }
+
+        // 其他帧的描述符集在轮到它们时再更新，本帧的提交会等待刚才的上传
+        const auto& imageInfo = texture->getImageInfo();
+        if (mWrittenTextureViews[frameCount][p] != imageInfo.imageView)
+        {
+            mDescriptorSet->updateImage(frameCount, mUniformParams[p]->mBinding, imageInfo);
+            mWrittenTextureViews[frameCount][p] = imageInfo.imageView;
+        }
+    }
+}
+
+void UniformManager::getBoundTextures(VkShaderStageFlags stages, std::vector<Texture::Ptr>& textures) const
+{
+    for (const auto& param : mUniformParams)
+    {
+        if (param->mTexture != nullptr && (param->mStage & stages) != 0)
+        {
+            textures.push_back(param->mTexture);
+        }
+    }
 }
 
 void UniformManager::update(const VPMatrices& vpMatrices, const ObjectUniform& objectUniform, const int& frameCount)
 {
-    mUniformParams[0]->mBuffers[frameCount]->updateBufferByMap((void*)(&vpMatrices),
-                                                                sizeof(VPMatrices));
+    CPU_PROFILE_ZONE("UniformManager::update");
 
-    mUniformParams[1]->mBuffers[frameCount]->updateBufferByMap((void*)(&objectUniform),
-                                                                sizeof(ObjectUniform));
+    mArenas[frameCount]->reset();
+
+    mVPOffsets[frameCount]     = mArenas[frameCount]->push(&vpMatrices, sizeof(VPMatrices));
+    mObjectOffsets[frameCount] = pushObject(objectUniform, frameCount);
 
     // 注意：纹理不需要每帧更新，初始设置后即保持
 }
+
+uint32_t UniformManager::pushObject(const ObjectUniform& objectUniform, const int& frameCount)
+{
+    return mArenas[frameCount]->push(&objectUniform, sizeof(ObjectUniform));
+}
@@ -6,8 +6,10 @@
 #include "vulkanWrapper/descriptorSet.h"
 #include "vulkanWrapper/description.h"
 #include "vulkanWrapper/device.h"
-#include "vulkanWrapper/commandPool.h"
+#include "vulkanWrapper/uploadEngine.h"
+#include "vulkanWrapper/uniformArena.h"
 #include "vulkanWrapper/base.h"
+#include "texture/textureResidency.h"
 
 using namespace LearnVulkan;
 
@@ -21,19 +23,48 @@ public:
 
     ~UniformManager();
 
-    void init(const Wrapper::Device::Ptr &device, const Wrapper::CommandPool::Ptr &commandPool, int frameCount);
+    /// 每帧一块 arenaSize 字节的 uniform arena，相机与物体 uniform 都以动态偏移绑定
+    /// textureStreamBudget 不为 0 时 .ktx2 纹理的 mip 链流式加载，每帧最多上传这么多字节（见 streamTextures）
+    /// textureBudget 不为 0 时纹理显存不超过这么多字节（还受设备预算限制，见 TextureResidency），由源图像创建的纹理也参与降级
+    void init(const Wrapper::Device::Ptr &device, const Wrapper::UploadEngine::Ptr &uploadEngine, ThreadPool &threadPool, int frameCount, VkDeviceSize arenaSize = 4ull * 1024 * 1024, Texture::MipMode mipMode = Texture::MipMode::Auto, bool compressTextures = false, VkDeviceSize textureStreamBudget = 0, VkDeviceSize textureBudget = 0);
 
+    /// 重置该帧的 arena，写入相机与默认物体 uniform；调用方需保证该帧上一次的提交已完成
     void update(const VPMatrices &vpMatrices, const ObjectUniform &objectUniform, const int& frameCount);
 
+    /// 按显存预算降级 / 恢复纹理，流式上传下一批 mip 级别，
+    /// 并把该帧描述符集中的纹理视图更新到当前常驻级别；在该帧上一次的提交完成之后、本帧的上传刷新之前调用
+    void streamTextures(const Wrapper::UploadEngine::Ptr &uploadEngine, const int& frameCount);
+
+    /// 把描述符集中绑定到 stages 阶段的纹理追加到 textures；录制绘制时用它收集该绘制真正会采样的纹理
+    void getBoundTextures(VkShaderStageFlags stages, std::vector<Texture::Ptr> &textures) const;
+
+    /// 在该帧的 arena 中追加一个物体 uniform，返回它的动态偏移
+    uint32_t pushObject(const ObjectUniform &objectUniform, const int& frameCount);
+
+    /// 绑定描述符集时使用的动态偏移：{ 相机, 物体 }
+    [[nodiscard]] std::vector<uint32_t> getDynamicOffsets(int frameCount, uint32_t objectOffset) const { return { mVPOffsets[frameCount], objectOffset }; }
+
+    [[nodiscard]] std::vector<uint32_t> getDynamicOffsets(int frameCount) const { return getDynamicOffsets(frameCount, mObjectOffsets[frameCount]); }
+
     [[nodiscard]] auto getDescriptorLayout() const { return mDescriptorSetLayout; }
 
     [[nodiscard]] auto getDescriptorSet(int frameCount) const { return mDescriptorSet->getDescriptorSet(frameCount); }
 
+    [[nodiscard]] auto getTextureResidency() const { return mTextureResidency; }
+
 private:
     Wrapper::Device::Ptr mDevice{ nullptr };
 
     std::vector<Wrapper::UniformParameter::Ptr> mUniformParams;
 
+    std::vector<Wrapper::UniformArena::Ptr> mArenas{};
+    std::vector<uint32_t>                   mVPOffsets{};
+    std::vector<uint32_t>                   mObjectOffsets{};
+
+    VkDeviceSize                          mTextureStreamBudget{ 0 };
+    std::vector<std::vector<VkImageView>> mWrittenTextureViews{};  // [帧][参数] 该帧描述符集中写入的视图
+    TextureResidency::Ptr                 mTextureResidency{ nullptr };
+
     Wrapper::DescriptorSetLayout::Ptr mDescriptorSetLayout{ nullptr };
     Wrapper::DescriptorPool::Ptr      mDescriptorPool{ nullptr };
     Wrapper::DescriptorSet::Ptr       mDescriptorSet{ nullptr };
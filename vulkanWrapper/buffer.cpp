@@ -1,29 +1,44 @@
 ﻿#include "buffer.h"
 #include "commandBuffer.h"
-#include"commandPool.h"
+#include "uploadEngine.h"
 
 namespace LearnVulkan::Wrapper
 {
-    Buffer::Ptr Buffer::createVertexBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData)
+    Buffer::Ptr Buffer::createVertexBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, const UploadEngine::Ptr& uploadEngine)
     {
         auto buffer = Buffer::create(device,
                                      size,
                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-        buffer->updateBufferByStage(pData, size);
+        buffer->updateBufferByStage(pData, size, uploadEngine);
 
         return buffer;
     }
 
-    Buffer::Ptr Buffer::createIndexBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData)
+    Buffer::Ptr Buffer::createIndexBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, const UploadEngine::Ptr& uploadEngine)
     {
         auto buffer = Buffer::create(device,
                                      size,
                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-        buffer->updateBufferByStage(pData, size);
+        buffer->updateBufferByStage(pData, size, uploadEngine);
+
+        return buffer;
+    }
+
+    Buffer::Ptr Buffer::createStorageBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, const UploadEngine::Ptr& uploadEngine, VkBufferUsageFlags extraUsage)
+    {
+        auto buffer = Buffer::create(device,
+                                     size,
+                                     VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | extraUsage,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (pData != nullptr)
+        {
+            buffer->updateBufferByStage(pData, size, uploadEngine);
+        }
 
         return buffer;
     }
@@ -37,7 +52,7 @@ namespace LearnVulkan::Wrapper
 
         if (pData != nullptr)
         {
-            buffer->updateBufferByStage(pData, size);
+            buffer->updateBufferByMap(pData, size);
         }
 
         return buffer;
@@ -61,6 +76,7 @@ namespace LearnVulkan::Wrapper
     Buffer::Buffer(const Device::Ptr& device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
     {
         mDevice = device;
+        mUsage  = usage;
 
         VkBufferCreateInfo createInfo{};
         createInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -76,18 +92,10 @@ namespace LearnVulkan::Wrapper
         VkMemoryRequirements memReq{};
         vkGetBufferMemoryRequirements(mDevice->getDevice(), mBuffer, &memReq);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memReq.size;
-
-        allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(mDevice->getDevice(), &allocInfo, nullptr, &mBufferMemory) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Error: failed to allocate memory!");
-        }
+        // 从设备的分配器子分配，绑定到大块内的偏移处
+        mAllocation = mDevice->getAllocator()->allocate(memReq, properties, true);
 
-        vkBindBufferMemory(mDevice->getDevice(), mBuffer, mBufferMemory, 0);
+        vkBindBufferMemory(mDevice->getDevice(), mBuffer, mAllocation.mMemory, mAllocation.mOffset);
 
         mBufferInfo.buffer = mBuffer;
         mBufferInfo.offset = 0;
@@ -101,68 +109,55 @@ namespace LearnVulkan::Wrapper
             vkDestroyBuffer(mDevice->getDevice(), mBuffer, nullptr);
         }
 
-        if (mBufferMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(mDevice->getDevice(), mBufferMemory, nullptr);
-        }
+        mDevice->getAllocator()->free(mAllocation);
     }
 
-    uint32_t Buffer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+    void Buffer::updateBufferByMap(void* data, size_t size)
     {
-        VkPhysicalDeviceMemoryProperties memProps;
-        vkGetPhysicalDeviceMemoryProperties(mDevice->getPhysicalDevice(), &memProps);
-
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
+        // HOST_VISIBLE 的大块在分配器里常驻映射，这里直接写入，无需 vkMapMemory / vkUnmapMemory
+        if (mAllocation.mMappedData == nullptr)
         {
-            if ((typeFilter & (1 << i)) && ((memProps.memoryTypes[i].propertyFlags & properties) == properties))
-            {
-                return i;
-            }
+            throw std::runtime_error("Error: buffer memory is not host visible!");
         }
 
-        throw std::runtime_error("Error: cannot find the property memory type!");
+        memcpy(mAllocation.mMappedData, data, size);
     }
 
-    void Buffer::updateBufferByMap(void* data, size_t size)
-    {
-        void* memPtr = nullptr;
-
-        vkMapMemory(mDevice->getDevice(), mBufferMemory, 0, size, 0, &memPtr);
-
-        memcpy(memPtr, data, size);
-
-        vkUnmapMemory(mDevice->getDevice(), mBufferMemory);
-    }
-
-    void Buffer::updateBufferByStage(void* data, size_t size)
+    void Buffer::updateBufferByStage(const void* data, size_t size, const UploadEngine::Ptr& uploadEngine)
     {
-        auto stageBuffer = Buffer::create(mDevice,
-                                          size,
-                                          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        stageBuffer->updateBufferByMap(data, size);
-
-        copyBuffer(stageBuffer->getBuffer(), mBuffer, static_cast<VkDeviceSize>(size));
-
-    }
+        // 根据用途确定图形队列上第一次读取的阶段，渲染提交只在这些阶段等待上传完成
+        VkPipelineStageFlags dstStage  = 0;
+        VkAccessFlags        dstAccess = 0;
 
-    void Buffer::copyBuffer(const VkBuffer& srcBuffer, const VkBuffer& dstBuffer, VkDeviceSize size)
-    {
-        auto commandPool   = CommandPool::create(mDevice);
-        auto commandBuffer = CommandBuffer::create(mDevice, commandPool);
+        if (mUsage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+        {
+            dstStage  |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+            dstAccess |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        }
 
-        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        if (mUsage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+        {
+            dstStage  |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+            dstAccess |= VK_ACCESS_INDEX_READ_BIT;
+        }
 
-        VkBufferCopy copyInfo{};
-        copyInfo.size = size;
+        if (mUsage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+        {
+            dstStage  |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+            dstAccess |= VK_ACCESS_SHADER_READ_BIT;
+        }
 
-        commandBuffer->copyBufferToBuffer(srcBuffer,
-                                          dstBuffer,
-                                          1,
-                                          { copyInfo });
-        commandBuffer->end();
+        if (dstStage == 0)
+        {
+            dstStage  = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            dstAccess = VK_ACCESS_MEMORY_READ_BIT;
+        }
 
-        commandBuffer->submitSync(mDevice->getGraphicQueue(), VK_NULL_HANDLE);
+        uploadEngine->uploadBuffer(mBuffer,
+                                   0,
+                                   data,
+                                   static_cast<VkDeviceSize>(size),
+                                   dstStage,
+                                   dstAccess);
     }
 }
@@ -5,6 +5,8 @@
 
 namespace LearnVulkan::Wrapper
 {
+    class UploadEngine;
+
     class Buffer
     {
     public:
@@ -15,9 +17,12 @@ namespace LearnVulkan::Wrapper
         }
 
     public:
-        static Ptr createVertexBuffer(const Device::Ptr& device, VkDeviceSize size, void * pData);
+        static Ptr createVertexBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, const std::shared_ptr<UploadEngine>& uploadEngine);
+
+        static Ptr createIndexBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, const std::shared_ptr<UploadEngine>& uploadEngine);
 
-        static Ptr createIndexBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData);
+        /// 设备本地的存储缓冲，extraUsage 可附加顶点 / 间接参数等用途；pData 为空时不上传
+        static Ptr createStorageBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, const std::shared_ptr<UploadEngine>& uploadEngine, VkBufferUsageFlags extraUsage = 0);
 
         static Ptr createUniformBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData = nullptr);
 
@@ -30,20 +35,19 @@ namespace LearnVulkan::Wrapper
 
         void updateBufferByMap(void *data, size_t size);
 
-        void updateBufferByStage(void* data, size_t size);
-
-        void copyBuffer(const VkBuffer& srcBuffer, const VkBuffer& dstBuffer, VkDeviceSize size);
+        /// 数据写入上传引擎的暂存环，在传输队列上异步拷贝，随 UploadEngine::flush() 一起提交
+        void updateBufferByStage(const void* data, size_t size, const std::shared_ptr<UploadEngine>& uploadEngine);
 
         [[nodiscard]] auto getBuffer() const { return mBuffer; }
 
         [[nodiscard]] VkDescriptorBufferInfo& getBufferInfo() { return mBufferInfo; }
 
-    private:
-        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+        [[nodiscard]] const auto& getAllocation() const { return mAllocation; }
 
     private:
         VkBuffer               mBuffer{ VK_NULL_HANDLE };
-        VkDeviceMemory         mBufferMemory{ VK_NULL_HANDLE };
+        VkBufferUsageFlags     mUsage{ 0 };
+        MemoryAllocation       mAllocation{};
         Device::Ptr            mDevice{ nullptr };
         VkDescriptorBufferInfo mBufferInfo{};
     };
@@ -59,21 +59,46 @@ namespace LearnVulkan::Wrapper
         vkCmdBindVertexBuffers(mCommandBuffer, 0, static_cast<uint32_t>(buffers.size()), buffers.data(), offsets.data());
     }
 
-    void CommandBuffer::bindIndexBuffer(const VkBuffer& buffer)
+    void CommandBuffer::bindIndexBuffer(const VkBuffer& buffer, VkIndexType indexType)
     {
-        vkCmdBindIndexBuffer(mCommandBuffer, buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(mCommandBuffer, buffer, 0, indexType);
     }
 
-    void CommandBuffer::bindDescriptorSet(const VkPipelineLayout layout, const VkDescriptorSet& descriptorSet)
+    void CommandBuffer::bindComputePipeline(const VkPipeline& pipeline)
+    {
+        vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    }
+
+    void CommandBuffer::bindDescriptorSet(const VkPipelineLayout layout, const VkDescriptorSet& descriptorSet, const std::vector<uint32_t>& dynamicOffsets)
+    {
+        bindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, layout, descriptorSet, dynamicOffsets);
+    }
+
+    void CommandBuffer::bindDescriptorSet(VkPipelineBindPoint bindPoint, const VkPipelineLayout layout, const VkDescriptorSet& descriptorSet, const std::vector<uint32_t>& dynamicOffsets)
     {
         vkCmdBindDescriptorSets(mCommandBuffer,
-                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                bindPoint,
                                 layout,
-                                0,               // 第一个描述符集
-                                1,               // 描述符集数量
+                                0,                                              // 第一个描述符集
+                                1,                                              // 描述符集数量
                                 &descriptorSet,
-                                0,               // 动态偏移量数量
-                                nullptr);        // 动态偏移数组
+                                static_cast<uint32_t>(dynamicOffsets.size()),   // 动态偏移量数量
+                                dynamicOffsets.data());                         // 动态偏移数组
+    }
+
+    void CommandBuffer::pushConstants(const VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* pValues)
+    {
+        vkCmdPushConstants(mCommandBuffer, layout, stageFlags, offset, size, pValues);
+    }
+
+    void CommandBuffer::setViewport(const VkViewport& viewport)
+    {
+        vkCmdSetViewport(mCommandBuffer, 0, 1, &viewport);
+    }
+
+    void CommandBuffer::setScissor(const VkRect2D& scissor)
+    {
+        vkCmdSetScissor(mCommandBuffer, 0, 1, &scissor);
     }
 
     void CommandBuffer::draw(size_t vertexCount)
@@ -85,14 +110,77 @@ namespace LearnVulkan::Wrapper
                   0);
     }
 
-    void CommandBuffer::drawIndex(size_t indexCount)
+    void CommandBuffer::drawIndex(size_t indexCount, uint32_t instanceCount, uint32_t firstInstance)
     {
         vkCmdDrawIndexed(mCommandBuffer,
-                         indexCount,  // 索引数量
-                         1,           // 实例数量
-                         0,           // 首个索引偏移
-                         0,           // 顶点偏移
-                         0);          // 首个实例索引
+                         static_cast<uint32_t>(indexCount),  // 索引数量
+                         instanceCount,                      // 实例数量
+                         0,                                  // 首个索引偏移
+                         0,                                  // 顶点偏移
+                         firstInstance);                     // 首个实例索引
+    }
+
+    void CommandBuffer::drawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+    {
+        vkCmdDrawIndexedIndirect(mCommandBuffer, buffer, offset, drawCount, stride);
+    }
+
+    void CommandBuffer::drawIndexedIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countOffset, uint32_t maxDrawCount, uint32_t stride)
+    {
+        vkCmdDrawIndexedIndirectCount(mCommandBuffer, buffer, offset, countBuffer, countOffset, maxDrawCount, stride);
+    }
+
+    void CommandBuffer::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+    {
+        vkCmdDispatch(mCommandBuffer, groupCountX, groupCountY, groupCountZ);
+    }
+
+    void CommandBuffer::dispatchIndirect(VkBuffer buffer, VkDeviceSize offset)
+    {
+        vkCmdDispatchIndirect(mCommandBuffer, buffer, offset);
+    }
+
+    void CommandBuffer::fillBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, uint32_t data)
+    {
+        vkCmdFillBuffer(mCommandBuffer, buffer, offset, size, data);
+    }
+
+    void CommandBuffer::bufferMemoryBarrier(VkBuffer buffer,
+                                            VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                                            VkPipelineStageFlags dstStage, VkAccessFlags dstAccess,
+                                            VkDeviceSize offset, VkDeviceSize size)
+    {
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask       = srcAccess;
+        barrier.dstAccessMask       = dstAccess;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer              = buffer;
+        barrier.offset              = offset;
+        barrier.size                = size;
+
+        vkCmdPipelineBarrier(mCommandBuffer, srcStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+
+    void CommandBuffer::resetQueryPool(VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount)
+    {
+        vkCmdResetQueryPool(mCommandBuffer, queryPool, firstQuery, queryCount);
+    }
+
+    void CommandBuffer::beginQuery(VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags)
+    {
+        vkCmdBeginQuery(mCommandBuffer, queryPool, query, flags);
+    }
+
+    void CommandBuffer::endQuery(VkQueryPool queryPool, uint32_t query)
+    {
+        vkCmdEndQuery(mCommandBuffer, queryPool, query);
+    }
+
+    void CommandBuffer::writeTimestamp(VkPipelineStageFlagBits stage, VkQueryPool queryPool, uint32_t query)
+    {
+        vkCmdWriteTimestamp(mCommandBuffer, stage, queryPool, query);
     }
 
     void CommandBuffer::endRenderPass()
@@ -100,6 +188,11 @@ namespace LearnVulkan::Wrapper
         vkCmdEndRenderPass(mCommandBuffer);
     }
 
+    void CommandBuffer::executeCommands(const std::vector<VkCommandBuffer>& commandBuffers)
+    {
+        vkCmdExecuteCommands(mCommandBuffer, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+    }
+
     void CommandBuffer::end()
     {
         if (vkEndCommandBuffer(mCommandBuffer) != VK_SUCCESS)
@@ -113,13 +206,13 @@ namespace LearnVulkan::Wrapper
         vkCmdCopyBuffer(mCommandBuffer, srcBuffer, dstBuffer, copyInfoCount, copyInfos.data());
     }
 
-    void CommandBuffer::copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t width, uint32_t height)
+    void CommandBuffer::copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t width, uint32_t height, VkDeviceSize bufferOffset)
     {
         // 定义缓冲区到图像的复制区域描述结构体（Vulkan API核心结构）
         VkBufferImageCopy region{};
 
-        // 缓冲区数据起始偏移量（从缓冲区的第0字节开始复制）
-        region.bufferOffset = 0;
+        // 缓冲区数据起始偏移量（暂存环内的子分配从 bufferOffset 处开始）
+        region.bufferOffset = bufferOffset;
 
         // 缓冲区数据的"行长度"（单位：字节）：
         // 0表示缓冲区中的数据是**紧密排列**的（无额外行间距），Vulkan会自动根据图像格式计算实际行宽
@@ -157,6 +250,32 @@ namespace LearnVulkan::Wrapper
                                &region);
     }
 
+    void CommandBuffer::copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, const std::vector<VkBufferImageCopy>& regions)
+    {
+        vkCmdCopyBufferToImage(mCommandBuffer, srcBuffer, dstImage, dstImageLayout, static_cast<uint32_t>(regions.size()), regions.data());
+    }
+
+    void CommandBuffer::blitImage(VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, const VkImageBlit& region, VkFilter filter)
+    {
+        vkCmdBlitImage(mCommandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, 1, &region, filter);
+    }
+
+    void CommandBuffer::copyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, uint32_t width, uint32_t height, VkDeviceSize bufferOffset)
+    {
+        VkBufferImageCopy region{};
+        region.bufferOffset                    = bufferOffset;
+        region.bufferRowLength                 = 0;
+        region.bufferImageHeight               = 0;
+        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel       = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount     = 1;
+        region.imageOffset                     = { 0, 0, 0 };
+        region.imageExtent                     = { width, height, 1 };
+
+        vkCmdCopyImageToBuffer(mCommandBuffer, srcImage, srcImageLayout, dstBuffer, 1, &region);
+    }
+
     void CommandBuffer::transferImageLayout(const VkImageMemoryBarrier& imageMemoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
     {
         vkCmdPipelineBarrier(mCommandBuffer,
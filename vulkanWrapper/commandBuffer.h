@@ -26,23 +26,77 @@ namespace LearnVulkan::Wrapper
 
         void bindGraphicPipeline(const VkPipeline &pipeline);
 
+        void bindComputePipeline(const VkPipeline &pipeline);
+
         void bindVertexBuffer(const std::vector<VkBuffer> &buffers);
 
-        void bindIndexBuffer(const VkBuffer &buffer);
+        void bindIndexBuffer(const VkBuffer &buffer, VkIndexType indexType = VK_INDEX_TYPE_UINT32);
+
+        /// dynamicOffsets 按绑定号顺序对应集合中的 UNIFORM_BUFFER_DYNAMIC
+        void bindDescriptorSet(const VkPipelineLayout layout, const VkDescriptorSet &descriptorSet, const std::vector<uint32_t> &dynamicOffsets = {});
+
+        /// 指定绑定点的版本，计算管线使用 VK_PIPELINE_BIND_POINT_COMPUTE
+        void bindDescriptorSet(VkPipelineBindPoint bindPoint, const VkPipelineLayout layout, const VkDescriptorSet &descriptorSet, const std::vector<uint32_t> &dynamicOffsets = {});
+
+        void pushConstants(const VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void *pValues);
+
+        void setViewport(const VkViewport &viewport);
 
-        void bindDescriptorSet(const VkPipelineLayout layout, const VkDescriptorSet &descriptorSet);
+        void setScissor(const VkRect2D &scissor);
 
         void draw(size_t vertexCount);
 
-        void drawIndex(size_t indexCount);
+        /// firstInstance 同时决定实例顶点绑定从哪一个实例数据开始读取
+        void drawIndex(size_t indexCount, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+
+        /// 间接绘制参数来自 buffer，drawCount 个 VkDrawIndexedIndirectCommand 依次相隔 stride 字节
+        void drawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
+
+        /// 实际绘制数量由 GPU 写入 countBuffer，不超过 maxDrawCount（Vulkan 1.2 drawIndirectCount 特性）
+        void drawIndexedIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countOffset, uint32_t maxDrawCount, uint32_t stride);
+
+        void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+        /// 工作组数量来自 buffer 中 offset 处的 VkDispatchIndirectCommand，可由前一个计算通道写入
+        void dispatchIndirect(VkBuffer buffer, VkDeviceSize offset = 0);
+
+        void fillBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, uint32_t data);
+
+        /// 缓冲区内存屏障，同一队列族内使用
+        void bufferMemoryBarrier(VkBuffer buffer,
+                                 VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                                 VkPipelineStageFlags dstStage, VkAccessFlags dstAccess,
+                                 VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+        /// 查询在使用前必须在命令缓冲中重置，且不能在渲染通道内重置
+        void resetQueryPool(VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount);
+
+        void beginQuery(VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags = 0);
+
+        void endQuery(VkQueryPool queryPool, uint32_t query);
+
+        /// stage 之前的命令全部完成后把 GPU 时间戳写入 query
+        void writeTimestamp(VkPipelineStageFlagBits stage, VkQueryPool queryPool, uint32_t query);
 
         void endRenderPass();
 
+        /// 在主命令缓冲中执行二级命令缓冲，需在以 SECONDARY_COMMAND_BUFFERS 方式开始的渲染通道内调用
+        void executeCommands(const std::vector<VkCommandBuffer>& commandBuffers);
+
         void end();
 
         void copyBufferToBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t copyInfoCount, const std::vector<VkBufferCopy>& copyInfos);
 
-        void copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t width, uint32_t height);
+        void copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t width, uint32_t height, VkDeviceSize bufferOffset = 0);
+
+        /// 一次调用拷贝多个子资源（例如整条 mip 链），每个区域自带缓冲偏移与目标级别
+        void copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, const std::vector<VkBufferImageCopy>& regions);
+
+        /// 需要图形能力的队列；LINEAR 过滤要求格式支持 SAMPLED_IMAGE_FILTER_LINEAR
+        void blitImage(VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, const VkImageBlit& region, VkFilter filter = VK_FILTER_LINEAR);
+
+        /// 把颜色图像第 0 级紧密排列地拷进缓冲区（读回用）
+        void copyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, uint32_t width, uint32_t height, VkDeviceSize bufferOffset = 0);
 
         void transferImageLayout(const VkImageMemoryBarrier& imageMemoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask);
 
@@ -2,13 +2,14 @@
 
 namespace LearnVulkan::Wrapper
 {
-    CommandPool::CommandPool(const Device::Ptr& device, VkCommandPoolCreateFlagBits flag)
+    CommandPool::CommandPool(const Device::Ptr& device, VkCommandPoolCreateFlags flag, std::optional<uint32_t> queueFamilyIndex)
     {
-        mDevice = device;
+        mDevice           = device;
+        mQueueFamilyIndex = queueFamilyIndex.value_or(device->getGraphicQueueFamily().value());
 
         VkCommandPoolCreateInfo createInfo{};
         createInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        createInfo.queueFamilyIndex = device->getGraphicQueueFamily().value();
+        createInfo.queueFamilyIndex = mQueueFamilyIndex;
         createInfo.flags            = flag;
 
         if (vkCreateCommandPool(mDevice->getDevice(), &createInfo, nullptr, &mCommandPool) != VK_SUCCESS)
@@ -24,4 +25,12 @@ namespace LearnVulkan::Wrapper
             vkDestroyCommandPool(mDevice->getDevice(), mCommandPool, nullptr);
         }
     }
+
+    void CommandPool::reset(VkCommandPoolResetFlags flags)
+    {
+        if (vkResetCommandPool(mDevice->getDevice(), mCommandPool, flags) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to reset command pool!");
+        }
+    }
 }
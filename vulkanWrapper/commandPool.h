@@ -10,19 +10,29 @@ namespace LearnVulkan::Wrapper
     public:
         using Ptr = std::shared_ptr<CommandPool>;
 
-        static Ptr create(const Device::Ptr& device, VkCommandPoolCreateFlagBits flag = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
+        /// queueFamilyIndex 缺省为图形队列族
+        static Ptr create(const Device::Ptr& device,
+                          VkCommandPoolCreateFlags flag = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                          std::optional<uint32_t> queueFamilyIndex = std::nullopt)
         {
-            return std::make_shared<CommandPool>(device, flag); 
+            return std::make_shared<CommandPool>(device, flag, queueFamilyIndex); 
         }
 
-        CommandPool(const Device::Ptr &device, VkCommandPoolCreateFlagBits flag = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+        CommandPool(const Device::Ptr &device,
+                    VkCommandPoolCreateFlags flag = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                    std::optional<uint32_t> queueFamilyIndex = std::nullopt);
 
         ~CommandPool();
 
-        [[nodiscard]] auto getCommandPool() const { return mCommandPool; }
+        /// 一次性把池中所有命令缓冲回到初始状态，调用方需保证它们都已执行完毕
+        void reset(VkCommandPoolResetFlags flags = 0);
+
+        [[nodiscard]] auto getCommandPool()      const { return mCommandPool; }
+        [[nodiscard]] auto getQueueFamilyIndex() const { return mQueueFamilyIndex; }
 
     private:
         VkCommandPool mCommandPool{ VK_NULL_HANDLE };
+        uint32_t      mQueueFamilyIndex{ 0 };
         Device::Ptr   mDevice{ nullptr };
     };
 }
\ No newline at end of file
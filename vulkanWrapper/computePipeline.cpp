@@ -0,0 +1,80 @@
+﻿#include "computePipeline.h"
+
+namespace LearnVulkan::Wrapper
+{
+    ComputePipeline::ComputePipeline(const Device::Ptr& device)
+    {
+        mDevice = device;
+
+        mLayoutState.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    }
+
+    ComputePipeline::~ComputePipeline()
+    {
+        if (mLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(mDevice->getDevice(), mLayout, nullptr);
+        }
+
+        if (mPipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(mDevice->getDevice(), mPipeline, nullptr);
+        }
+    }
+
+    void ComputePipeline::build()
+    {
+        if (mShader == nullptr || mShader->getShaderStage() != VK_SHADER_STAGE_COMPUTE_BIT)
+        {
+            throw std::runtime_error("Error: compute pipeline needs a compute shader!");
+        }
+
+        if (mLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(mDevice->getDevice(), mLayout, nullptr);
+            mLayout = VK_NULL_HANDLE;
+        }
+
+        if (mSharedLayout == VK_NULL_HANDLE &&
+            vkCreatePipelineLayout(mDevice->getDevice(), &mLayoutState, nullptr, &mLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to create compute pipeline layout!");
+        }
+
+        VkComputePipelineCreateInfo pipelineCreateInfo{};
+        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+
+        pipelineCreateInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineCreateInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineCreateInfo.stage.module = mShader->getShaderModule();
+        pipelineCreateInfo.stage.pName  = mShader->getShaderEntryPoint().c_str();
+
+        pipelineCreateInfo.layout = getLayout();
+
+        pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+        pipelineCreateInfo.basePipelineIndex  = -1;
+
+        if (mPipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(mDevice->getDevice(), mPipeline, nullptr);
+        }
+
+        const auto& pipelineCache = mDevice->getPipelineCache();
+
+        VkPipelineCreationFeedbackEXT           feedback{};
+        VkPipelineCreationFeedbackCreateInfoEXT feedbackInfo{};
+        pipelineCache->attachFeedback(pipelineCreateInfo.pNext, feedbackInfo, feedback);
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        if (vkCreateComputePipelines(mDevice->getDevice(), pipelineCache->getCache(), 1, &pipelineCreateInfo, nullptr, &mPipeline) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to create compute pipeline!");
+        }
+
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        bool   warm         = pipelineCache->recordBuild(milliseconds, feedback);
+
+        std::cout << "ComputePipeline: built in " << milliseconds << " ms (" << (warm ? "warm" : "cold") << " cache, by " << pipelineCache->getWarmCriterion() << ")" << std::endl;
+    }
+}
@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include "base.h"
+#include "device.h"
+#include "shader.h"
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // 计算管线：一个计算着色器 + 管线布局
+    // 与图形管线一样经由设备级 PipelineCache 创建；布局可以由 mLayoutState 自建，
+    // 也可以借用另一条（图形或计算）管线的布局，使两者的描述符集与推送常量可以互相沿用
+    // ==================================================================
+    class ComputePipeline
+    {
+    public:
+        using Ptr = std::shared_ptr<ComputePipeline>;
+
+        static Ptr create(const Device::Ptr& device)
+        {
+            return std::make_shared<ComputePipeline>(device);
+        }
+
+        ComputePipeline(const Device::Ptr& device);
+
+        ~ComputePipeline();
+
+        void setShader(const Shader::Ptr& shader) { mShader = shader; }
+
+        /// 借用已有的管线布局，build 时不再根据 mLayoutState 创建；布局由原管线负责销毁，须比本管线活得久
+        void setLayout(VkPipelineLayout layout) { mSharedLayout = layout; }
+
+        void build();
+
+    public:
+        VkPipelineLayoutCreateInfo mLayoutState{};
+
+    public:
+        [[nodiscard]] auto getPipeline() const { return mPipeline; }
+        [[nodiscard]] auto getLayout()   const { return mSharedLayout != VK_NULL_HANDLE ? mSharedLayout : mLayout; }
+
+    private:
+        VkPipeline       mPipeline{ VK_NULL_HANDLE };
+        VkPipelineLayout mLayout{ VK_NULL_HANDLE };
+        VkPipelineLayout mSharedLayout{ VK_NULL_HANDLE };
+        Device::Ptr      mDevice{ nullptr };
+        Shader::Ptr      mShader{ nullptr };
+    };
+}
@@ -0,0 +1,130 @@
+﻿#include "cpuProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace LearnVulkan::Wrapper
+{
+    std::mutex                                              CpuProfiler::sRegistryMutex;
+    std::vector<std::shared_ptr<CpuProfiler::ThreadBuffer>> CpuProfiler::sThreadBuffers;
+
+    int64_t CpuProfiler::now()
+    {
+        static const auto origin = std::chrono::steady_clock::now();
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    CpuProfiler::ThreadBuffer& CpuProfiler::getThreadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+
+        if (buffer == nullptr)
+        {
+            auto created = std::make_shared<ThreadBuffer>();
+
+            std::lock_guard<std::mutex> lock(sRegistryMutex);
+
+            created->mThreadId = static_cast<uint32_t>(sThreadBuffers.size() + 1);
+            created->mName     = "Thread " + std::to_string(created->mThreadId);
+
+            sThreadBuffers.push_back(created);
+            buffer = created.get();
+        }
+
+        return *buffer;
+    }
+
+    void CpuProfiler::record(const char* name, int64_t start, int64_t end)
+    {
+        auto& buffer = getThreadBuffer();
+
+        uint64_t index = buffer.mWriteCount.load(std::memory_order_relaxed);
+
+        auto& event     = buffer.mEvents[index % CAPACITY];
+        event.mName     = name;
+        event.mStart    = start;
+        event.mDuration = end - start;
+
+        buffer.mWriteCount.store(index + 1, std::memory_order_release);
+    }
+
+    void CpuProfiler::setThreadName(const std::string& name)
+    {
+        auto& buffer = getThreadBuffer();
+
+        std::lock_guard<std::mutex> lock(sRegistryMutex);
+        buffer.mName = name;
+    }
+
+    // 名字里只可能出现普通标识符，这里仍然转义引号和反斜杠，保证输出是合法 JSON
+    static void writeJsonString(std::ofstream& file, const std::string& text)
+    {
+        file << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                file << '\\';
+            }
+            file << c;
+        }
+        file << '"';
+    }
+
+    bool CpuProfiler::exportChromeTrace(const std::string& path)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers{};
+        {
+            std::lock_guard<std::mutex> lock(sRegistryMutex);
+            buffers = sThreadBuffers;
+        }
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        bool first = true;
+
+        for (const auto& buffer : buffers)
+        {
+            std::string threadName{};
+            {
+                std::lock_guard<std::mutex> lock(sRegistryMutex);
+                threadName = buffer->mName;
+            }
+
+            file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->mThreadId
+                 << ",\"args\":{\"name\":";
+            writeJsonString(file, threadName);
+            file << "}}";
+            first = false;
+
+            // 环形缓冲只保留最近 CAPACITY 个事件
+            uint64_t writeCount = buffer->mWriteCount.load(std::memory_order_acquire);
+            uint64_t begin      = writeCount > CAPACITY ? writeCount - CAPACITY : 0;
+
+            for (uint64_t i = begin; i < writeCount; ++i)
+            {
+                const auto& event = buffer->mEvents[i % CAPACITY];
+
+                // trace_event 的时间单位是微秒，保留小数以免短区间被截成 0
+                file << ",\n{\"name\":";
+                writeJsonString(file, event.mName != nullptr ? event.mName : "");
+                file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->mThreadId
+                     << ",\"ts\":" << event.mStart / 1000 << "." << std::max<int64_t>(event.mStart % 1000, 0) / 100
+                     << ",\"dur\":" << event.mDuration / 1000 << "." << std::max<int64_t>(event.mDuration % 1000, 0) / 100
+                     << "}";
+            }
+        }
+
+        file << "\n]}\n";
+
+        return static_cast<bool>(file);
+    }
+}
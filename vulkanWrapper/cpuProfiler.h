@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ==================================================================
+// CPU 作用域计时（Chrome trace_event 格式导出）
+// 由编译开关 BONA_CPU_PROFILER 控制（CMake 选项同名），关闭时下面的宏展开为空，不产生任何代码
+//
+// CPU_PROFILE_ZONE("name")        在当前作用域结束时记录一个区间，name 必须是字符串字面量（只保存指针）
+// CPU_PROFILE_THREAD("name")      给当前线程起名，导出时显示为 trace 中的线程名
+// ==================================================================
+#ifndef BONA_CPU_PROFILER
+#define BONA_CPU_PROFILER 0
+#endif
+
+#define BONA_PROFILE_CONCAT_IMPL(a, b) a##b
+#define BONA_PROFILE_CONCAT(a, b) BONA_PROFILE_CONCAT_IMPL(a, b)
+
+#if BONA_CPU_PROFILER
+#define CPU_PROFILE_ZONE(name) ::LearnVulkan::Wrapper::CpuProfileZone BONA_PROFILE_CONCAT(cpuProfileZone, __LINE__)(name)
+#define CPU_PROFILE_THREAD(name) ::LearnVulkan::Wrapper::CpuProfiler::setThreadName(name)
+#else
+#define CPU_PROFILE_ZONE(name) ((void)0)
+#define CPU_PROFILE_THREAD(name) ((void)0)
+#endif
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // 每个线程一个固定容量的事件环形缓冲，只由所属线程写入，写入路径无锁、无分配：
+    // 写完事件后以 release 语义推进写计数，导出时以 acquire 读取计数再拷贝最近 CAPACITY 个事件。
+    // 线程第一次记录时在全局列表中注册一次（只有这里加锁），缓冲由列表持有，线程退出后仍可导出
+    // ==================================================================
+    class CpuProfiler
+    {
+    public:
+        static constexpr uint32_t CAPACITY = 1u << 16;
+
+        struct Event
+        {
+            const char* mName{ nullptr };
+            int64_t     mStart{ 0 };      // 纳秒，相对 CpuProfiler 的起始时间
+            int64_t     mDuration{ 0 };
+        };
+
+        struct ThreadBuffer
+        {
+            std::vector<Event>    mEvents = std::vector<Event>(CAPACITY);
+            std::atomic<uint64_t> mWriteCount{ 0 };
+            std::string           mName{};
+            uint32_t              mThreadId{ 0 };
+        };
+
+        /// 当前时间（纳秒，相对程序中第一次使用分析器的时刻）
+        static int64_t now();
+
+        static void record(const char* name, int64_t start, int64_t end);
+
+        static void setThreadName(const std::string& name);
+
+        /// 导出为 Chrome trace_event JSON（chrome://tracing、Perfetto 可直接打开）；
+        /// 其他线程仍在记录时，正在被覆盖的旧事件可能不完整，最好在各线程空闲时调用
+        static bool exportChromeTrace(const std::string& path);
+
+        /// 编译时是否开启
+        static constexpr bool isEnabled() { return BONA_CPU_PROFILER != 0; }
+
+    private:
+        static ThreadBuffer& getThreadBuffer();
+
+        static std::mutex                                 sRegistryMutex;
+        static std::vector<std::shared_ptr<ThreadBuffer>> sThreadBuffers;
+    };
+
+    /// 构造时记下开始时间，析构时写入事件
+    class CpuProfileZone
+    {
+    public:
+        explicit CpuProfileZone(const char* name) : mName(name), mStart(CpuProfiler::now()) {}
+
+        ~CpuProfileZone() { CpuProfiler::record(mName, mStart, CpuProfiler::now()); }
+
+        CpuProfileZone(const CpuProfileZone&) = delete;
+        CpuProfileZone& operator=(const CpuProfileZone&) = delete;
+
+    private:
+        const char* mName{ nullptr };
+        int64_t     mStart{ 0 };
+    };
+}
@@ -18,28 +18,39 @@ namespace LearnVulkan::Wrapper
 
     void DescriptorPool::build(std::vector<UniformParameter::Ptr>& params, const int& frameCount)
     {
-        int uniformBufferCount = 0;
-        int textureCount       = 0;
+        int uniformBufferCount        = 0;
+        int dynamicUniformBufferCount = 0;
+        int storageBufferCount        = 0;
+        int textureCount              = 0;
 
         for (const auto& param : params)
         {
             if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) { uniformBufferCount++; }
+            if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) { dynamicUniformBufferCount++; }
+            if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) { storageBufferCount++; }
             if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) { textureCount++; }
 
             // 注：可扩展支持更多描述符类型
         }
 
+        // descriptorCount 为 0 的条目不合法，只加入实际用到的类型
         std::vector<VkDescriptorPoolSize> poolSizes{};
 
-        VkDescriptorPoolSize uniformBufferSize{};
-        uniformBufferSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uniformBufferSize.descriptorCount = uniformBufferCount * frameCount;
-        poolSizes.push_back(uniformBufferSize);
+        auto addPoolSize = [&poolSizes, frameCount](VkDescriptorType type, int count)
+        {
+            if (count > 0)
+            {
+                VkDescriptorPoolSize poolSize{};
+                poolSize.type            = type;
+                poolSize.descriptorCount = static_cast<uint32_t>(count * frameCount);
+                poolSizes.push_back(poolSize);
+            }
+        };
 
-        VkDescriptorPoolSize textureSize{};
-        textureSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        textureSize.descriptorCount = textureCount * frameCount;
-        poolSizes.push_back(textureSize);
+        addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, uniformBufferCount);
+        addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, dynamicUniformBufferCount);
+        addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBufferCount);
+        addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureCount);
 
         VkDescriptorPoolCreateInfo createInfo{};
         createInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
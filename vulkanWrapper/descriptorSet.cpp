@@ -29,6 +29,10 @@ namespace LearnVulkan::Wrapper
         {
             std::vector<VkWriteDescriptorSet> descriptorSetWrites{};
 
+            // 动态 uniform 的范围是单个元素而不是整个 arena，需要在写入完成前保持有效
+            std::vector<VkDescriptorBufferInfo> dynamicBufferInfos{};
+            dynamicBufferInfos.reserve(params.size());
+
             for (const auto& param : params)
             {
                 VkWriteDescriptorSet descriptorSetWrite{};
@@ -39,11 +43,23 @@ namespace LearnVulkan::Wrapper
                 descriptorSetWrite.descriptorCount = param->mCount;
                 descriptorSetWrite.dstBinding      = param->mBinding;
 
-                if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+                if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+                    param->mDescriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
                 {
                     descriptorSetWrite.pBufferInfo = &param->mBuffers[i]->getBufferInfo();
                 }
 
+                if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+                {
+                    VkDescriptorBufferInfo bufferInfo{};
+                    bufferInfo.buffer = param->mBuffers[i]->getBuffer();
+                    bufferInfo.offset = 0;
+                    bufferInfo.range  = param->mSize;
+
+                    dynamicBufferInfos.push_back(bufferInfo);
+                    descriptorSetWrite.pBufferInfo = &dynamicBufferInfos.back();
+                }
+
                 if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
                 {
                     descriptorSetWrite.pImageInfo = &param->mTexture->getImageInfo();
@@ -61,4 +77,18 @@ namespace LearnVulkan::Wrapper
     }
 
     DescriptorSet::~DescriptorSet() {}
+
+    void DescriptorSet::updateImage(int frameCount, uint32_t binding, const VkDescriptorImageInfo& imageInfo)
+    {
+        VkWriteDescriptorSet descriptorSetWrite{};
+        descriptorSetWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorSetWrite.dstSet          = mDescriptorSets[frameCount];
+        descriptorSetWrite.dstBinding      = binding;
+        descriptorSetWrite.dstArrayElement = 0;
+        descriptorSetWrite.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorSetWrite.descriptorCount = 1;
+        descriptorSetWrite.pImageInfo      = &imageInfo;
+
+        vkUpdateDescriptorSets(mDevice->getDevice(), 1, &descriptorSetWrite, 0, nullptr);
+    }
 }
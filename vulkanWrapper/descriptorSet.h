@@ -35,6 +35,9 @@ namespace LearnVulkan::Wrapper
 
         [[nodiscard]] auto getDescriptorSet(int frameCount) const { return mDescriptorSets[frameCount]; }
 
+        /// 重写某一帧的图像采样器绑定（例如流式纹理换用新视图）；调用方需保证该帧的描述符集不在 GPU 上使用
+        void updateImage(int frameCount, uint32_t binding, const VkDescriptorImageInfo& imageInfo);
+
     private:
         std::vector<VkDescriptorSet> mDescriptorSets{};
         Device::Ptr                  mDevice{ nullptr };
@@ -1,18 +1,28 @@
 ﻿#include "device.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
 namespace LearnVulkan::Wrapper
 {
-    Device::Device(Instance::Ptr& instance, WindowSurface::Ptr& surface)
+    Device::Device(Instance::Ptr& instance, WindowSurface::Ptr& surface, const std::string& deviceSelector)
     {
         mInstance = instance;
         mSurface = surface;
+        mDeviceSelector = deviceSelector;
         pickPhysicalDevice();
         initQueueFamilies(mPhysicalDevice);
         createLogicalDevice();
+
+        mAllocator = MemoryAllocator::create(mDevice, mPhysicalDevice, mMemoryBudget);
+        mPipelineCache = PipelineCache::create(mDevice, mPhysicalDevice, "pipeline_cache.bin", mPipelineCreationFeedback);
     }
 
     Device::~Device()
     {
+        mPipelineCache.reset();
+        mAllocator.reset();
         vkDestroyDevice(mDevice, nullptr);
         mSurface.reset();
         mInstance.reset();
@@ -32,6 +42,45 @@ namespace LearnVulkan::Wrapper
         std::vector<VkPhysicalDevice> devices(deviceCount);
         vkEnumeratePhysicalDevices(mInstance->getInstance(), &deviceCount, devices.data());
 
+        for (uint32_t i = 0; i < deviceCount; ++i)
+        {
+            VkPhysicalDeviceProperties deviceProp;
+            vkGetPhysicalDeviceProperties(devices[i], &deviceProp);
+
+            std::cout << "GPU " << i << ": " << deviceProp.deviceName << (isDeviceSuitable(devices[i]) ? "" : " (unsuitable)") << std::endl;
+        }
+
+        // 指定了设备时只接受该设备（序号或名字的一部分），便于在 CI 上强制使用 lavapipe / SwiftShader 等软件实现
+        if (!mDeviceSelector.empty())
+        {
+            bool isIndex = std::all_of(mDeviceSelector.begin(), mDeviceSelector.end(), [](unsigned char c) { return std::isdigit(c) != 0; });
+
+            std::string selector = mDeviceSelector;
+            std::transform(selector.begin(), selector.end(), selector.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+            for (uint32_t i = 0; i < deviceCount && mPhysicalDevice == VK_NULL_HANDLE; ++i)
+            {
+                VkPhysicalDeviceProperties deviceProp;
+                vkGetPhysicalDeviceProperties(devices[i], &deviceProp);
+
+                std::string name = deviceProp.deviceName;
+                std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+                bool matched = isIndex ? std::stoul(selector) == i : name.find(selector) != std::string::npos;
+                if (matched && isDeviceSuitable(devices[i]))
+                {
+                    mPhysicalDevice = devices[i];
+                }
+            }
+
+            if (mPhysicalDevice == VK_NULL_HANDLE)
+            {
+                throw std::runtime_error("Error: no suitable physical device matches " + mDeviceSelector);
+            }
+
+            return;
+        }
+
         std::multimap<int, VkPhysicalDevice> candidates;
         for (const auto& device : devices)
         {
@@ -39,9 +88,14 @@ namespace LearnVulkan::Wrapper
             candidates.insert(std::make_pair(score, device));
         }
 
-        if (candidates.rbegin()->first > 0 && isDeviceSuitable(candidates.rbegin()->second))
+        // 从评分最高的开始取第一个满足要求的设备
+        for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
         {
-            mPhysicalDevice = candidates.rbegin()->second;
+            if (it->first > 0 && isDeviceSuitable(it->second))
+            {
+                mPhysicalDevice = it->second;
+                break;
+            }
         }
 
         if (mPhysicalDevice == VK_NULL_HANDLE)
@@ -57,8 +111,11 @@ namespace LearnVulkan::Wrapper
         VkPhysicalDeviceProperties  deviceProp;
         vkGetPhysicalDeviceProperties(device, &deviceProp);
 
-        VkPhysicalDeviceFeatures deviceFeatures;
-        vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+        // 软件实现只在没有硬件设备时被自动选中
+        if (deviceProp.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+        {
+            return 1;
+        }
 
         if (deviceProp.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
         {
@@ -67,11 +124,6 @@ namespace LearnVulkan::Wrapper
 
         score += deviceProp.limits.maxImageDimension2D;
 
-        if (!deviceFeatures.geometryShader)
-        {
-            return 0;
-        }
-
         return score;
     }
 
@@ -80,16 +132,64 @@ namespace LearnVulkan::Wrapper
         VkPhysicalDeviceProperties deviceProp;
         vkGetPhysicalDeviceProperties(device, &deviceProp);
 
-        VkPhysicalDeviceFeatures deviceFeatures;
-        vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+        // 渲染器没有几何着色阶段，各向异性过滤在不支持时关闭，特性上唯一硬性要求是 1.2 的时间线信号量
+        if (deviceProp.apiVersion < VK_API_VERSION_1_2)
+        {
+            return false;
+        }
+
+        VkPhysicalDeviceVulkan12Features features12 = {};
+        features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+        VkPhysicalDeviceFeatures2 features = {};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &features12;
+
+        vkGetPhysicalDeviceFeatures2(device, &features);
+
+        if (features12.timelineSemaphore != VK_TRUE)
+        {
+            return false;
+        }
+
+        // 需要图形队列族；有表面时还需要能呈现到该表面的队列族
+        initQueueFamilies(device);
+        if (!isQueueFamilyComplete())
+        {
+            return false;
+        }
+
+        // 必需的设备扩展（无表面时不需要交换链扩展，与 createLogicalDevice 一致）
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        for (const char* required : deviceRequiredExtensions)
+        {
+            if (mSurface == nullptr && std::strcmp(required, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0)
+            {
+                continue;
+            }
+
+            bool found = std::any_of(availableExtensions.begin(), availableExtensions.end(),
+                                     [required](const VkExtensionProperties& extension) { return std::strcmp(extension.extensionName, required) == 0; });
+            if (!found)
+            {
+                return false;
+            }
+        }
 
-        return deviceProp.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU &&
-                                        deviceFeatures.geometryShader &&
-                                        deviceFeatures.samplerAnisotropy;
+        return true;
     }
 
     void Device::initQueueFamilies(VkPhysicalDevice device)
     {
+        // 挑选设备时会对每个候选设备调用，先清掉上一个设备的结果
+        mGraphicQueueFamily.reset();
+        mPresentQueueFamily.reset();
+        mTransferQueueFamily.reset();
+
         uint32_t queueFamilyCount = 0;
 
         vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
@@ -106,7 +206,10 @@ namespace LearnVulkan::Wrapper
             }
 
             VkBool32 presentSupport = VK_FALSE;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, mSurface->getSurface(), &presentSupport);
+            if (mSurface != nullptr)
+            {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, mSurface->getSurface(), &presentSupport);
+            }
 
             if (presentSupport)
             {
@@ -119,13 +222,53 @@ namespace LearnVulkan::Wrapper
 
             ++i;
         }
+
+        // 传输队列族：优先只支持传输的族（独立 DMA 引擎），其次不含图形能力的族，
+        // 都没有时退回图形队列族
+        int bestScore = -1;
+        for (uint32_t index = 0; index < queueFamilyCount; ++index)
+        {
+            const auto& queueFamily = queueFamilies[index];
+
+            if (queueFamily.queueCount == 0 || !(queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT))
+            {
+                continue;
+            }
+
+            int score = 0;
+            if (!(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                score += 1;
+            }
+            if (!(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT))
+            {
+                score += 1;
+            }
+
+            if (score > 0 && score > bestScore)
+            {
+                bestScore            = score;
+                mTransferQueueFamily = index;
+            }
+        }
+
+        if (!mTransferQueueFamily.has_value())
+        {
+            mTransferQueueFamily = mGraphicQueueFamily;
+        }
+
+        // 无表面时没有呈现，呈现队列只是图形队列的别名
+        if (mSurface == nullptr)
+        {
+            mPresentQueueFamily = mGraphicQueueFamily;
+        }
     }
 
     void Device::createLogicalDevice()
     {
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 
-        std::set<uint32_t> queueFamilies = { mGraphicQueueFamily.value(), mPresentQueueFamily.value() };
+        std::set<uint32_t> queueFamilies = { mGraphicQueueFamily.value(), mPresentQueueFamily.value(), mTransferQueueFamily.value() };
 
         float queuePriority = 1.0;
 
@@ -140,20 +283,79 @@ namespace LearnVulkan::Wrapper
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
-        // 3. 启用设备特性（各向异性过滤）
+        // 3. 启用设备特性（各向异性过滤、间接绘制与管线统计查询相关特性在支持时开启）
+        VkPhysicalDeviceVulkan12Features supportedFeatures12 = {};
+        supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+        VkPhysicalDeviceFeatures2 supportedFeatures = {};
+        supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures.pNext = &supportedFeatures12;
+        vkGetPhysicalDeviceFeatures2(mPhysicalDevice, &supportedFeatures);
+
+        mMultiDrawIndirect         = supportedFeatures.features.multiDrawIndirect == VK_TRUE;
+        mDrawIndirectFirstInstance = supportedFeatures.features.drawIndirectFirstInstance == VK_TRUE;
+        mPipelineStatisticsQuery   = supportedFeatures.features.pipelineStatisticsQuery == VK_TRUE;
+        mInheritedQueries          = supportedFeatures.features.inheritedQueries == VK_TRUE;
+        mDrawIndirectCount = supportedFeatures12.drawIndirectCount == VK_TRUE;
+        mSamplerAnisotropy = supportedFeatures.features.samplerAnisotropy == VK_TRUE;
+
+        VkPhysicalDeviceProperties deviceProp;
+        vkGetPhysicalDeviceProperties(mPhysicalDevice, &deviceProp);
+        mMaxSamplerAnisotropy = deviceProp.limits.maxSamplerAnisotropy;
+
         VkPhysicalDeviceFeatures deviceFeatures = {};
-        deviceFeatures.samplerAnisotropy = VK_TRUE;
+        deviceFeatures.samplerAnisotropy = mSamplerAnisotropy ? VK_TRUE : VK_FALSE;
+        deviceFeatures.multiDrawIndirect = mMultiDrawIndirect ? VK_TRUE : VK_FALSE;
+        deviceFeatures.drawIndirectFirstInstance = mDrawIndirectFirstInstance ? VK_TRUE : VK_FALSE;
+        deviceFeatures.pipelineStatisticsQuery = mPipelineStatisticsQuery ? VK_TRUE : VK_FALSE;
+        deviceFeatures.inheritedQueries = mInheritedQueries ? VK_TRUE : VK_FALSE;
+
+        // 启用时间线信号量（传输队列与图形队列之间的交接）和 GPU 写绘制数量的间接绘制，均为 Vulkan 1.2 核心特性
+        VkPhysicalDeviceVulkan12Features features12 = {};
+        features12.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        features12.timelineSemaphore = VK_TRUE;
+        features12.drawIndirectCount = mDrawIndirectCount ? VK_TRUE : VK_FALSE;
 
         // 4. 填写逻辑设备创建信息
         VkDeviceCreateInfo deviceCreateInfo = {};
         deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        deviceCreateInfo.pNext = &features12;
         deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
         deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
 
         // 5. 启用设备扩展
-        deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(deviceRequiredExtensions.size());
-        deviceCreateInfo.ppEnabledExtensionNames = deviceRequiredExtensions.data();
+        std::vector<const char*> extensions(deviceRequiredExtensions.begin(), deviceRequiredExtensions.end());
+        if (mSurface == nullptr)
+        {
+            extensions.erase(std::remove_if(extensions.begin(), extensions.end(),
+                                            [](const char* name) { return std::strcmp(name, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0; }),
+                             extensions.end());
+        }
+
+        // 可选扩展：驱动提供的显存预算，纹理常驻管理据此决定何时降低分辨率；
+        // 管线创建反馈，管线缓存据此统计创建是否真正命中
+        uint32_t availableCount = 0;
+        vkEnumerateDeviceExtensionProperties(mPhysicalDevice, nullptr, &availableCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(availableCount);
+        vkEnumerateDeviceExtensionProperties(mPhysicalDevice, nullptr, &availableCount, availableExtensions.data());
+
+        for (const auto& extension : availableExtensions)
+        {
+            if (std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+            {
+                extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+                mMemoryBudget = true;
+            }
+            else if (std::strcmp(extension.extensionName, VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME) == 0)
+            {
+                extensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+                mPipelineCreationFeedback = true;
+            }
+        }
+
+        deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        deviceCreateInfo.ppEnabledExtensionNames = extensions.data();
 
         // 6. 启用验证层（如果实例启用了）
         if (mInstance->getEnableValidationLayer())
@@ -175,6 +377,7 @@ namespace LearnVulkan::Wrapper
         // 8. 获取队列句柄
         vkGetDeviceQueue(mDevice, mGraphicQueueFamily.value(), 0, &mGraphicQueue);
         vkGetDeviceQueue(mDevice, mPresentQueueFamily.value(), 0, &mPresentQueue);
+        vkGetDeviceQueue(mDevice, mTransferQueueFamily.value(), 0, &mTransferQueue);
     }
 
     bool Device::isQueueFamilyComplete()
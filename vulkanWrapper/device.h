@@ -3,6 +3,8 @@
 #include "base.h"
 #include "instance.h"
 #include "windowSurface.h"
+#include "memoryAllocator.h"
+#include "pipelineCache.h"
 
 namespace LearnVulkan::Wrapper
 {
@@ -17,12 +19,14 @@ namespace LearnVulkan::Wrapper
     public:
         using Ptr = std::shared_ptr<Device>;
 
-        static Ptr create(Instance::Ptr& instance, WindowSurface::Ptr& surface)
+        static Ptr create(Instance::Ptr& instance, WindowSurface::Ptr& surface, const std::string& deviceSelector = {})
         {
-            return std::make_shared<Device>(instance, surface);
+            return std::make_shared<Device>(instance, surface, deviceSelector);
         }
 
-        Device(Instance::Ptr& instance, WindowSurface::Ptr& surface);
+        /// surface 为空时创建只用于计算 / 离屏的设备：不启用交换链扩展，呈现队列与图形队列相同
+        /// deviceSelector 为物理设备序号或名字的一部分（不区分大小写，例如 "llvmpipe"、"SwiftShader"），为空时按评分自动选择
+        Device(Instance::Ptr& instance, WindowSurface::Ptr& surface, const std::string& deviceSelector = {});
         ~Device();
 
         void pickPhysicalDevice();
@@ -37,8 +41,41 @@ namespace LearnVulkan::Wrapper
         [[nodiscard]] auto getPhysicalDevice()     const { return mPhysicalDevice; }
         [[nodiscard]] auto getGraphicQueueFamily() const { return mGraphicQueueFamily; }
         [[nodiscard]] auto getPresentQueueFamily() const { return mPresentQueueFamily; }
+        [[nodiscard]] auto getTransferQueueFamily() const { return mTransferQueueFamily; }
         [[nodiscard]] auto getGraphicQueue()       const { return mGraphicQueue; }
         [[nodiscard]] auto getPresentQueue()       const { return mPresentQueue; }
+        [[nodiscard]] auto getTransferQueue()      const { return mTransferQueue; }
+
+        /// 传输队列是否来自独立的队列族（否则与图形队列相同，无需所有权转移）
+        [[nodiscard]] bool hasDedicatedTransferQueue() const { return mTransferQueueFamily != mGraphicQueueFamily; }
+        [[nodiscard]] auto getAllocator()          const { return mAllocator; }
+        [[nodiscard]] auto getPipelineCache()      const { return mPipelineCache; }
+
+        /// 一次 vkCmdDrawIndexedIndirect 能否提交多个绘制（multiDrawIndirect）
+        [[nodiscard]] bool supportsMultiDrawIndirect() const { return mMultiDrawIndirect; }
+
+        /// 间接绘制命令的 firstInstance 能否非 0（GPU 剔除用它选择实例矩阵）
+        [[nodiscard]] bool supportsDrawIndirectFirstInstance() const { return mDrawIndirectFirstInstance; }
+
+        /// 能否使用管线统计查询（片元着色器调用次数等）
+        [[nodiscard]] bool supportsPipelineStatistics() const { return mPipelineStatisticsQuery; }
+
+        /// 二级命令缓冲能否在主命令缓冲的查询范围内执行（inheritedQueries）
+        [[nodiscard]] bool supportsInheritedQueries() const { return mInheritedQueries; }
+
+        /// 能否由 GPU 写入绘制数量（vkCmdDrawIndexedIndirectCount）
+        [[nodiscard]] bool supportsDrawIndirectCount() const { return mDrawIndirectCount; }
+
+        /// 采样器能否开启各向异性过滤（部分软件实现不支持）
+        [[nodiscard]] bool supportsSamplerAnisotropy() const { return mSamplerAnisotropy; }
+
+        [[nodiscard]] float getMaxSamplerAnisotropy() const { return mMaxSamplerAnisotropy; }
+
+        /// 是否启用了 VK_EXT_memory_budget（分配器能查询驱动给出的每堆预算与占用）
+        [[nodiscard]] bool supportsMemoryBudget() const { return mMemoryBudget; }
+
+        /// 是否启用了 VK_EXT_pipeline_creation_feedback（管线缓存据此判断创建是否命中）
+        [[nodiscard]] bool supportsPipelineCreationFeedback() const { return mPipelineCreationFeedback; }
 
     private:
         VkPhysicalDevice   mPhysicalDevice{ VK_NULL_HANDLE };
@@ -51,7 +88,25 @@ namespace LearnVulkan::Wrapper
         std::optional<uint32_t> mPresentQueueFamily;
         VkQueue                 mPresentQueue{ VK_NULL_HANDLE };
 
+        std::optional<uint32_t> mTransferQueueFamily;
+        VkQueue                 mTransferQueue{ VK_NULL_HANDLE };
+
         VkDevice mDevice{ VK_NULL_HANDLE };
         VkSampleCountFlagBits mMsaaSamples{ VK_SAMPLE_COUNT_1_BIT };
+
+        MemoryAllocator::Ptr mAllocator{ nullptr };
+        PipelineCache::Ptr   mPipelineCache{ nullptr };
+
+        bool mMultiDrawIndirect{ false };
+        bool mDrawIndirectCount{ false };
+        bool mDrawIndirectFirstInstance{ false };
+        bool mPipelineStatisticsQuery{ false };
+        bool mInheritedQueries{ false };
+        bool mSamplerAnisotropy{ false };
+        bool mMemoryBudget{ false };
+        bool mPipelineCreationFeedback{ false };
+
+        float       mMaxSamplerAnisotropy{ 1.0f };
+        std::string mDeviceSelector{};
     };
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 ﻿#include "fence.h"
+#include "cpuProfiler.h"
 
 namespace LearnVulkan::Wrapper
 {
@@ -31,6 +32,8 @@ namespace LearnVulkan::Wrapper
 
     void Fence::block(uint64_t timeout)
     {
+        CPU_PROFILE_ZONE("Fence::block");
+
         vkWaitForFences(mDevice->getDevice(),
                         1,         
                         &mFence,   
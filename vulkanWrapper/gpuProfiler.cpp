@@ -0,0 +1,487 @@
+﻿#include "gpuProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace LearnVulkan::Wrapper
+{
+    // 管线统计结果按标志位从低到高排列，与这里的顺序一致
+    static const std::pair<VkQueryPipelineStatisticFlagBits, const char*> statisticNames[] =
+    {
+        { VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT,                    "ia_vertices" },
+        { VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT,                  "ia_primitives" },
+        { VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT,                  "vs_invocations" },
+        { VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_INVOCATIONS_BIT,                "gs_invocations" },
+        { VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_PRIMITIVES_BIT,                 "gs_primitives" },
+        { VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT,                       "clip_invocations" },
+        { VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT,                        "clip_primitives" },
+        { VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT,                "fs_invocations" },
+        { VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_CONTROL_SHADER_PATCHES_BIT,        "tcs_patches" },
+        { VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT, "tes_invocations" },
+        { VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT,                 "cs_invocations" },
+    };
+
+    GpuProfiler::GpuProfiler(const Device::Ptr& device,
+                             uint32_t frameCount,
+                             VkQueryPipelineStatisticFlags statistics,
+                             const std::string& dumpPath,
+                             uint32_t maxScopes)
+    {
+        mDevice    = device;
+        mMaxScopes = maxScopes;
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(mDevice->getPhysicalDevice(), &properties);
+
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(mDevice->getPhysicalDevice(), &queueFamilyCount, nullptr);
+
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(mDevice->getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+
+        // 时间戳只有 timestampValidBits 位有效，差值要在该位宽内回绕；为 0 表示图形队列不支持时间戳
+        uint32_t validBits = queueFamilies[mDevice->getGraphicQueueFamily().value()].timestampValidBits;
+
+        mEnabled         = validBits > 0 && properties.limits.timestampPeriod > 0.0f;
+        mTimestampPeriod = properties.limits.timestampPeriod;
+        mTimestampMask   = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+        if (!mEnabled)
+        {
+            std::cout << "Warning: timestamp queries are not supported on the graphics queue, GPU profiling disabled" << std::endl;
+            return;
+        }
+
+        if (statistics != 0 && !mDevice->supportsPipelineStatistics())
+        {
+            std::cout << "Warning: pipeline statistics queries are not supported, GPU profiler records timestamps only" << std::endl;
+            statistics = 0;
+        }
+
+        mStatistics = statistics;
+
+        mFrames.resize(frameCount);
+        for (auto& frame : mFrames)
+        {
+            frame.mTimestampPool = QueryPool::create(mDevice, VK_QUERY_TYPE_TIMESTAMP, mMaxScopes * 2);
+
+            if (mStatistics != 0)
+            {
+                frame.mStatisticsPool = QueryPool::create(mDevice, VK_QUERY_TYPE_PIPELINE_STATISTICS, mMaxScopes, mStatistics);
+                mStatisticCount       = frame.mStatisticsPool->getValueCount();
+            }
+
+            frame.mScopes.reserve(mMaxScopes);
+        }
+
+        if (!dumpPath.empty())
+        {
+            mDumpFile.open(dumpPath, std::ios::trunc);
+            if (!mDumpFile)
+            {
+                throw std::runtime_error("Error: failed to open GPU profile dump " + dumpPath);
+            }
+
+            mDumpJson = dumpPath.size() >= 5 && dumpPath.compare(dumpPath.size() - 5, 5, ".json") == 0;
+
+            if (!mDumpJson)
+            {
+                mDumpFile << "frame,scope,gpu_ms";
+                for (const auto& [bit, name] : statisticNames)
+                {
+                    if (mStatistics & bit)
+                    {
+                        mDumpFile << "," << name;
+                    }
+                }
+                mDumpFile << "\n";
+            }
+        }
+    }
+
+    GpuProfiler::~GpuProfiler()
+    {
+        mFrames.clear();
+    }
+
+    void GpuProfiler::beginFrame(const CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex)
+    {
+        if (!mEnabled)
+        {
+            return;
+        }
+
+        auto& frame = mFrames[frameIndex];
+
+        collect(frameIndex);
+
+        mCurrentFrame          = frameIndex;
+        mActiveStatisticsScope = UINT32_MAX;
+
+        frame.mScopes.clear();
+        frame.mStatisticsCount = 0;
+        frame.mFrameNumber     = mFrameNumber++;
+        frame.mPending         = true;
+
+        commandBuffer->resetQueryPool(frame.mTimestampPool->getQueryPool(), 0, mMaxScopes * 2);
+
+        if (frame.mStatisticsPool != nullptr)
+        {
+            commandBuffer->resetQueryPool(frame.mStatisticsPool->getQueryPool(), 0, mMaxScopes);
+        }
+    }
+
+    void GpuProfiler::flush()
+    {
+        if (!mEnabled)
+        {
+            return;
+        }
+
+        // 按帧序号从旧到新读回，回调看到的顺序与提交顺序一致
+        std::vector<uint32_t> pending{};
+        for (uint32_t i = 0; i < static_cast<uint32_t>(mFrames.size()); ++i)
+        {
+            if (mFrames[i].mPending)
+            {
+                pending.push_back(i);
+            }
+        }
+
+        std::sort(pending.begin(), pending.end(), [this](uint32_t a, uint32_t b) { return mFrames[a].mFrameNumber < mFrames[b].mFrameNumber; });
+
+        for (uint32_t frameIndex : pending)
+        {
+            collect(frameIndex);
+        }
+    }
+
+    void GpuProfiler::collect(uint32_t frameIndex)
+    {
+        auto& frame = mFrames[frameIndex];
+
+        if (!frame.mPending)
+        {
+            return;
+        }
+
+        if (!resolve(frameIndex))
+        {
+            ++mDroppedFrames;
+            return;
+        }
+
+        dumpFrame(frame.mFrameNumber, frameIndex);
+
+        if (mResolveCallback)
+        {
+            for (size_t i = 0; i < frame.mScopes.size(); ++i)
+            {
+                mResolveCallback(frame.mFrameNumber, frame.mScopes[i].mName, frame.mMilliseconds[i]);
+            }
+        }
+    }
+
+    uint32_t GpuProfiler::beginScope(const CommandBuffer::Ptr& commandBuffer, const char* name, bool statistics)
+    {
+        if (!mEnabled)
+        {
+            return UINT32_MAX;
+        }
+
+        auto& frame = mFrames[mCurrentFrame];
+
+        if (frame.mScopes.size() >= mMaxScopes)
+        {
+            return UINT32_MAX;
+        }
+
+        uint32_t index = static_cast<uint32_t>(frame.mScopes.size());
+
+        ScopeRecord scope{};
+        scope.mName = name;
+
+        commandBuffer->writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.mTimestampPool->getQueryPool(), index * 2);
+
+        if (statistics && frame.mStatisticsPool != nullptr && mActiveStatisticsScope == UINT32_MAX)
+        {
+            scope.mStatisticsQuery = frame.mStatisticsCount++;
+            mActiveStatisticsScope = index;
+
+            commandBuffer->beginQuery(frame.mStatisticsPool->getQueryPool(), scope.mStatisticsQuery);
+        }
+
+        frame.mScopes.push_back(scope);
+
+        return index;
+    }
+
+    void GpuProfiler::endScope(const CommandBuffer::Ptr& commandBuffer, uint32_t index)
+    {
+        if (index == UINT32_MAX)
+        {
+            return;
+        }
+
+        auto& frame = mFrames[mCurrentFrame];
+        auto& scope = frame.mScopes[index];
+
+        if (scope.mStatisticsQuery != UINT32_MAX)
+        {
+            commandBuffer->endQuery(frame.mStatisticsPool->getQueryPool(), scope.mStatisticsQuery);
+            mActiveStatisticsScope = UINT32_MAX;
+        }
+
+        commandBuffer->writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.mTimestampPool->getQueryPool(), index * 2 + 1);
+
+        scope.mEnded = true;
+    }
+
+    // 调用时该分片上一次的提交已经完成（FrameContext 等待过时间线值），不带 WAIT 标志读取；
+    // 个别驱动仍报告未就绪时丢弃这一帧，而不是阻塞渲染线程
+    bool GpuProfiler::resolve(uint32_t frameIndex)
+    {
+        auto& frame = mFrames[frameIndex];
+
+        frame.mPending = false;
+
+        uint32_t scopeCount = static_cast<uint32_t>(frame.mScopes.size());
+        if (scopeCount == 0)
+        {
+            return false;
+        }
+
+        // 没有结束的作用域（录制中途抛出异常等）没有写结束时间戳，不能读取
+        for (const auto& scope : frame.mScopes)
+        {
+            if (!scope.mEnded)
+            {
+                return false;
+            }
+        }
+
+        std::vector<uint64_t> timestamps{};
+        if (!frame.mTimestampPool->getResults(0, scopeCount * 2, timestamps))
+        {
+            return false;
+        }
+
+        std::vector<uint64_t> statisticValues{};
+        if (frame.mStatisticsCount > 0 && !frame.mStatisticsPool->getResults(0, frame.mStatisticsCount, statisticValues))
+        {
+            return false;
+        }
+
+        frame.mMilliseconds.resize(scopeCount);
+        frame.mStatisticValues.assign(size_t(scopeCount) * mStatisticCount, 0);
+
+        for (uint32_t i = 0; i < scopeCount; ++i)
+        {
+            const auto& scope = frame.mScopes[i];
+
+            uint64_t ticks = (timestamps[i * 2 + 1] - timestamps[i * 2]) & mTimestampMask;
+
+            frame.mMilliseconds[i] = static_cast<double>(ticks) * mTimestampPeriod / 1000000.0;
+
+            if (scope.mStatisticsQuery != UINT32_MAX)
+            {
+                std::copy_n(statisticValues.begin() + size_t(scope.mStatisticsQuery) * mStatisticCount,
+                            mStatisticCount,
+                            frame.mStatisticValues.begin() + size_t(i) * mStatisticCount);
+            }
+
+            auto found = mAverages.find(scope.mName);
+            if (found == mAverages.end())
+            {
+                RollingAverage average{};
+                average.mMilliseconds.resize(AVERAGE_WINDOW, 0.0);
+                average.mStatistics.resize(size_t(AVERAGE_WINDOW) * mStatisticCount, 0.0);
+
+                found = mAverages.emplace(scope.mName, std::move(average)).first;
+                mScopeOrder.push_back(scope.mName);
+            }
+
+            auto& average = found->second;
+
+            average.mMilliseconds[average.mNext] = frame.mMilliseconds[i];
+            for (uint32_t s = 0; s < mStatisticCount; ++s)
+            {
+                average.mStatistics[size_t(average.mNext) * mStatisticCount + s] =
+                    static_cast<double>(frame.mStatisticValues[size_t(i) * mStatisticCount + s]);
+            }
+
+            average.mNext  = (average.mNext + 1) % AVERAGE_WINDOW;
+            average.mCount = std::min(average.mCount + 1, AVERAGE_WINDOW);
+        }
+
+        return true;
+    }
+
+    void GpuProfiler::dumpFrame(uint64_t frameNumber, uint32_t frameIndex)
+    {
+        if (!mDumpFile.is_open())
+        {
+            return;
+        }
+
+        const auto& frame = mFrames[frameIndex];
+
+        if (mDumpJson)
+        {
+            // JSON Lines：每帧一个对象，便于逐行流式解析
+            mDumpFile << "{\"frame\":" << frameNumber << ",\"scopes\":[";
+
+            for (size_t i = 0; i < frame.mScopes.size(); ++i)
+            {
+                mDumpFile << (i == 0 ? "" : ",") << "{\"name\":\"" << frame.mScopes[i].mName << "\",\"gpu_ms\":" << frame.mMilliseconds[i];
+
+                if (frame.mScopes[i].mStatisticsQuery != UINT32_MAX)
+                {
+                    uint32_t s = 0;
+                    for (const auto& [bit, name] : statisticNames)
+                    {
+                        if (mStatistics & bit)
+                        {
+                            mDumpFile << ",\"" << name << "\":" << frame.mStatisticValues[i * mStatisticCount + s++];
+                        }
+                    }
+                }
+
+                mDumpFile << "}";
+            }
+
+            mDumpFile << "]}\n";
+        }
+        else
+        {
+            for (size_t i = 0; i < frame.mScopes.size(); ++i)
+            {
+                mDumpFile << frameNumber << "," << frame.mScopes[i].mName << "," << frame.mMilliseconds[i];
+
+                for (uint32_t s = 0; s < mStatisticCount; ++s)
+                {
+                    mDumpFile << ",";
+                    if (frame.mScopes[i].mStatisticsQuery != UINT32_MAX)
+                    {
+                        mDumpFile << frame.mStatisticValues[i * mStatisticCount + s];
+                    }
+                }
+
+                mDumpFile << "\n";
+            }
+        }
+    }
+
+    double GpuProfiler::getAverageMilliseconds(const std::string& name) const
+    {
+        auto found = mAverages.find(name);
+        if (found == mAverages.end() || found->second.mCount == 0)
+        {
+            return 0.0;
+        }
+
+        const auto& average = found->second;
+
+        double sum = 0.0;
+        for (uint32_t i = 0; i < average.mCount; ++i)
+        {
+            sum += average.mMilliseconds[i];
+        }
+
+        return sum / average.mCount;
+    }
+
+    double GpuProfiler::getAverageStatistic(const std::string& name, VkQueryPipelineStatisticFlagBits statistic) const
+    {
+        auto found = mAverages.find(name);
+        if (found == mAverages.end() || found->second.mCount == 0 || !(mStatistics & statistic))
+        {
+            return 0.0;
+        }
+
+        // 统计项在结果中的位置 = 比它低的已开启标志位个数
+        uint32_t slot = 0;
+        for (const auto& [bit, statisticName] : statisticNames)
+        {
+            if (bit == statistic)
+            {
+                break;
+            }
+
+            if (mStatistics & bit)
+            {
+                ++slot;
+            }
+        }
+
+        const auto& average = found->second;
+
+        double sum = 0.0;
+        for (uint32_t i = 0; i < average.mCount; ++i)
+        {
+            sum += average.mStatistics[size_t(i) * mStatisticCount + slot];
+        }
+
+        return sum / average.mCount;
+    }
+
+    void GpuProfiler::printStats() const
+    {
+        if (!mEnabled || mScopeOrder.empty())
+        {
+            return;
+        }
+
+        std::cout << "GPU:";
+        for (const auto& name : mScopeOrder)
+        {
+            std::cout << " " << name << " " << std::fixed << std::setprecision(3) << getAverageMilliseconds(name) << " ms";
+
+            for (const auto& [bit, statisticName] : statisticNames)
+            {
+                if ((mStatistics & bit) && getAverageStatistic(name, bit) > 0.0)
+                {
+                    std::cout << " (" << statisticName << " " << std::setprecision(0) << getAverageStatistic(name, bit) << ")";
+                }
+            }
+
+            std::cout << ";";
+        }
+
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+
+        if (mDroppedFrames > 0)
+        {
+            std::cout << " " << mDroppedFrames << " frames dropped (results not ready)";
+        }
+
+        std::cout << std::endl;
+    }
+
+    GpuProfiler::Scope::Scope(const Ptr& profiler, const CommandBuffer::Ptr& commandBuffer, const char* name, bool statistics)
+    {
+        if (profiler == nullptr)
+        {
+            return;
+        }
+
+        mProfiler      = profiler.get();
+        mCommandBuffer = commandBuffer;
+        mIndex         = mProfiler->beginScope(commandBuffer, name, statistics);
+    }
+
+    GpuProfiler::Scope::~Scope()
+    {
+        end();
+    }
+
+    void GpuProfiler::Scope::end()
+    {
+        if (mProfiler != nullptr)
+        {
+            mProfiler->endScope(mCommandBuffer, mIndex);
+            mProfiler = nullptr;
+        }
+    }
+}
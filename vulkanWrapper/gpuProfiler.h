@@ -0,0 +1,149 @@
+﻿#pragma once
+
+#include "base.h"
+#include "device.h"
+#include "commandBuffer.h"
+#include "queryPool.h"
+
+#include <functional>
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // GPU 计时器：每个 frame-in-flight 一组时间戳查询池（可选一组管线统计查询池），循环使用
+    // 录制时 beginFrame 先读回该分片上一次的结果（此时 FrameContext 已等待其完成，读取不会阻塞，
+    // 未就绪则丢弃这一帧的样本），再在命令缓冲里重置查询；Scope 在构造 / 析构时各写一个时间戳。
+    // 结果按作用域名做滑动平均，并可以逐帧写入 CSV 或 JSON Lines（文件名以 .json 结尾）
+    // ==================================================================
+    class GpuProfiler
+    {
+    public:
+        using Ptr = std::shared_ptr<GpuProfiler>;
+
+        /// 每读回一个作用域调用一次，frameNumber 为该帧 beginFrame 时的序号（从 0 开始）
+        using ResolveCallback = std::function<void(uint64_t frameNumber, const char* name, double milliseconds)>;
+
+        /// statistics 为 0 时不创建管线统计查询；dumpPath 为空时不写文件
+        static Ptr create(const Device::Ptr& device,
+                          uint32_t frameCount,
+                          VkQueryPipelineStatisticFlags statistics = 0,
+                          const std::string& dumpPath = {},
+                          uint32_t maxScopes = 32)
+        {
+            return std::make_shared<GpuProfiler>(device, frameCount, statistics, dumpPath, maxScopes);
+        }
+
+        GpuProfiler(const Device::Ptr& device,
+                    uint32_t frameCount,
+                    VkQueryPipelineStatisticFlags statistics,
+                    const std::string& dumpPath,
+                    uint32_t maxScopes);
+
+        ~GpuProfiler();
+
+        // 录制期间的作用域标记：构造时写开始时间戳（statistics 为 true 时同时开始管线统计查询），析构时结束
+        // 管线统计查询不能嵌套，外层已在统计时内层只计时
+        class Scope
+        {
+        public:
+            Scope(const Ptr& profiler, const CommandBuffer::Ptr& commandBuffer, const char* name, bool statistics = false);
+            ~Scope();
+
+            /// 提前结束作用域（必须在命令缓冲 end 之前），之后析构不再写时间戳
+            void end();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            GpuProfiler*       mProfiler{ nullptr };
+            CommandBuffer::Ptr mCommandBuffer{ nullptr };
+            uint32_t           mIndex{ UINT32_MAX };
+        };
+
+        /// 在命令缓冲开始录制后、任何 Scope 之前调用
+        void beginFrame(const CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex);
+
+        /// 读回所有尚未读取的分片；只能在这些帧确定已在 GPU 上完成后调用（例如 vkDeviceWaitIdle 之后）
+        void flush();
+
+        void setResolveCallback(ResolveCallback callback) { mResolveCallback = std::move(callback); }
+
+        /// 作用域最近若干帧的平均 GPU 时间（毫秒），没有样本时为 0
+        [[nodiscard]] double getAverageMilliseconds(const std::string& name) const;
+
+        /// 作用域最近若干帧某一统计项（单个 VkQueryPipelineStatisticFlagBits）的平均值
+        [[nodiscard]] double getAverageStatistic(const std::string& name, VkQueryPipelineStatisticFlagBits statistic) const;
+
+        void printStats() const;
+
+        [[nodiscard]] bool isEnabled()     const { return mEnabled; }
+        [[nodiscard]] auto getStatistics() const { return mStatistics; }
+
+    private:
+        uint32_t beginScope(const CommandBuffer::Ptr& commandBuffer, const char* name, bool statistics);
+
+        void endScope(const CommandBuffer::Ptr& commandBuffer, uint32_t index);
+
+        /// 读回分片 frameIndex 上一次录制的结果，未就绪时返回 false
+        bool resolve(uint32_t frameIndex);
+
+        void dumpFrame(uint64_t frameNumber, uint32_t frameIndex);
+
+        /// 读回并输出分片 frameIndex 上一次录制的结果（写文件、回调），未就绪时计入丢弃帧数
+        void collect(uint32_t frameIndex);
+
+    private:
+        static constexpr uint32_t AVERAGE_WINDOW = 120;
+
+        struct ScopeRecord
+        {
+            const char* mName{ nullptr };
+            uint32_t    mStatisticsQuery{ UINT32_MAX };   // 没有统计时为 UINT32_MAX
+            bool        mEnded{ false };
+        };
+
+        struct FrameSlot
+        {
+            QueryPool::Ptr           mTimestampPool{ nullptr };
+            QueryPool::Ptr           mStatisticsPool{ nullptr };
+            std::vector<ScopeRecord> mScopes{};
+            uint32_t                 mStatisticsCount{ 0 };
+            uint64_t                 mFrameNumber{ 0 };
+            bool                     mPending{ false };
+
+            // 最近一次读回的结果：每个作用域的毫秒数与统计值
+            std::vector<double>   mMilliseconds{};
+            std::vector<uint64_t> mStatisticValues{};
+        };
+
+        struct RollingAverage
+        {
+            std::vector<double>  mMilliseconds{};
+            std::vector<double>  mStatistics{};      // 每个样本 mStatisticCount 个值
+            uint32_t             mNext{ 0 };
+            uint32_t             mCount{ 0 };
+        };
+
+        Device::Ptr                   mDevice{ nullptr };
+        bool                          mEnabled{ false };
+        double                        mTimestampPeriod{ 1.0 };   // 每个时间戳刻度的纳秒数
+        uint64_t                      mTimestampMask{ ~0ull };
+        VkQueryPipelineStatisticFlags mStatistics{ 0 };
+        uint32_t                      mStatisticCount{ 0 };
+        uint32_t                      mMaxScopes{ 0 };
+        uint32_t                      mCurrentFrame{ 0 };
+        uint32_t                      mActiveStatisticsScope{ UINT32_MAX };
+        uint64_t                      mFrameNumber{ 0 };
+        uint64_t                      mDroppedFrames{ 0 };
+
+        std::vector<FrameSlot>                          mFrames{};
+        std::unordered_map<std::string, RollingAverage> mAverages{};
+        std::vector<std::string>                        mScopeOrder{};
+
+        std::ofstream mDumpFile{};
+        bool          mDumpJson{ false };
+
+        ResolveCallback mResolveCallback{};
+    };
+}
@@ -1,33 +1,34 @@
 ﻿#include "image.h"
 #include "commandBuffer.h"
 #include "buffer.h"
+#include "uploadEngine.h"
+
+#include <algorithm>
+#include <cstring>
 
 namespace LearnVulkan::Wrapper
 {
     Image::Ptr Image::createDepthImage(const Device::Ptr& device, const int& width, const int& height)
     {
-        std::vector<VkFormat> formats =
-        {
-            VK_FORMAT_D32_SFLOAT,
-            VK_FORMAT_D32_SFLOAT_S8_UINT,
-            VK_FORMAT_D24_UNORM_S8_UINT
-        };
+        VkFormat resultFormat = findDepthFormat(device);
 
-        VkFormat resultFormat = findSupportedFormat(device,
-                                                    formats,
-                                                    VK_IMAGE_TILING_OPTIMAL,
-                                                    VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+        VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
+        if (resultFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || resultFormat == VK_FORMAT_D24_UNORM_S8_UINT)
+        {
+            aspectFlags |= VK_IMAGE_ASPECT_STENCIL_BIT;
+        }
 
+        // 深度内容不会被存储，作为 TRANSIENT 附件；能否放进惰性分配内存由构造函数按内存需求决定
         return Image::create(device,
                              width,
                              height,
                              resultFormat,
                              VK_IMAGE_TYPE_2D,
                              VK_IMAGE_TILING_OPTIMAL,
-                             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
                              VK_SAMPLE_COUNT_1_BIT,
                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                             VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+                             aspectFlags);
     }
 
     Image::Image(const Device::Ptr &device,
@@ -39,7 +40,10 @@ namespace LearnVulkan::Wrapper
                  const VkImageUsageFlags& usage,
                  const VkSampleCountFlagBits& sample,
                  const VkMemoryPropertyFlags& properties,
-                 const VkImageAspectFlags& aspectFlags)
+                 const VkImageAspectFlags& aspectFlags,
+                 uint32_t mipLevels,
+                 uint32_t arrayLayers,
+                 VkImageCreateFlags flags)
     {
         // 初始化成员变量
         mDevice = device;
@@ -47,12 +51,16 @@ namespace LearnVulkan::Wrapper
         mWidth = width;    // 记录图像宽度
         mHeight = height;  // 记录图像高度
         mFormat = format;  // 记录图像格式
+        mMipLevels = mipLevels;
+        mArrayLayers = arrayLayers;
+        mAspectFlags = aspectFlags;
 
         // ---------------------------
         // 步骤 1：创建 Vulkan 图像（VkImage）
         // ---------------------------
         VkImageCreateInfo imageCreateInfo{};
         imageCreateInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.flags         = flags;      // 立方体贴图需要 CUBE_COMPATIBLE
 
         // 图像尺寸（二维图像只需设置 width 和 height，depth 固定为 1）
         imageCreateInfo.extent.width  = width;
@@ -65,10 +73,10 @@ namespace LearnVulkan::Wrapper
         imageCreateInfo.usage         = usage;      // 图像用途（决定后续如何使用，如渲染目标、纹理采样）
         imageCreateInfo.samples       = sample;     // 多重采样等级（影响抗锯齿）
 
-        // 多级渐远纹理（Mipmap）层级数（此处固定为 1，不生成 Mipmap）
-        imageCreateInfo.mipLevels     = 1;
-        // 数组层数（适用于立方体贴图等数组图像，此处固定为 1）
-        imageCreateInfo.arrayLayers   = 1;
+        // 多级渐远纹理（Mipmap）层级数（纹理为完整 mip 链，附件为 1）
+        imageCreateInfo.mipLevels     = mipLevels;
+        // 数组层数（数组纹理为层数，立方体贴图为 6 x 层数，其余为 1）
+        imageCreateInfo.arrayLayers   = arrayLayers;
         // 初始布局（图像创建后首次使用前的布局，未定义表示初始状态无需转换）
         imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         // 共享模式（独占模式：仅一个队列族访问；共享模式：多个队列族共享）
@@ -86,22 +94,34 @@ namespace LearnVulkan::Wrapper
         VkMemoryRequirements memReq{};
         vkGetImageMemoryRequirements(mDevice->getDevice(), mImage, &memReq);
 
-        // 内存分配信息结构体
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memReq.size;
-
-        // 内存类型索引（需满足图像需求的内存属性和传入的 properties 参数）
-        // findMemoryType 函数通常根据 memReq.memoryTypeBits（支持的内存类型位掩码）和 properties（所需属性）查找匹配的索引
-        allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, properties);
+        // 从设备的分配器子分配（内存类型需满足 memReq.memoryTypeBits 与传入的 properties）
+        // OPTIMAL 图像与 Buffer 分属不同的大块，避免 bufferImageGranularity 冲突
+        VkMemoryPropertyFlags memoryFlags = properties;
+        bool                  dedicated   = false;
 
-        if (vkAllocateMemory(mDevice->getDevice(), &allocInfo, nullptr, &mImageMemory) != VK_SUCCESS)
+        // TRANSIENT 附件：memoryTypeBits 允许惰性分配内存（移动端 tile 内存）时优先使用，否则退回普通的 DEVICE_LOCAL；
+        // 惰性分配内存的实际占用由驱动按需提交，不能和其他资源共用一块，因此单独分配
+        if (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
         {
-            throw std::runtime_error("Error: failed to allocate memory!");
+            const auto& memoryProperties = mDevice->getAllocator()->getMemoryProperties();
+            VkMemoryPropertyFlags lazyFlags = properties | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+            for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+            {
+                if ((memReq.memoryTypeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & lazyFlags) == lazyFlags)
+                {
+                    memoryFlags = lazyFlags;
+                    break;
+                }
+            }
+
+            dedicated = true;
         }
 
+        mAllocation = mDevice->getAllocator()->allocate(memReq, memoryFlags, tiling == VK_IMAGE_TILING_LINEAR, dedicated);
+
         // 将分配的内存绑定到图像对象（图像必须绑定内存后才能使用）
-        vkBindImageMemory(mDevice->getDevice(), mImage, mImageMemory, 0);
+        vkBindImageMemory(mDevice->getDevice(), mImage, mAllocation.mMemory, mAllocation.mOffset);
 
         // ---------------------------
         // 步骤 3：创建图像视图（VkImageView）
@@ -110,17 +130,31 @@ namespace LearnVulkan::Wrapper
         VkImageViewCreateInfo imageViewCreateInfo{};
         imageViewCreateInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 
-        // 视图类型（根据图像类型选择：2D 图像用 VK_IMAGE_VIEW_TYPE_2D，3D 图像用 VK_IMAGE_VIEW_TYPE_3D）
-        imageViewCreateInfo.viewType                        = imageType == VK_IMAGE_TYPE_2D ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_3D;
+        // 视图类型（根据图像类型选择：2D 图像用 VK_IMAGE_VIEW_TYPE_2D，3D 图像用 VK_IMAGE_VIEW_TYPE_3D；
+        // 多层的 2D 图像为数组，CUBE_COMPATIBLE 的图像每 6 层为一个立方体）
+        if (imageType != VK_IMAGE_TYPE_2D)
+        {
+            mViewType = VK_IMAGE_VIEW_TYPE_3D;
+        }
+        else if (flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT)
+        {
+            mViewType = arrayLayers > 6 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
+        }
+        else
+        {
+            mViewType = arrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+        }
+
+        imageViewCreateInfo.viewType                        = mViewType;
         imageViewCreateInfo.format                          = format;
         imageViewCreateInfo.image                           = mImage;
 
         // 子资源范围（指定图像的哪些部分可通过视图访问）
         imageViewCreateInfo.subresourceRange.aspectMask     = aspectFlags;
         imageViewCreateInfo.subresourceRange.baseMipLevel   = 0;
-        imageViewCreateInfo.subresourceRange.levelCount     = 1;
+        imageViewCreateInfo.subresourceRange.levelCount     = mipLevels;
         imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
-        imageViewCreateInfo.subresourceRange.layerCount     = 1;
+        imageViewCreateInfo.subresourceRange.layerCount     = arrayLayers;
 
         if (vkCreateImageView(mDevice->getDevice(), &imageViewCreateInfo, nullptr, &mImageView) != VK_SUCCESS)
         {
@@ -130,38 +164,64 @@ namespace LearnVulkan::Wrapper
 
     Image::~Image()
     {
-        if (mImageView != VK_NULL_HANDLE)
+        for (auto view : mLevelViews)
         {
-            vkDestroyImageView(mDevice->getDevice(), mImageView, nullptr);
+            if (view != VK_NULL_HANDLE)
+            {
+                vkDestroyImageView(mDevice->getDevice(), view, nullptr);
+            }
         }
 
-        if (mImageMemory != VK_NULL_HANDLE)
+        if (mImageView != VK_NULL_HANDLE)
         {
-            vkFreeMemory(mDevice->getDevice(), mImageMemory, nullptr);
+            vkDestroyImageView(mDevice->getDevice(), mImageView, nullptr);
         }
 
         if (mImage != VK_NULL_HANDLE)
         {
             vkDestroyImage(mDevice->getDevice(), mImage, nullptr);
         }
+
+        mDevice->getAllocator()->free(mAllocation);
     }
 
-    uint32_t Image::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+    VkImageView Image::getImageView(uint32_t baseMipLevel)
     {
-        VkPhysicalDeviceMemoryProperties memProps;
-        vkGetPhysicalDeviceMemoryProperties(mDevice->getPhysicalDevice(), &memProps);
+        if (baseMipLevel == 0)
+        {
+            return mImageView;
+        }
+
+        if (baseMipLevel >= mMipLevels)
+        {
+            throw std::runtime_error("Error: image view base mip level out of range!");
+        }
 
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
+        mLevelViews.resize(mMipLevels, VK_NULL_HANDLE);
+
+        if (mLevelViews[baseMipLevel] == VK_NULL_HANDLE)
         {
-            if ((typeFilter & (1 << i)) && ((memProps.memoryTypes[i].propertyFlags & properties) == properties))
+            VkImageViewCreateInfo imageViewCreateInfo{};
+            imageViewCreateInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            imageViewCreateInfo.viewType                        = mViewType;
+            imageViewCreateInfo.format                          = mFormat;
+            imageViewCreateInfo.image                           = mImage;
+            imageViewCreateInfo.subresourceRange.aspectMask     = mAspectFlags;
+            imageViewCreateInfo.subresourceRange.baseMipLevel   = baseMipLevel;
+            imageViewCreateInfo.subresourceRange.levelCount     = mMipLevels - baseMipLevel;
+            imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+            imageViewCreateInfo.subresourceRange.layerCount     = mArrayLayers;
+
+            if (vkCreateImageView(mDevice->getDevice(), &imageViewCreateInfo, nullptr, &mLevelViews[baseMipLevel]) != VK_SUCCESS)
             {
-                return i;
+                throw std::runtime_error("Error: failed to create image view!");
             }
         }
 
-        throw std::runtime_error("Error: cannot find the property memory type!");
+        return mLevelViews[baseMipLevel];
     }
 
+    // 优先 32 位浮点深度：配合反向 Z，远处的精度远高于定点格式
     VkFormat Image::findDepthFormat(const Device::Ptr& device)
     {
         std::vector<VkFormat> formats =
@@ -200,17 +260,71 @@ namespace LearnVulkan::Wrapper
         throw std::runtime_error("Error: cannot find a supported image format!");
     }
 
+    uint32_t Image::getMemoryHeapIndex() const
+    {
+        return mDevice->getAllocator()->getMemoryProperties().memoryTypes[mAllocation.mMemoryTypeIndex].heapIndex;
+    }
+
     bool Image::hasStencilComponent(VkFormat format) const
     {
         return format == VK_FORMAT_D32_SFLOAT_S8_UINT ||
                format == VK_FORMAT_D24_UNORM_S8_UINT;
     }
 
+    uint32_t Image::getMipLevelCount(uint32_t width, uint32_t height)
+    {
+        uint32_t levels = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+        {
+            ++levels;
+        }
+        return levels;
+    }
+
+    bool Image::isFormatSupported(const Device::Ptr& device, VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features)
+    {
+        VkFormatProperties formatProps;
+        vkGetPhysicalDeviceFormatProperties(device->getPhysicalDevice(), format, &formatProps);
+
+        VkFormatFeatureFlags supported = tiling == VK_IMAGE_TILING_LINEAR ? formatProps.linearTilingFeatures
+                                                                          : formatProps.optimalTilingFeatures;
+
+        return (supported & features) == features;
+    }
+
+    bool Image::supportsLinearBlit(const Device::Ptr& device, VkFormat format)
+    {
+        return isFormatSupported(device,
+                                 format,
+                                 VK_IMAGE_TILING_OPTIMAL,
+                                 VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+    }
+
     void Image::setImageLayout(VkImageLayout newLayout,
                                VkPipelineStageFlags srcStageMask,
                                VkPipelineStageFlags dstStageMask,
                                VkImageSubresourceRange subresrouceRange,
                                const CommandPool::Ptr& commandPool)
+    {
+        // 使用指定命令池创建临时命令缓冲（用于本次一次性提交）
+        auto commandBuffer = CommandBuffer::create(mDevice, commandPool);
+        // 开始命令缓冲录制（ONE_TIME_SUBMIT_BIT：仅提交一次后失效）
+        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        setImageLayout(newLayout, srcStageMask, dstStageMask, subresrouceRange, commandBuffer);
+
+        commandBuffer->end();
+
+        // 同步提交命令缓冲到图形队列执行
+        // 提交后队列会执行布局转换，等待完成后返回（同步操作，阻塞当前线程）
+        commandBuffer->submitSync(mDevice->getGraphicQueue());
+    }
+
+    void Image::setImageLayout(VkImageLayout newLayout,
+                               VkPipelineStageFlags srcStageMask,
+                               VkPipelineStageFlags dstStageMask,
+                               VkImageSubresourceRange subresrouceRange,
+                               const CommandBuffer::Ptr& commandBuffer)
     {
         // 1. 初始化图像内存屏障（Image Memory Barrier）
         // 内存屏障用于告知Vulkan驱动：旧布局到新布局的转换需要同步哪些操作
@@ -275,44 +389,146 @@ namespace LearnVulkan::Wrapper
         // 4. 更新图像的当前布局状态（成员变量记录最新布局）
         mLayout = newLayout;
 
-        // 5. 创建并录制命令缓冲以提交布局转换
-        // 使用指定命令池创建临时命令缓冲（用于本次一次性提交）
-        auto commandBuffer = CommandBuffer::create(mDevice, commandPool);
-        // 开始命令缓冲录制（ONE_TIME_SUBMIT_BIT：仅提交一次后失效）
-        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-        // 6. 在命令缓冲中记录布局转换操作
+        // 5. 在命令缓冲中记录布局转换操作
         // 调用自定义方法将内存屏障提交到命令缓冲，驱动将根据src/dstStageMask同步阶段
         commandBuffer->transferImageLayout(imageMemoryBarrier, srcStageMask, dstStageMask);
+    }
 
-        // 7. 结束命令缓冲录制
-        commandBuffer->end();
+    void Image::fillImageData(size_t size,
+                              void* pData,
+                              const UploadEngine::Ptr& uploadEngine,
+                              VkImageLayout finalLayout,
+                              VkPipelineStageFlags dstStage)
+    {
+        assert(pData);
 
-        // 8. 同步提交命令缓冲到图形队列执行
-        // 提交后队列会执行布局转换，等待完成后返回（同步操作，阻塞当前线程）
-        commandBuffer->submitSync(mDevice->getGraphicQueue());
+        fillImageData(size, [pData, size](void* pStaging) { memcpy(pStaging, pData, size); }, uploadEngine, finalLayout, dstStage);
+    }
+
+    void Image::fillImageData(size_t size,
+                              const std::function<void(void*)>& writer,
+                              const UploadEngine::Ptr& uploadEngine,
+                              VkImageLayout finalLayout,
+                              VkPipelineStageFlags dstStage)
+    {
+        assert(size);
+
+        VkImageSubresourceRange range{};
+        range.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        range.baseMipLevel   = 0;
+        range.levelCount     = mMipLevels;  // 其余级别内容未定义，但布局与第 0 级一致
+        range.baseArrayLayer = 0;
+        range.layerCount     = mArrayLayers;
+
+        VkAccessFlags dstAccess = finalLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ? VK_ACCESS_SHADER_READ_BIT
+                                                                                           : VK_ACCESS_MEMORY_READ_BIT;
+
+        uploadEngine->uploadImage(mImage,
+                                  mFormat,
+                                  static_cast<uint32_t>(mWidth),
+                                  static_cast<uint32_t>(mHeight),
+                                  writer,
+                                  static_cast<VkDeviceSize>(size),
+                                  range,
+                                  finalLayout,
+                                  dstStage,
+                                  dstAccess);
+
+        // 布局转换由上传引擎的屏障完成
+        mLayout = finalLayout;
     }
 
     void Image::fillImageData(size_t size,
                               void* pData,
-                              const CommandPool::Ptr& commandPool)
+                              const std::vector<VkBufferImageCopy>& regions,
+                              const UploadEngine::Ptr& uploadEngine,
+                              VkImageLayout finalLayout,
+                              VkPipelineStageFlags dstStage)
     {
         assert(pData);
         assert(size);
 
-        auto stageBuffer = Buffer::createStageBuffer(mDevice, size, pData);
+        VkImageSubresourceRange range{};
+        range.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        range.baseMipLevel   = 0;
+        range.levelCount     = mMipLevels;
+        range.baseArrayLayer = 0;
+        range.layerCount     = mArrayLayers;
 
-        auto commandBuffer = CommandBuffer::create(mDevice, commandPool);
-        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-        
-        commandBuffer->copyBufferToImage(stageBuffer->getBuffer(),
-                                         mImage,
-                                         mLayout,
-                                         mWidth,
-                                         mHeight);
+        VkAccessFlags dstAccess = finalLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ? VK_ACCESS_SHADER_READ_BIT
+                                                                                           : VK_ACCESS_MEMORY_READ_BIT;
 
-        commandBuffer->end();
+        uploadEngine->uploadImage(mImage, mFormat, regions, pData, static_cast<VkDeviceSize>(size), range, finalLayout, dstStage, dstAccess);
 
-        commandBuffer->submitSync(mDevice->getGraphicQueue());
+        mLayout = finalLayout;
+    }
+
+    void Image::fillMipLevel(size_t size,
+                             void* pData,
+                             const VkBufferImageCopy& region,
+                             const UploadEngine::Ptr& uploadEngine,
+                             VkImageLayout finalLayout,
+                             VkPipelineStageFlags dstStage)
+    {
+        assert(pData);
+        assert(size);
+
+        VkImageSubresourceRange range{};
+        range.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        range.baseMipLevel   = region.imageSubresource.mipLevel;
+        range.levelCount     = 1;
+        range.baseArrayLayer = region.imageSubresource.baseArrayLayer;
+        range.layerCount     = region.imageSubresource.layerCount;
+
+        VkAccessFlags dstAccess = finalLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ? VK_ACCESS_SHADER_READ_BIT
+                                                                                           : VK_ACCESS_MEMORY_READ_BIT;
+
+        uploadEngine->uploadImage(mImage, mFormat, { region }, pData, static_cast<VkDeviceSize>(size), range, finalLayout, dstStage, dstAccess);
+
+        // 只记录已写入级别的布局；未写入的级别仍为 UNDEFINED，不能被视图包含
+        mLayout = finalLayout;
+    }
+
+    void Image::fillImageDataAndGenerateMips(size_t size,
+                                             void* pData,
+                                             const UploadEngine::Ptr& uploadEngine,
+                                             VkImageLayout finalLayout,
+                                             VkPipelineStageFlags dstStage)
+    {
+        assert(pData);
+
+        fillImageDataAndGenerateMips(size, [pData, size](void* pStaging) { memcpy(pStaging, pData, size); }, uploadEngine, finalLayout, dstStage);
+    }
+
+    void Image::fillImageDataAndGenerateMips(size_t size,
+                                             const std::function<void(void*)>& writer,
+                                             const UploadEngine::Ptr& uploadEngine,
+                                             VkImageLayout finalLayout,
+                                             VkPipelineStageFlags dstStage)
+    {
+        assert(size);
+
+        VkImageSubresourceRange range{};
+        range.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        range.baseMipLevel   = 0;
+        range.levelCount     = mMipLevels;
+        range.baseArrayLayer = 0;
+        range.layerCount     = mArrayLayers;
+
+        VkAccessFlags dstAccess = finalLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ? VK_ACCESS_SHADER_READ_BIT
+                                                                                           : VK_ACCESS_MEMORY_READ_BIT;
+
+        uploadEngine->uploadImageAndGenerateMips(mImage,
+                                                 mFormat,
+                                                 static_cast<uint32_t>(mWidth),
+                                                 static_cast<uint32_t>(mHeight),
+                                                 writer,
+                                                 static_cast<VkDeviceSize>(size),
+                                                 range,
+                                                 finalLayout,
+                                                 dstStage,
+                                                 dstAccess);
+
+        mLayout = finalLayout;
     }
 }
@@ -3,9 +3,14 @@
 #include "base.h"
 #include "device.h"
 #include "commandPool.h"
+#include "commandBuffer.h"
+
+#include <functional>
 
 namespace LearnVulkan::Wrapper
 {
+    class UploadEngine;
+
     class Image
     {
     public:
@@ -25,7 +30,10 @@ namespace LearnVulkan::Wrapper
                           const VkImageUsageFlags& usage,
                           const VkSampleCountFlagBits& sample,
                           const VkMemoryPropertyFlags& properties,
-                          const VkImageAspectFlags& aspectFlags)
+                          const VkImageAspectFlags& aspectFlags,
+                          uint32_t mipLevels = 1,
+                          uint32_t arrayLayers = 1,
+                          VkImageCreateFlags flags = 0)
         {
             return std::make_shared<Image>(device,
                                            width,
@@ -36,11 +44,14 @@ namespace LearnVulkan::Wrapper
                                            usage,
                                            sample,
                                            properties,
-                                           aspectFlags);
+                                           aspectFlags,
+                                           mipLevels,
+                                           arrayLayers,
+                                           flags);
         }
 
 		// VkFormat : 每一个像素的格式
-        // 
+        // arrayLayers > 1 时视图为 2D 数组；flags 带 CUBE_COMPATIBLE 时视图为立方体（层数为 6 的倍数）
         Image(const Device::Ptr &device,
               const int& width,
               const int& height,
@@ -50,7 +61,10 @@ namespace LearnVulkan::Wrapper
               const VkImageUsageFlags &usage,
               const VkSampleCountFlagBits &sample,
               const VkMemoryPropertyFlags &properties,
-              const VkImageAspectFlags &aspectFlags);
+              const VkImageAspectFlags &aspectFlags,
+              uint32_t mipLevels = 1,
+              uint32_t arrayLayers = 1,
+              VkImageCreateFlags flags = 0);
 
         ~Image();
 
@@ -60,13 +74,73 @@ namespace LearnVulkan::Wrapper
                             VkImageSubresourceRange subresrouceRange,
                             const CommandPool::Ptr & commandPool);
 
-        void fillImageData(size_t size, void* pData, const CommandPool::Ptr &commandPool);
+        /// 只把布局转换录制进已处于录制状态的命令缓冲（例如暂存环的传输命令缓冲）
+        void setImageLayout(VkImageLayout newLayout,
+                            VkPipelineStageFlags srcStageMask,
+                            VkPipelineStageFlags dstStageMask,
+                            VkImageSubresourceRange subresrouceRange,
+                            const CommandBuffer::Ptr& commandBuffer);
+
+        /// 像素数据经上传引擎在传输队列上拷贝，完成后图像处于 finalLayout，
+        /// 由图形队列在 dstStage 阶段第一次使用；只写第 0 级
+        void fillImageData(size_t size,
+                           void* pData,
+                           const std::shared_ptr<UploadEngine>& uploadEngine,
+                           VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        /// 第 0 级的 size 字节由 writer 直接写进暂存内存（见 UploadEngine::StagingWriter）
+        void fillImageData(size_t size,
+                           const std::function<void(void*)>& writer,
+                           const std::shared_ptr<UploadEngine>& uploadEngine,
+                           VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        /// 整条 mip 链一次拷贝，regions 中的 bufferOffset 相对 pData
+        void fillImageData(size_t size,
+                           void* pData,
+                           const std::vector<VkBufferImageCopy>& regions,
+                           const std::shared_ptr<UploadEngine>& uploadEngine,
+                           VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        /// 只写 region 指定的一级（所有层），该级从 UNDEFINED 转换到 finalLayout，其余级别不受影响；
+        /// 用于流式加载，着色器只能通过不包含未写入级别的视图（见 getImageView(baseMipLevel)）读取
+        void fillMipLevel(size_t size,
+                          void* pData,
+                          const VkBufferImageCopy& region,
+                          const std::shared_ptr<UploadEngine>& uploadEngine,
+                          VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        /// 只上传第 0 级，其余各级由 GPU blit 生成（需 TRANSFER_SRC 用途且 supportsLinearBlit 为 true）
+        void fillImageDataAndGenerateMips(size_t size,
+                                          void* pData,
+                                          const std::shared_ptr<UploadEngine>& uploadEngine,
+                                          VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                          VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        void fillImageDataAndGenerateMips(size_t size,
+                                          const std::function<void(void*)>& writer,
+                                          const std::shared_ptr<UploadEngine>& uploadEngine,
+                                          VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                          VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
         [[nodiscard]] auto getImage()     const { return mImage; }
         [[nodiscard]] auto getLayout()    const { return mLayout; }
         [[nodiscard]] auto getWidth()     const { return mWidth; }
         [[nodiscard]] auto getHeight()    const { return mHeight; }
         [[nodiscard]] auto getImageView() const { return mImageView; }
+        [[nodiscard]] auto getFormat()    const { return mFormat; }
+        [[nodiscard]] auto getMipLevels() const { return mMipLevels; }
+        [[nodiscard]] auto getArrayLayers() const { return mArrayLayers; }
+
+        /// 图像占用的显存（子分配大小）与所在的内存堆
+        [[nodiscard]] auto getMemorySize() const { return mAllocation.mSize; }
+        [[nodiscard]] uint32_t getMemoryHeapIndex() const;
+
+        /// 从 baseMipLevel 开始到最后一级的视图，首次请求时创建，随图像一起销毁
+        VkImageView getImageView(uint32_t baseMipLevel);
 
     public:
         static VkFormat findDepthFormat(const Device::Ptr& device);
@@ -78,17 +152,28 @@ namespace LearnVulkan::Wrapper
 
         bool hasStencilComponent(VkFormat format) const;
 
-    private:
-        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+        /// 完整 mip 链的级数：floor(log2(max(width, height))) + 1
+        static uint32_t getMipLevelCount(uint32_t width, uint32_t height);
+
+        /// 格式在给定平铺方式下是否具备全部 features（不抛异常，用于选择回退路径）
+        static bool isFormatSupported(const Device::Ptr& device, VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features);
+
+        /// 最优平铺下格式能否作为 blit 源 / 目标并线性过滤（GPU 生成 mip 的前提）
+        static bool supportsLinearBlit(const Device::Ptr& device, VkFormat format);
 
     private:
         size_t         mWidth{ 0 };
         size_t         mHeight{ 0 };
         Device::Ptr    mDevice{ nullptr };
         VkImage        mImage{ VK_NULL_HANDLE };        //句柄
-        VkDeviceMemory mImageMemory{ VK_NULL_HANDLE };  //内存
+        MemoryAllocation mAllocation{};                 //内存（分配器中的一段子分配）
         VkImageView    mImageView{ VK_NULL_HANDLE };    //控制器
+        std::vector<VkImageView> mLevelViews{};         //按 baseMipLevel 索引的部分视图（流式加载）
         VkFormat       mFormat{ VK_FORMAT_UNDEFINED };
         VkImageLayout  mLayout{ VK_IMAGE_LAYOUT_UNDEFINED };
+        uint32_t       mMipLevels{ 1 };
+        uint32_t       mArrayLayers{ 1 };
+        VkImageViewType    mViewType{ VK_IMAGE_VIEW_TYPE_2D };
+        VkImageAspectFlags mAspectFlags{ 0 };
     };
 }
@@ -61,7 +61,7 @@ namespace LearnVulkan::Wrapper
         appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
         appInfo.pEngineName        = "NO ENGINE";
         appInfo.engineVersion      = VK_MAKE_VERSION(1, 0, 0);
-        appInfo.apiVersion         = VK_API_VERSION_1_0;
+        appInfo.apiVersion         = VK_API_VERSION_1_2;  // 时间线信号量为 1.2 核心特性
 
         VkInstanceCreateInfo instCreateInfo = {};
         instCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -122,7 +122,12 @@ namespace LearnVulkan::Wrapper
 
         const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        // 未初始化 GLFW（无窗口的计算程序）时返回空，只需要调试扩展
+        std::vector<const char*> extensions{};
+        if (glfwExtensions != nullptr)
+        {
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
@@ -0,0 +1,651 @@
+﻿#include "memoryAllocator.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace LearnVulkan::Wrapper
+{
+    static uint32_t findMostSignificantBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanReverse64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+
+    static uint32_t findLeastSignificantBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanForward64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // ==================================================================
+    // TlsfMetadata
+    // ==================================================================
+
+    TlsfMetadata::TlsfMetadata(VkDeviceSize size)
+    {
+        mSize = size / GRANULARITY * GRANULARITY;
+
+        mFirstPhysical          = new Node();
+        mFirstPhysical->mOffset = 0;
+        mFirstPhysical->mSize   = mSize;
+
+        insertFree(mFirstPhysical);
+    }
+
+    TlsfMetadata::~TlsfMetadata()
+    {
+        Node* node = mFirstPhysical;
+        while (node != nullptr)
+        {
+            Node* next = node->mNextPhysical;
+            delete node;
+            node = next;
+        }
+    }
+
+    void TlsfMetadata::mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl)
+    {
+        // 第一级：size 的最高位；第二级：最高位之后的 SL_BITS 位
+        fl = findMostSignificantBit(size);
+
+        VkDeviceSize shifted = fl >= SL_BITS ? (size >> (fl - SL_BITS)) : (size << (SL_BITS - fl));
+        sl = static_cast<uint32_t>(shifted) ^ SL_COUNT;
+    }
+
+    TlsfMetadata::Node* TlsfMetadata::findSuitableNode(VkDeviceSize size)
+    {
+        // 向上取整到下一档，保证取到的链表里任何一个块都足够大
+        VkDeviceSize roundedSize = size;
+        uint32_t     msb         = findMostSignificantBit(size);
+        if (msb >= SL_BITS)
+        {
+            roundedSize += (VkDeviceSize(1) << (msb - SL_BITS)) - 1;
+        }
+
+        uint32_t fl = 0, sl = 0;
+        mapping(roundedSize, fl, sl);
+
+        uint32_t slMap = mSecondLevelBitmap[fl] & (~0u << sl);
+        if (slMap == 0)
+        {
+            uint64_t flMap = fl + 1 < FL_COUNT ? (mFirstLevelBitmap & (~uint64_t(0) << (fl + 1))) : 0;
+            if (flMap == 0)
+            {
+                // 更大的档位都空了：在 size 所在档位里逐个找一个放得下的块
+                mapping(size, fl, sl);
+                for (Node* node = mFreeLists[fl][sl]; node != nullptr; node = node->mNextFree)
+                {
+                    if (node->mSize >= size)
+                    {
+                        return node;
+                    }
+                }
+
+                return nullptr;
+            }
+
+            fl    = findLeastSignificantBit(flMap);
+            slMap = mSecondLevelBitmap[fl];
+        }
+
+        sl = findLeastSignificantBit(slMap);
+
+        return mFreeLists[fl][sl];
+    }
+
+    void TlsfMetadata::insertFree(Node* node)
+    {
+        uint32_t fl = 0, sl = 0;
+        mapping(node->mSize, fl, sl);
+
+        node->mFree     = true;
+        node->mPrevFree = nullptr;
+        node->mNextFree = mFreeLists[fl][sl];
+
+        if (node->mNextFree != nullptr)
+        {
+            node->mNextFree->mPrevFree = node;
+        }
+
+        mFreeLists[fl][sl] = node;
+
+        mFirstLevelBitmap      |= uint64_t(1) << fl;
+        mSecondLevelBitmap[fl] |= 1u << sl;
+    }
+
+    void TlsfMetadata::removeFree(Node* node)
+    {
+        uint32_t fl = 0, sl = 0;
+        mapping(node->mSize, fl, sl);
+
+        if (node->mPrevFree != nullptr)
+        {
+            node->mPrevFree->mNextFree = node->mNextFree;
+        }
+
+        if (node->mNextFree != nullptr)
+        {
+            node->mNextFree->mPrevFree = node->mPrevFree;
+        }
+
+        if (mFreeLists[fl][sl] == node)
+        {
+            mFreeLists[fl][sl] = node->mNextFree;
+
+            if (mFreeLists[fl][sl] == nullptr)
+            {
+                mSecondLevelBitmap[fl] &= ~(1u << sl);
+
+                if (mSecondLevelBitmap[fl] == 0)
+                {
+                    mFirstLevelBitmap &= ~(uint64_t(1) << fl);
+                }
+            }
+        }
+
+        node->mPrevFree = nullptr;
+        node->mNextFree = nullptr;
+        node->mFree     = false;
+    }
+
+    TlsfMetadata::Node* TlsfMetadata::allocate(VkDeviceSize size, VkDeviceSize alignment)
+    {
+        size      = alignUp(std::max<VkDeviceSize>(size, 1), GRANULARITY);
+        alignment = std::max<VkDeviceSize>(alignment, GRANULARITY);
+
+        // 先按原始大小查找，取到的块恰好满足对齐时可省去补齐
+        Node* node = findSuitableNode(size);
+        if (node == nullptr || alignUp(node->mOffset, alignment) - node->mOffset + size > node->mSize)
+        {
+            // 偏移本身是 16 的倍数，对齐补齐最多需要 alignment - 16 字节
+            VkDeviceSize searchSize = size + (alignment - GRANULARITY);
+            node = searchSize <= mSize ? findSuitableNode(searchSize) : nullptr;
+        }
+
+        if (node == nullptr || alignUp(node->mOffset, alignment) - node->mOffset + size > node->mSize)
+        {
+            return nullptr;
+        }
+
+        removeFree(node);
+
+        // 前部对齐补齐：切出一个独立的空闲块
+        VkDeviceSize padding = alignUp(node->mOffset, alignment) - node->mOffset;
+        if (padding > 0)
+        {
+            Node* paddingNode          = new Node();
+            paddingNode->mOffset       = node->mOffset;
+            paddingNode->mSize         = padding;
+            paddingNode->mPrevPhysical = node->mPrevPhysical;
+            paddingNode->mNextPhysical = node;
+
+            if (node->mPrevPhysical != nullptr)
+            {
+                node->mPrevPhysical->mNextPhysical = paddingNode;
+            }
+            else
+            {
+                mFirstPhysical = paddingNode;
+            }
+
+            node->mPrevPhysical = paddingNode;
+            node->mOffset      += padding;
+            node->mSize        -= padding;
+
+            insertFree(paddingNode);
+        }
+
+        // 尾部剩余空间：切回空闲链表
+        if (node->mSize > size)
+        {
+            Node* restNode          = new Node();
+            restNode->mOffset       = node->mOffset + size;
+            restNode->mSize         = node->mSize - size;
+            restNode->mPrevPhysical = node;
+            restNode->mNextPhysical = node->mNextPhysical;
+
+            if (node->mNextPhysical != nullptr)
+            {
+                node->mNextPhysical->mPrevPhysical = restNode;
+            }
+
+            node->mNextPhysical = restNode;
+            node->mSize         = size;
+
+            insertFree(restNode);
+        }
+
+        node->mFree = false;
+        mUsedSize  += node->mSize;
+        ++mAllocationCount;
+
+        return node;
+    }
+
+    void TlsfMetadata::free(Node* node)
+    {
+        mUsedSize -= node->mSize;
+        --mAllocationCount;
+
+        // 与物理相邻的空闲块合并，避免碎片
+        Node* prev = node->mPrevPhysical;
+        if (prev != nullptr && prev->mFree)
+        {
+            removeFree(prev);
+
+            prev->mSize        += node->mSize;
+            prev->mNextPhysical = node->mNextPhysical;
+
+            if (node->mNextPhysical != nullptr)
+            {
+                node->mNextPhysical->mPrevPhysical = prev;
+            }
+
+            delete node;
+            node = prev;
+        }
+
+        Node* next = node->mNextPhysical;
+        if (next != nullptr && next->mFree)
+        {
+            removeFree(next);
+
+            node->mSize        += next->mSize;
+            node->mNextPhysical = next->mNextPhysical;
+
+            if (next->mNextPhysical != nullptr)
+            {
+                next->mNextPhysical->mPrevPhysical = node;
+            }
+
+            delete next;
+        }
+
+        insertFree(node);
+    }
+
+    void TlsfMetadata::getFreeRegionInfo(uint32_t& regionCount, VkDeviceSize& largestRegion) const
+    {
+        regionCount   = 0;
+        largestRegion = 0;
+
+        for (const Node* node = mFirstPhysical; node != nullptr; node = node->mNextPhysical)
+        {
+            if (node->mFree)
+            {
+                ++regionCount;
+                largestRegion = std::max(largestRegion, node->mSize);
+            }
+        }
+    }
+
+    // ==================================================================
+    // MemoryBlock
+    // ==================================================================
+
+    MemoryBlock::MemoryBlock(VkDevice device, uint32_t memoryTypeIndex, VkDeviceSize size, bool mapped, bool linear, bool dedicated)
+        : mMetadata(size)
+    {
+        mDevice          = device;
+        mMemoryTypeIndex = memoryTypeIndex;
+        mLinear          = linear;
+        mDedicated       = dedicated;
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize  = mMetadata.getSize();
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+        if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &mMemory) != VK_SUCCESS)
+        {
+            mMemory = VK_NULL_HANDLE;
+            return;
+        }
+
+        // HOST_VISIBLE 的块整体常驻映射，子分配直接用 基址 + 偏移 访问
+        if (mapped)
+        {
+            void* data = nullptr;
+            if (vkMapMemory(mDevice, mMemory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Error: failed to map memory block!");
+            }
+
+            mMappedData = static_cast<uint8_t*>(data);
+        }
+    }
+
+    MemoryBlock::~MemoryBlock()
+    {
+        if (mMemory != VK_NULL_HANDLE)
+        {
+            if (mMappedData != nullptr)
+            {
+                vkUnmapMemory(mDevice, mMemory);
+            }
+
+            vkFreeMemory(mDevice, mMemory, nullptr);
+        }
+    }
+
+    // ==================================================================
+    // MemoryAllocator
+    // ==================================================================
+
+    MemoryAllocator::MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, bool memoryBudget)
+    {
+        mDevice         = device;
+        mPhysicalDevice = physicalDevice;
+        mMemoryBudget   = memoryBudget;
+
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &mMemoryProperties);
+
+        VkPhysicalDeviceProperties deviceProps{};
+        vkGetPhysicalDeviceProperties(physicalDevice, &deviceProps);
+        mMaxAllocationCount = deviceProps.limits.maxMemoryAllocationCount;
+
+        // 小堆（集成显卡 / BAR）取堆大小的 1/8，大堆固定 256MB
+        constexpr VkDeviceSize LARGE_HEAP_THRESHOLD = 1024ull * 1024 * 1024;
+        constexpr VkDeviceSize DEFAULT_BLOCK_SIZE   = 256ull * 1024 * 1024;
+
+        for (uint32_t i = 0; i < mMemoryProperties.memoryHeapCount; ++i)
+        {
+            VkDeviceSize heapSize = mMemoryProperties.memoryHeaps[i].size;
+            mPreferredBlockSizes[i] = heapSize <= LARGE_HEAP_THRESHOLD ? alignUp(heapSize / 8, 32) : DEFAULT_BLOCK_SIZE;
+        }
+
+        mPools.resize(mMemoryProperties.memoryTypeCount * 2);
+    }
+
+    MemoryAllocator::~MemoryAllocator()
+    {
+        mDedicatedBlocks.clear();
+        mPools.clear();
+    }
+
+    uint32_t MemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+    {
+        for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; ++i)
+        {
+            if ((typeFilter & (1 << i)) && ((mMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties))
+            {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("Error: cannot find the property memory type!");
+    }
+
+    MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, bool dedicated)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+        uint32_t heapIndex       = mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+        bool     mapped          = (mMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+
+        VkDeviceSize blockSize = mPreferredBlockSizes[heapIndex];
+
+        MemoryBlock*        block = nullptr;
+        TlsfMetadata::Node* node  = nullptr;
+
+        if (dedicated || requirements.size > blockSize / 2)
+        {
+            // 超过半个大块的资源（或调用方要求时）单独申请，避免一个大纹理吃掉整块
+            auto dedicatedBlock = std::make_unique<MemoryBlock>(mDevice, memoryTypeIndex, alignUp(requirements.size, TlsfMetadata::GRANULARITY), mapped, linear, true);
+            if (dedicatedBlock->getMemory() == VK_NULL_HANDLE)
+            {
+                throw std::runtime_error("Error: failed to allocate memory!");
+            }
+
+            node  = dedicatedBlock->getMetadata().allocate(requirements.size, requirements.alignment);
+            block = dedicatedBlock.get();
+
+            trackUsage(memoryTypeIndex, static_cast<int64_t>(dedicatedBlock->getMetadata().getSize()), 0);
+
+            mDedicatedBlocks.push_back(std::move(dedicatedBlock));
+            ++mDeviceAllocationCount;
+        }
+        else
+        {
+            auto& pool = getPool(memoryTypeIndex, linear);
+
+            for (auto& candidate : pool.mBlocks)
+            {
+                node = candidate->getMetadata().allocate(requirements.size, requirements.alignment);
+                if (node != nullptr)
+                {
+                    block = candidate.get();
+                    break;
+                }
+            }
+
+            // 现有大块都放不下：申请新块，显存紧张时逐级减半重试
+            for (VkDeviceSize size = blockSize; node == nullptr && size >= requirements.size; size /= 2)
+            {
+                auto newBlock = std::make_unique<MemoryBlock>(mDevice, memoryTypeIndex, size, mapped, linear, false);
+                if (newBlock->getMemory() == VK_NULL_HANDLE)
+                {
+                    continue;
+                }
+
+                node = newBlock->getMetadata().allocate(requirements.size, requirements.alignment);
+                if (node == nullptr)
+                {
+                    continue;
+                }
+
+                block = newBlock.get();
+                trackUsage(memoryTypeIndex, static_cast<int64_t>(size), 0);
+
+                pool.mBlocks.push_back(std::move(newBlock));
+                ++mDeviceAllocationCount;
+            }
+
+            if (node == nullptr)
+            {
+                throw std::runtime_error("Error: failed to allocate memory!");
+            }
+        }
+
+        if (mDeviceAllocationCount > mMaxAllocationCount)
+        {
+            std::cerr << "Warning: device memory allocation count (" << mDeviceAllocationCount
+                      << ") exceeds maxMemoryAllocationCount (" << mMaxAllocationCount << ")" << std::endl;
+        }
+
+        trackUsage(memoryTypeIndex, 0, static_cast<int64_t>(node->mSize));
+
+        MemoryAllocation allocation{};
+        allocation.mMemory          = block->getMemory();
+        allocation.mOffset          = node->mOffset;
+        allocation.mSize            = node->mSize;
+        allocation.mMappedData      = block->getMappedData() != nullptr ? block->getMappedData() + node->mOffset : nullptr;
+        allocation.mMemoryTypeIndex = memoryTypeIndex;
+        allocation.mBlock           = block;
+        allocation.mNode            = node;
+
+        return allocation;
+    }
+
+    void MemoryAllocator::free(MemoryAllocation& allocation)
+    {
+        if (!allocation.isValid())
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        MemoryBlock* block = allocation.mBlock;
+        block->getMetadata().free(allocation.mNode);
+
+        trackUsage(allocation.mMemoryTypeIndex, 0, -static_cast<int64_t>(allocation.mSize));
+
+        auto eraseBlock = [this, block](std::vector<std::unique_ptr<MemoryBlock>>& blocks)
+        {
+            for (auto it = blocks.begin(); it != blocks.end(); ++it)
+            {
+                if (it->get() == block)
+                {
+                    trackUsage(block->getMemoryTypeIndex(), -static_cast<int64_t>(block->getMetadata().getSize()), 0);
+                    blocks.erase(it);
+                    --mDeviceAllocationCount;
+                    return;
+                }
+            }
+        };
+
+        if (block->isDedicated())
+        {
+            eraseBlock(mDedicatedBlocks);
+        }
+        else if (block->getMetadata().isEmpty())
+        {
+            // 每个池最多保留一个空块，避免加载 / 卸载抖动时反复申请释放
+            auto& pool = getPool(block->getMemoryTypeIndex(), block->isLinear());
+
+            int emptyCount = 0;
+            for (const auto& candidate : pool.mBlocks)
+            {
+                emptyCount += candidate->getMetadata().isEmpty() ? 1 : 0;
+            }
+
+            if (emptyCount > 1)
+            {
+                eraseBlock(pool.mBlocks);
+            }
+        }
+
+        allocation = MemoryAllocation{};
+    }
+
+    void MemoryAllocator::trackUsage(uint32_t memoryTypeIndex, int64_t blockDelta, int64_t usedDelta)
+    {
+        uint32_t heapIndex = mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+
+        mHeapBlockBytes[heapIndex] = static_cast<VkDeviceSize>(static_cast<int64_t>(mHeapBlockBytes[heapIndex]) + blockDelta);
+        mHeapUsedBytes[heapIndex]  = static_cast<VkDeviceSize>(static_cast<int64_t>(mHeapUsedBytes[heapIndex]) + usedDelta);
+
+        mPeakHeapBlockBytes[heapIndex] = std::max(mPeakHeapBlockBytes[heapIndex], mHeapBlockBytes[heapIndex]);
+        mPeakHeapUsedBytes[heapIndex]  = std::max(mPeakHeapUsedBytes[heapIndex], mHeapUsedBytes[heapIndex]);
+    }
+
+    std::vector<MemoryHeapStats> MemoryAllocator::getHeapStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        std::vector<MemoryHeapStats> stats(mMemoryProperties.memoryHeapCount);
+        for (uint32_t i = 0; i < mMemoryProperties.memoryHeapCount; ++i)
+        {
+            stats[i].mHeapIndex      = i;
+            stats[i].mHeapSize       = mMemoryProperties.memoryHeaps[i].size;
+            stats[i].mPeakBlockBytes = mPeakHeapBlockBytes[i];
+            stats[i].mPeakUsedBytes  = mPeakHeapUsedBytes[i];
+        }
+
+        auto accumulate = [&](const MemoryBlock& block)
+        {
+            auto& heap = stats[mMemoryProperties.memoryTypes[block.getMemoryTypeIndex()].heapIndex];
+
+            uint32_t     regionCount   = 0;
+            VkDeviceSize largestRegion = 0;
+            block.getMetadata().getFreeRegionInfo(regionCount, largestRegion);
+
+            heap.mBlockCount        += 1;
+            heap.mAllocationCount   += block.getMetadata().getAllocationCount();
+            heap.mBlockBytes        += block.getMetadata().getSize();
+            heap.mUsedBytes         += block.getMetadata().getUsedSize();
+            heap.mFreeRegionCount   += regionCount;
+            heap.mLargestFreeRegion  = std::max(heap.mLargestFreeRegion, largestRegion);
+        };
+
+        for (const auto& pool : mPools)
+        {
+            for (const auto& block : pool.mBlocks)
+            {
+                accumulate(*block);
+            }
+        }
+
+        for (const auto& block : mDedicatedBlocks)
+        {
+            accumulate(*block);
+        }
+
+        return stats;
+    }
+
+    MemoryHeapBudget MemoryAllocator::getHeapBudget(uint32_t heapIndex) const
+    {
+        MemoryHeapBudget budget{};
+        budget.mHeapIndex = heapIndex;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            budget.mUsage     = mHeapBlockBytes[heapIndex];
+            budget.mUsedBytes = mHeapUsedBytes[heapIndex];
+        }
+
+        if (mMemoryBudget)
+        {
+            VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{};
+            budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+            VkPhysicalDeviceMemoryProperties2 memoryProps{};
+            memoryProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+            memoryProps.pNext = &budgetProps;
+
+            vkGetPhysicalDeviceMemoryProperties2(mPhysicalDevice, &memoryProps);
+
+            budget.mBudget = budgetProps.heapBudget[heapIndex];
+            budget.mUsage  = budgetProps.heapUsage[heapIndex];
+        }
+        else
+        {
+            // 没有驱动提供的预算时留出 20% 给驱动内部、交换链和其他进程
+            budget.mBudget = mMemoryProperties.memoryHeaps[heapIndex].size / 10 * 8;
+        }
+
+        return budget;
+    }
+
+    void MemoryAllocator::printStats() const
+    {
+        constexpr double MB = 1024.0 * 1024.0;
+
+        for (const auto& heap : getHeapStats())
+        {
+            if (heap.mBlockCount == 0)
+            {
+                continue;
+            }
+
+            std::cout << "Memory heap " << heap.mHeapIndex
+                      << ": blocks " << heap.mBlockCount
+                      << ", allocations " << heap.mAllocationCount
+                      << ", used " << heap.mUsedBytes / MB << " / " << heap.mBlockBytes / MB << " MB"
+                      << " (heap " << heap.mHeapSize / MB << " MB)"
+                      << ", free regions " << heap.mFreeRegionCount
+                      << ", largest free " << heap.mLargestFreeRegion / MB << " MB"
+                      << ", fragmentation " << heap.getFragmentation() * 100.0f << "%"
+                      << std::endl;
+        }
+    }
+}
@@ -0,0 +1,216 @@
+﻿#pragma once
+
+#include "base.h"
+#include <mutex>
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // TLSF（Two-Level Segregated Fit）子分配元数据
+    // 只管理一段 [0, size) 的偏移空间，不接触任何 Vulkan 对象，
+    // 分配 / 释放均为 O(1)（两级位图查找 + 物理相邻块合并）
+    // ==================================================================
+    class TlsfMetadata
+    {
+    public:
+        struct Node
+        {
+            VkDeviceSize mOffset{ 0 };
+            VkDeviceSize mSize{ 0 };
+            bool         mFree{ true };
+            Node*        mPrevPhysical{ nullptr };
+            Node*        mNextPhysical{ nullptr };
+            Node*        mPrevFree{ nullptr };
+            Node*        mNextFree{ nullptr };
+        };
+
+        explicit TlsfMetadata(VkDeviceSize size);
+
+        ~TlsfMetadata();
+
+        TlsfMetadata(const TlsfMetadata&) = delete;
+        TlsfMetadata& operator=(const TlsfMetadata&) = delete;
+
+        /// 分配成功返回节点句柄，失败返回 nullptr
+        Node* allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+        void free(Node* node);
+
+        [[nodiscard]] bool         isEmpty()             const { return mAllocationCount == 0; }
+        [[nodiscard]] VkDeviceSize getSize()             const { return mSize; }
+        [[nodiscard]] VkDeviceSize getUsedSize()         const { return mUsedSize; }
+        [[nodiscard]] uint32_t     getAllocationCount()  const { return mAllocationCount; }
+
+        /// 遍历物理链表统计空闲区间（仅用于统计输出，非热路径）
+        void getFreeRegionInfo(uint32_t& regionCount, VkDeviceSize& largestRegion) const;
+
+    public:
+        static constexpr VkDeviceSize GRANULARITY = 16;  // 所有偏移与大小都按 16 字节对齐
+
+    private:
+        static constexpr uint32_t SL_BITS  = 4;                 // 每一级再细分 16 档
+        static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+        static constexpr uint32_t FL_COUNT = 64;
+
+        static void mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl);
+
+        Node* findSuitableNode(VkDeviceSize size);
+
+        void insertFree(Node* node);
+
+        void removeFree(Node* node);
+
+    private:
+        VkDeviceSize mSize{ 0 };
+        VkDeviceSize mUsedSize{ 0 };
+        uint32_t     mAllocationCount{ 0 };
+
+        uint64_t mFirstLevelBitmap{ 0 };
+        uint32_t mSecondLevelBitmap[FL_COUNT]{};
+        Node*    mFreeLists[FL_COUNT][SL_COUNT]{};
+        Node*    mFirstPhysical{ nullptr };
+    };
+
+    class MemoryBlock;
+
+    /// 一次子分配的结果：Buffer / Image 用 (mMemory, mOffset) 绑定内存
+    struct MemoryAllocation
+    {
+        VkDeviceMemory      mMemory{ VK_NULL_HANDLE };
+        VkDeviceSize        mOffset{ 0 };
+        VkDeviceSize        mSize{ 0 };
+        void*               mMappedData{ nullptr };  // HOST_VISIBLE 内存块常驻映射后的地址，否则为空
+        uint32_t            mMemoryTypeIndex{ 0 };
+        MemoryBlock*        mBlock{ nullptr };
+        TlsfMetadata::Node* mNode{ nullptr };
+
+        [[nodiscard]] bool isValid() const { return mMemory != VK_NULL_HANDLE; }
+    };
+
+    /// 一个 VkDeviceMemory 大块，内部用 TLSF 切分
+    class MemoryBlock
+    {
+    public:
+        MemoryBlock(VkDevice device, uint32_t memoryTypeIndex, VkDeviceSize size, bool mapped, bool linear, bool dedicated);
+
+        ~MemoryBlock();
+
+        [[nodiscard]] auto  getMemory()          const { return mMemory; }
+        [[nodiscard]] auto  getMemoryTypeIndex() const { return mMemoryTypeIndex; }
+        [[nodiscard]] bool  isLinear()           const { return mLinear; }
+        [[nodiscard]] bool  isDedicated()        const { return mDedicated; }
+        [[nodiscard]] auto* getMappedData()      const { return mMappedData; }
+        [[nodiscard]] auto& getMetadata()              { return mMetadata; }
+        [[nodiscard]] auto& getMetadata()        const { return mMetadata; }
+
+    private:
+        VkDevice       mDevice{ VK_NULL_HANDLE };
+        VkDeviceMemory mMemory{ VK_NULL_HANDLE };
+        uint32_t       mMemoryTypeIndex{ 0 };
+        bool           mLinear{ true };
+        bool           mDedicated{ false };
+        uint8_t*       mMappedData{ nullptr };
+        TlsfMetadata   mMetadata;
+    };
+
+    /// 每个内存堆的使用情况，用于调整大块尺寸
+    struct MemoryHeapStats
+    {
+        uint32_t     mHeapIndex{ 0 };
+        VkDeviceSize mHeapSize{ 0 };
+        uint32_t     mBlockCount{ 0 };        // vkAllocateMemory 次数（含独占分配）
+        uint32_t     mAllocationCount{ 0 };   // 子分配数量
+        VkDeviceSize mBlockBytes{ 0 };        // 已向驱动申请的字节数
+        VkDeviceSize mUsedBytes{ 0 };         // 子分配实际占用的字节数
+        uint32_t     mFreeRegionCount{ 0 };
+        VkDeviceSize mLargestFreeRegion{ 0 };
+        VkDeviceSize mPeakBlockBytes{ 0 };    // 分配器创建以来 mBlockBytes 的最大值（高水位）
+        VkDeviceSize mPeakUsedBytes{ 0 };     // 分配器创建以来 mUsedBytes 的最大值
+
+        /// 碎片率：1 - 最大空闲区间 / 全部空闲字节，0 表示空闲空间完全连续
+        [[nodiscard]] float getFragmentation() const
+        {
+            VkDeviceSize freeBytes = mBlockBytes - mUsedBytes;
+            return freeBytes == 0 ? 0.0f : 1.0f - static_cast<float>(mLargestFreeRegion) / static_cast<float>(freeBytes);
+        }
+    };
+
+    /// 一个内存堆的预算：启用 VK_EXT_memory_budget 时 mBudget / mUsage 来自驱动（考虑了其他进程的占用），
+    /// 否则 mBudget 取堆大小的 80%，mUsage 为本分配器已申请的大块字节数
+    struct MemoryHeapBudget
+    {
+        uint32_t     mHeapIndex{ 0 };
+        VkDeviceSize mBudget{ 0 };
+        VkDeviceSize mUsage{ 0 };
+        VkDeviceSize mUsedBytes{ 0 };  // 本分配器子分配实际占用的字节数（释放后立即减少，大块可能仍被保留）
+    };
+
+    // ==================================================================
+    // 设备级显存分配器：按内存类型维护大块，Buffer / Image 在块内按偏移绑定，
+    // 避免每个资源一次 vkAllocateMemory 撞上 maxMemoryAllocationCount
+    // ==================================================================
+    class MemoryAllocator
+    {
+    public:
+        using Ptr = std::shared_ptr<MemoryAllocator>;
+
+        static Ptr create(VkDevice device, VkPhysicalDevice physicalDevice, bool memoryBudget = false)
+        {
+            return std::make_shared<MemoryAllocator>(device, physicalDevice, memoryBudget);
+        }
+
+        /// memoryBudget：设备已启用 VK_EXT_memory_budget
+        MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, bool memoryBudget = false);
+
+        ~MemoryAllocator();
+
+        /// linear：Buffer 与 LINEAR 图像为 true，OPTIMAL 图像为 false，
+        /// 两类资源放在不同的块里，从而无需处理 bufferImageGranularity
+        /// dedicated：不从大块子分配，单独申请一块（TRANSIENT 附件等）；超过半个大块的资源总是单独申请
+        MemoryAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, bool dedicated = false);
+
+        void free(MemoryAllocation& allocation);
+
+        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+        std::vector<MemoryHeapStats> getHeapStats() const;
+
+        /// 查询一个堆当前的预算（每次调用都向驱动查询，每帧调用一次即可）
+        MemoryHeapBudget getHeapBudget(uint32_t heapIndex) const;
+
+        void printStats() const;
+
+        [[nodiscard]] const auto& getMemoryProperties() const { return mMemoryProperties; }
+
+        [[nodiscard]] auto getPreferredBlockSize(uint32_t heapIndex) const { return mPreferredBlockSizes[heapIndex]; }
+
+    private:
+        struct Pool
+        {
+            std::vector<std::unique_ptr<MemoryBlock>> mBlocks{};
+        };
+
+        Pool& getPool(uint32_t memoryTypeIndex, bool linear) { return mPools[memoryTypeIndex * 2 + (linear ? 1 : 0)]; }
+
+        /// 记录某个堆的大块 / 子分配字节数变化并更新高水位，调用时已持有 mMutex
+        void trackUsage(uint32_t memoryTypeIndex, int64_t blockDelta, int64_t usedDelta);
+
+    private:
+        VkDevice                         mDevice{ VK_NULL_HANDLE };
+        VkPhysicalDevice                 mPhysicalDevice{ VK_NULL_HANDLE };
+        bool                             mMemoryBudget{ false };
+        VkPhysicalDeviceMemoryProperties mMemoryProperties{};
+        VkDeviceSize                     mPreferredBlockSizes[VK_MAX_MEMORY_HEAPS]{};
+        uint32_t                         mMaxAllocationCount{ 0 };
+        uint32_t                         mDeviceAllocationCount{ 0 };
+
+        VkDeviceSize mHeapBlockBytes[VK_MAX_MEMORY_HEAPS]{};
+        VkDeviceSize mHeapUsedBytes[VK_MAX_MEMORY_HEAPS]{};
+        VkDeviceSize mPeakHeapBlockBytes[VK_MAX_MEMORY_HEAPS]{};
+        VkDeviceSize mPeakHeapUsedBytes[VK_MAX_MEMORY_HEAPS]{};
+
+        std::vector<Pool>                         mPools{};
+        std::vector<std::unique_ptr<MemoryBlock>> mDedicatedBlocks{};
+        mutable std::mutex                        mMutex;
+    };
+}
@@ -0,0 +1,139 @@
+﻿#include "offscreenTarget.h"
+#include "buffer.h"
+#include "commandBuffer.h"
+
+namespace LearnVulkan::Wrapper
+{
+    OffscreenTarget::OffscreenTarget(const Device::Ptr& device, uint32_t width, uint32_t height, uint32_t imageCount, VkFormat format)
+    {
+        mDevice = device;
+        mFormat = format;
+        mExtent = { width, height };
+
+        for (uint32_t i = 0; i < imageCount; ++i)
+        {
+            mColorImages.push_back(Image::create(mDevice,
+                                                 static_cast<int>(width),
+                                                 static_cast<int>(height),
+                                                 mFormat,
+                                                 VK_IMAGE_TYPE_2D,
+                                                 VK_IMAGE_TILING_OPTIMAL,
+                                                 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                                                 VK_SAMPLE_COUNT_1_BIT,
+                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                 VK_IMAGE_ASPECT_COLOR_BIT));
+
+            mDepthImages.push_back(Image::createDepthImage(mDevice, static_cast<int>(width), static_cast<int>(height)));
+        }
+    }
+
+    OffscreenTarget::~OffscreenTarget()
+    {
+        for (auto& frameBuffer : mFrameBuffers)
+        {
+            vkDestroyFramebuffer(mDevice->getDevice(), frameBuffer, nullptr);
+        }
+    }
+
+    void OffscreenTarget::createFrameBuffers(const RenderPass::Ptr& renderPass)
+    {
+        for (auto& frameBuffer : mFrameBuffers)
+        {
+            vkDestroyFramebuffer(mDevice->getDevice(), frameBuffer, nullptr);
+        }
+
+        mFrameBuffers.resize(mColorImages.size());
+
+        for (size_t i = 0; i < mColorImages.size(); ++i)
+        {
+            std::array<VkImageView, 2> attachments = { mColorImages[i]->getImageView(), mDepthImages[i]->getImageView() };
+
+            VkFramebufferCreateInfo frameBufferCreateInfo{};
+            frameBufferCreateInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            frameBufferCreateInfo.renderPass      = renderPass->getRenderPass();
+            frameBufferCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+            frameBufferCreateInfo.pAttachments    = attachments.data();
+            frameBufferCreateInfo.width           = mExtent.width;
+            frameBufferCreateInfo.height          = mExtent.height;
+            frameBufferCreateInfo.layers          = 1;
+
+            if (vkCreateFramebuffer(mDevice->getDevice(), &frameBufferCreateInfo, nullptr, &mFrameBuffers[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Error: failed to create offscreen frameBuffer!");
+            }
+        }
+    }
+
+    void OffscreenTarget::saveImage(uint32_t index, const CommandPool::Ptr& commandPool, const std::string& path)
+    {
+        if (mFormat != VK_FORMAT_R8G8B8A8_SRGB && mFormat != VK_FORMAT_R8G8B8A8_UNORM &&
+            mFormat != VK_FORMAT_B8G8R8A8_SRGB && mFormat != VK_FORMAT_B8G8R8A8_UNORM)
+        {
+            throw std::runtime_error("Error: offscreen readback only supports 8-bit RGBA / BGRA formats!");
+        }
+
+        VkDeviceSize size = VkDeviceSize(mExtent.width) * mExtent.height * 4;
+
+        auto readbackBuffer = Buffer::create(mDevice,
+                                             size,
+                                             VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        auto commandBuffer = CommandBuffer::create(mDevice, commandPool);
+        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        // 之前的提交已完成，但颜色附件的写入仍需对传输读取可见
+        VkImageMemoryBarrier barrier{};
+        barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout                       = FINAL_LAYOUT;
+        barrier.newLayout                       = FINAL_LAYOUT;
+        barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image                           = mColorImages[index]->getImage();
+        barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel   = 0;
+        barrier.subresourceRange.levelCount     = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount     = 1;
+        barrier.srcAccessMask                   = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask                   = VK_ACCESS_TRANSFER_READ_BIT;
+
+        commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        commandBuffer->copyImageToBuffer(mColorImages[index]->getImage(), FINAL_LAYOUT, readbackBuffer->getBuffer(), mExtent.width, mExtent.height);
+
+        commandBuffer->end();
+        commandBuffer->submitSync(mDevice->getGraphicQueue());
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to create " + path);
+        }
+
+        file << "P6\n" << mExtent.width << " " << mExtent.height << "\n255\n";
+
+        bool bgra = mFormat == VK_FORMAT_B8G8R8A8_SRGB || mFormat == VK_FORMAT_B8G8R8A8_UNORM;
+
+        const auto*          pixels = static_cast<const uint8_t*>(readbackBuffer->getAllocation().mMappedData);
+        std::vector<uint8_t> row(size_t(mExtent.width) * 3);
+
+        for (uint32_t y = 0; y < mExtent.height; ++y)
+        {
+            const uint8_t* source = pixels + size_t(y) * mExtent.width * 4;
+
+            for (uint32_t x = 0; x < mExtent.width; ++x)
+            {
+                row[x * 3 + 0] = source[x * 4 + (bgra ? 2 : 0)];
+                row[x * 3 + 1] = source[x * 4 + 1];
+                row[x * 3 + 2] = source[x * 4 + (bgra ? 0 : 2)];
+            }
+
+            file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+        }
+
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to write " + path);
+        }
+    }
+}
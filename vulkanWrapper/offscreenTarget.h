@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include "base.h"
+#include "device.h"
+#include "image.h"
+#include "renderPass.h"
+#include "commandPool.h"
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // 离屏渲染目标：代替交换链提供 imageCount 组颜色 + 深度附件与帧缓冲，没有表面和呈现
+    // 颜色图像带 TRANSFER_SRC 用途，渲染通道的 finalLayout 应为 FINAL_LAYOUT，结束后可直接读回
+    // ==================================================================
+    class OffscreenTarget
+    {
+    public:
+        using Ptr = std::shared_ptr<OffscreenTarget>;
+
+        /// 渲染通道结束时颜色附件应处于的布局
+        static constexpr VkImageLayout FINAL_LAYOUT = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        static Ptr create(const Device::Ptr& device,
+                          uint32_t width,
+                          uint32_t height,
+                          uint32_t imageCount,
+                          VkFormat format = VK_FORMAT_R8G8B8A8_SRGB)
+        {
+            return std::make_shared<OffscreenTarget>(device, width, height, imageCount, format);
+        }
+
+        OffscreenTarget(const Device::Ptr& device, uint32_t width, uint32_t height, uint32_t imageCount, VkFormat format);
+
+        ~OffscreenTarget();
+
+        void createFrameBuffers(const RenderPass::Ptr& renderPass);
+
+        /// 把 index 的颜色图像读回并写成二进制 PPM（P6，RGB 8 位）；调用前对该图像的渲染必须已经完成（例如 vkDeviceWaitIdle 之后）
+        void saveImage(uint32_t index, const CommandPool::Ptr& commandPool, const std::string& path);
+
+        [[nodiscard]] auto getFormat()     const { return mFormat; }
+        [[nodiscard]] auto getImageCount() const { return static_cast<uint32_t>(mColorImages.size()); }
+        [[nodiscard]] auto getFrameBuffer(const int index) const { return mFrameBuffers[index]; }
+        [[nodiscard]] auto getExtent()     const { return mExtent; }
+
+    private:
+        VkFormat   mFormat{ VK_FORMAT_UNDEFINED };
+        VkExtent2D mExtent{};
+
+        std::vector<Image::Ptr>    mColorImages{};
+        std::vector<Image::Ptr>    mDepthImages{};
+        std::vector<VkFramebuffer> mFrameBuffers{};
+
+        Device::Ptr mDevice{ nullptr };
+    };
+}
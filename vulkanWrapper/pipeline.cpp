@@ -1,5 +1,7 @@
 ﻿#include "pipeline.h"
 
+#include <algorithm>
+
 namespace LearnVulkan::Wrapper
 {
     Pipeline::Pipeline(const Device::Ptr& device, const RenderPass::Ptr& renderPass)
@@ -55,6 +57,29 @@ namespace LearnVulkan::Wrapper
         mViewportState.scissorCount = static_cast<uint32_t>(mScissors.size());
         mViewportState.pScissors = mScissors.data();
 
+        // 动态视口 / 裁剪只需要数量，内容由录制时提供
+        auto isDynamic = [this](VkDynamicState state)
+        {
+            return std::find(mDynamicStates.begin(), mDynamicStates.end(), state) != mDynamicStates.end();
+        };
+
+        if (isDynamic(VK_DYNAMIC_STATE_VIEWPORT))
+        {
+            mViewportState.viewportCount = std::max(mViewportState.viewportCount, 1u);
+            mViewportState.pViewports    = nullptr;
+        }
+
+        if (isDynamic(VK_DYNAMIC_STATE_SCISSOR))
+        {
+            mViewportState.scissorCount = std::max(mViewportState.scissorCount, 1u);
+            mViewportState.pScissors    = nullptr;
+        }
+
+        VkPipelineDynamicStateCreateInfo dynamicState{};
+        dynamicState.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(mDynamicStates.size());
+        dynamicState.pDynamicStates    = mDynamicStates.data();
+
         mBlendState.attachmentCount = static_cast<uint32_t>(mBlendAttachmentStates.size());
         mBlendState.pAttachments = mBlendAttachmentStates.data();
 
@@ -81,7 +106,7 @@ namespace LearnVulkan::Wrapper
         pipelineCreateInfo.pMultisampleState = &mSampleState;
         pipelineCreateInfo.pDepthStencilState = &mDepthStencilState;
         pipelineCreateInfo.pColorBlendState = &mBlendState;
-        pipelineCreateInfo.pDynamicState = nullptr;
+        pipelineCreateInfo.pDynamicState = mDynamicStates.empty() ? nullptr : &dynamicState;
 
         pipelineCreateInfo.layout = mLayout;
 
@@ -96,9 +121,22 @@ namespace LearnVulkan::Wrapper
             vkDestroyPipeline(mDevice->getDevice(), mPipeline, nullptr);
         }
 
-        if (vkCreateGraphicsPipelines(mDevice->getDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &mPipeline) != VK_SUCCESS)
+        const auto& pipelineCache = mDevice->getPipelineCache();
+
+        VkPipelineCreationFeedbackEXT           feedback{};
+        VkPipelineCreationFeedbackCreateInfoEXT feedbackInfo{};
+        pipelineCache->attachFeedback(pipelineCreateInfo.pNext, feedbackInfo, feedback);
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        if (vkCreateGraphicsPipelines(mDevice->getDevice(), pipelineCache->getCache(), 1, &pipelineCreateInfo, nullptr, &mPipeline) != VK_SUCCESS)
         {
             throw std::runtime_error("Error: failed to create pipeline!");
         }
+
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        bool   warm         = pipelineCache->recordBuild(milliseconds, feedback);
+
+        std::cout << "Pipeline: built in " << milliseconds << " ms (" << (warm ? "warm" : "cold") << " cache, by " << pipelineCache->getWarmCriterion() << ")" << std::endl;
     }
 }
@@ -27,6 +27,9 @@ namespace LearnVulkan::Wrapper
 
         void setScissors(const std::vector<VkRect2D>& scissors) { mScissors = scissors; }
 
+        /// 声明为动态的状态在录制时通过 vkCmdSet* 设置，例如视口 / 裁剪设为动态后管线不再依赖交换链尺寸
+        void setDynamicStates(const std::vector<VkDynamicState>& dynamicStates) { mDynamicStates = dynamicStates; }
+
         void pushBlendAttachment(const VkPipelineColorBlendAttachmentState& blendAttachment)
         {
             mBlendAttachmentStates.push_back(blendAttachment);
@@ -58,5 +61,7 @@ namespace LearnVulkan::Wrapper
         std::vector<Shader::Ptr> mShaders{};
         std::vector<VkViewport>  mViewports{};
         std::vector<VkRect2D>    mScissors{};
+
+        std::vector<VkDynamicState> mDynamicStates{};
     };
 }
@@ -0,0 +1,202 @@
+﻿#include "pipelineCache.h"
+
+#include <cstring>
+#include <filesystem>
+
+namespace LearnVulkan::Wrapper
+{
+    PipelineCache::PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& path, bool creationFeedback)
+    {
+        mDevice           = device;
+        mPath             = path;
+        mCreationFeedback = creationFeedback;
+
+        vkGetPhysicalDeviceProperties(physicalDevice, &mProperties);
+
+        std::vector<char> data = loadFile();
+        if (!data.empty() && !isCompatible(data))
+        {
+            std::cout << "PipelineCache: " << mPath << " was created by another device or driver, ignoring it" << std::endl;
+            data.clear();
+        }
+
+        VkPipelineCacheCreateInfo createInfo{};
+        createInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        createInfo.initialDataSize = data.size();
+        createInfo.pInitialData    = data.empty() ? nullptr : data.data();
+
+        if (vkCreatePipelineCache(mDevice, &createInfo, nullptr, &mCache) != VK_SUCCESS)
+        {
+            // 驱动仍可能拒绝通过了头部校验的数据，退回空缓存
+            createInfo.initialDataSize = 0;
+            createInfo.pInitialData    = nullptr;
+            data.clear();
+
+            if (vkCreatePipelineCache(mDevice, &createInfo, nullptr, &mCache) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Error: failed to create pipeline cache!");
+            }
+        }
+
+        mLoadedFromDisk = !data.empty();
+
+        std::cout << "PipelineCache: loaded " << data.size() << " bytes from " << mPath << std::endl;
+    }
+
+    PipelineCache::~PipelineCache()
+    {
+        if (mCache != VK_NULL_HANDLE)
+        {
+            save();
+            printStats();
+            vkDestroyPipelineCache(mDevice, mCache, nullptr);
+        }
+    }
+
+    std::vector<char> PipelineCache::loadFile() const
+    {
+        std::ifstream file(mPath, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            return {};
+        }
+
+        std::streamsize size = file.tellg();
+        if (size <= 0)
+        {
+            return {};
+        }
+
+        std::vector<char> data(static_cast<size_t>(size));
+        file.seekg(0);
+        if (!file.read(data.data(), size))
+        {
+            return {};
+        }
+
+        return data;
+    }
+
+    bool PipelineCache::isCompatible(const std::vector<char>& data) const
+    {
+        VkPipelineCacheHeaderVersionOne header{};
+        if (data.size() < sizeof(header))
+        {
+            return false;
+        }
+
+        memcpy(&header, data.data(), sizeof(header));
+
+        return header.headerSize >= sizeof(header) &&
+               header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header.vendorID == mProperties.vendorID &&
+               header.deviceID == mProperties.deviceID &&
+               memcmp(header.pipelineCacheUUID, mProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    void PipelineCache::attachFeedback(const void*& createInfoNext, VkPipelineCreationFeedbackCreateInfoEXT& feedbackInfo, VkPipelineCreationFeedbackEXT& feedback) const
+    {
+        feedback = {};
+
+        if (!mCreationFeedback)
+        {
+            return;
+        }
+
+        feedbackInfo                           = {};
+        feedbackInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+        feedbackInfo.pNext                     = createInfoNext;
+        feedbackInfo.pPipelineCreationFeedback = &feedback;
+
+        createInfoNext = &feedbackInfo;
+    }
+
+    const char* PipelineCache::getWarmCriterion() const
+    {
+        return mCreationFeedback ? "pipeline creation feedback" : "cache loaded from disk";
+    }
+
+    void PipelineCache::save()
+    {
+        size_t size = 0;
+        if (vkGetPipelineCacheData(mDevice, mCache, &size, nullptr) != VK_SUCCESS || size == 0)
+        {
+            return;
+        }
+
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(mDevice, mCache, &size, data.data()) != VK_SUCCESS)
+        {
+            std::cout << "Warning: failed to read pipeline cache data" << std::endl;
+            return;
+        }
+
+        std::string tempPath = mPath + ".tmp";
+
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(size));
+
+            if (!file)
+            {
+                std::cout << "Warning: failed to write " << tempPath << std::endl;
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, mPath, error);
+        if (error)
+        {
+            std::filesystem::remove(tempPath, error);
+            std::cout << "Warning: failed to replace " << mPath << std::endl;
+            return;
+        }
+
+        std::cout << "PipelineCache: saved " << size << " bytes to " << mPath << std::endl;
+    }
+
+    bool PipelineCache::recordBuild(double milliseconds, const VkPipelineCreationFeedbackEXT& feedback)
+    {
+        // 驱动没有写入有效的反馈时退回按启动时是否加载了磁盘缓存判断
+        bool warm = mLoadedFromDisk;
+        if (mCreationFeedback && (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT))
+        {
+            warm = (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) != 0;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (warm)
+        {
+            ++mWarmBuildCount;
+            mWarmMilliseconds += milliseconds;
+        }
+        else
+        {
+            ++mColdBuildCount;
+            mColdMilliseconds += milliseconds;
+        }
+
+        return warm;
+    }
+
+    void PipelineCache::printStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        std::cout << "PipelineCache: " << mColdBuildCount << " cold builds";
+        if (mColdBuildCount > 0)
+        {
+            std::cout << " (avg " << mColdMilliseconds / mColdBuildCount << " ms)";
+        }
+
+        std::cout << ", " << mWarmBuildCount << " warm builds";
+        if (mWarmBuildCount > 0)
+        {
+            std::cout << " (avg " << mWarmMilliseconds / mWarmBuildCount << " ms)";
+        }
+
+        std::cout << ", warm by " << getWarmCriterion() << std::endl;
+    }
+}
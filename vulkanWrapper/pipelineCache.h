@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "base.h"
+#include <mutex>
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // 设备级 VkPipelineCache，所有 Pipeline::build 共用
+    // 启动时从磁盘加载，头部的 vendorID / deviceID / pipelineCacheUUID 与当前设备不一致时丢弃；
+    // 析构时写回磁盘（先写临时文件再改名）。同时统计冷编译与命中缓存的管线创建耗时：
+    // 设备支持 VK_EXT_pipeline_creation_feedback 时按驱动报告的命中位判断，
+    // 否则只能粗略地把“启动时从磁盘加载了缓存”之后的创建都算作命中
+    // ==================================================================
+    class PipelineCache
+    {
+    public:
+        using Ptr = std::shared_ptr<PipelineCache>;
+
+        /// creationFeedback：设备已启用 VK_EXT_pipeline_creation_feedback
+        static Ptr create(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& path, bool creationFeedback = false)
+        {
+            return std::make_shared<PipelineCache>(device, physicalDevice, path, creationFeedback);
+        }
+
+        PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& path, bool creationFeedback = false);
+
+        ~PipelineCache();
+
+        PipelineCache(const PipelineCache&) = delete;
+        PipelineCache& operator=(const PipelineCache&) = delete;
+
+        /// 把当前缓存内容写入磁盘，失败时只打印警告
+        void save();
+
+        /// 创建管线前调用：支持创建反馈时把 feedbackInfo 挂到 createInfoNext 链上，由驱动写入 feedback
+        void attachFeedback(const void*& createInfoNext, VkPipelineCreationFeedbackCreateInfoEXT& feedbackInfo, VkPipelineCreationFeedbackEXT& feedback) const;
+
+        /// 记录一次管线创建耗时，返回是否算作命中缓存（判断方式见 getWarmCriterion）
+        bool recordBuild(double milliseconds, const VkPipelineCreationFeedbackEXT& feedback);
+
+        /// 命中缓存的判断方式，打印耗时时一并输出
+        [[nodiscard]] const char* getWarmCriterion() const;
+
+        void printStats() const;
+
+        [[nodiscard]] auto getCache() const { return mCache; }
+
+    private:
+        std::vector<char> loadFile() const;
+
+        bool isCompatible(const std::vector<char>& data) const;
+
+    private:
+        VkDevice         mDevice{ VK_NULL_HANDLE };
+        VkPipelineCache  mCache{ VK_NULL_HANDLE };
+        std::string      mPath{};
+        bool             mCreationFeedback{ false };
+        bool             mLoadedFromDisk{ false };
+
+        VkPhysicalDeviceProperties mProperties{};
+
+        mutable std::mutex mMutex;
+        uint32_t           mColdBuildCount{ 0 };
+        uint32_t           mWarmBuildCount{ 0 };
+        double             mColdMilliseconds{ 0.0 };
+        double             mWarmMilliseconds{ 0.0 };
+    };
+}
@@ -0,0 +1,56 @@
+﻿#include "queryPool.h"
+
+#include <bitset>
+
+namespace LearnVulkan::Wrapper
+{
+    QueryPool::QueryPool(const Device::Ptr& device, VkQueryType type, uint32_t queryCount, VkQueryPipelineStatisticFlags statistics)
+    {
+        mDevice     = device;
+        mType       = type;
+        mQueryCount = queryCount;
+        mStatistics = type == VK_QUERY_TYPE_PIPELINE_STATISTICS ? statistics : 0;
+
+        VkQueryPoolCreateInfo createInfo{};
+        createInfo.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        createInfo.queryType          = mType;
+        createInfo.queryCount         = mQueryCount;
+        createInfo.pipelineStatistics = mStatistics;
+
+        if (vkCreateQueryPool(mDevice->getDevice(), &createInfo, nullptr, &mQueryPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to create query pool!");
+        }
+    }
+
+    QueryPool::~QueryPool()
+    {
+        if (mQueryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(mDevice->getDevice(), mQueryPool, nullptr);
+        }
+    }
+
+    uint32_t QueryPool::getValueCount() const
+    {
+        return mType == VK_QUERY_TYPE_PIPELINE_STATISTICS ? static_cast<uint32_t>(std::bitset<32>(mStatistics).count()) : 1u;
+    }
+
+    bool QueryPool::getResults(uint32_t firstQuery, uint32_t queryCount, std::vector<uint64_t>& results, VkQueryResultFlags flags) const
+    {
+        uint32_t valueCount = getValueCount();
+
+        results.resize(size_t(queryCount) * valueCount);
+
+        VkResult result = vkGetQueryPoolResults(mDevice->getDevice(),
+                                                mQueryPool,
+                                                firstQuery,
+                                                queryCount,
+                                                results.size() * sizeof(uint64_t),
+                                                results.data(),
+                                                valueCount * sizeof(uint64_t),
+                                                flags | VK_QUERY_RESULT_64_BIT);
+
+        return result == VK_SUCCESS;
+    }
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include "base.h"
+#include "device.h"
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // 查询池：时间戳 / 管线统计等 GPU 查询
+    // 查询在命令缓冲中 reset、begin / end（或 writeTimestamp），结果在提交完成后由 getResults 读回
+    // ==================================================================
+    class QueryPool
+    {
+    public:
+        using Ptr = std::shared_ptr<QueryPool>;
+
+        /// statistics 只对 VK_QUERY_TYPE_PIPELINE_STATISTICS 有效，需要设备开启 pipelineStatisticsQuery
+        static Ptr create(const Device::Ptr& device, VkQueryType type, uint32_t queryCount, VkQueryPipelineStatisticFlags statistics = 0)
+        {
+            return std::make_shared<QueryPool>(device, type, queryCount, statistics);
+        }
+
+        QueryPool(const Device::Ptr& device, VkQueryType type, uint32_t queryCount, VkQueryPipelineStatisticFlags statistics = 0);
+
+        ~QueryPool();
+
+        /// 读取 [firstQuery, firstQuery + queryCount) 的 64 位结果，每个查询 getValueCount() 个值；
+        /// 不带 WAIT 标志时结果未就绪返回 false，不会阻塞
+        bool getResults(uint32_t firstQuery, uint32_t queryCount, std::vector<uint64_t>& results, VkQueryResultFlags flags = 0) const;
+
+        /// 每个查询写出的值个数：管线统计为开启的统计项数，其他类型为 1
+        [[nodiscard]] uint32_t getValueCount() const;
+
+        [[nodiscard]] auto getQueryPool()  const { return mQueryPool; }
+        [[nodiscard]] auto getType()       const { return mType; }
+        [[nodiscard]] auto getQueryCount() const { return mQueryCount; }
+        [[nodiscard]] auto getStatistics() const { return mStatistics; }
+
+    private:
+        VkQueryPool                   mQueryPool{ VK_NULL_HANDLE };
+        Device::Ptr                   mDevice{ nullptr };
+        VkQueryType                   mType{ VK_QUERY_TYPE_TIMESTAMP };
+        uint32_t                      mQueryCount{ 0 };
+        VkQueryPipelineStatisticFlags mStatistics{ 0 };
+    };
+}
@@ -1,8 +1,10 @@
 ﻿#include "sampler.h"
 
+#include <algorithm>
+
 namespace LearnVulkan::Wrapper
 {
-    Sampler::Sampler(const Device::Ptr& device)
+    Sampler::Sampler(const Device::Ptr& device, uint32_t mipLevels)
     {
         mDevice = device;
 
@@ -16,8 +18,9 @@ namespace LearnVulkan::Wrapper
         createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
         createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 
-        createInfo.anisotropyEnable = VK_TRUE;
-        createInfo.maxAnisotropy    = 16;
+        // 软件实现可能不支持各向异性过滤
+        createInfo.anisotropyEnable = mDevice->supportsSamplerAnisotropy() ? VK_TRUE : VK_FALSE;
+        createInfo.maxAnisotropy    = std::min(16.0f, mDevice->getMaxSamplerAnisotropy());
 
         createInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 
@@ -29,7 +32,7 @@ namespace LearnVulkan::Wrapper
         createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         createInfo.mipLodBias = 0.0f;
         createInfo.minLod     = 0.0f;
-        createInfo.maxLod     = 0.0f;
+        createInfo.maxLod     = static_cast<float>(mipLevels);
 
         if (vkCreateSampler(mDevice->getDevice(), &createInfo, nullptr, &mSampler) != VK_SUCCESS)
         {
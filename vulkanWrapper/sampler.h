@@ -9,9 +9,10 @@ namespace LearnVulkan::Wrapper
     {
     public:
         using Ptr = std::shared_ptr<Sampler>;
-        static Ptr create(const Device::Ptr& device) { return std::make_shared<Sampler>(device); }
+        static Ptr create(const Device::Ptr& device, uint32_t mipLevels = 1) { return std::make_shared<Sampler>(device, mipLevels); }
 
-        Sampler(const Device::Ptr& device);
+        /// mipLevels 取自被采样的图像，maxLod 覆盖它的整条 mip 链
+        Sampler(const Device::Ptr& device, uint32_t mipLevels = 1);
 
         ~Sampler();
 
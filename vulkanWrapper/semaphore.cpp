@@ -41,4 +41,11 @@ namespace LearnVulkan::Wrapper
         waitInfo.semaphoreCount = 1;
         vkWaitSemaphores(mDevice->getDevice(), &waitInfo, UINT64_MAX);
     }
+
+    uint64_t Semaphore::getCounterValue() const
+    {
+        uint64_t value = 0;
+        vkGetSemaphoreCounterValue(mDevice->getDevice(), mSemaphore, &value);
+        return value;
+    }
 }
@@ -16,6 +16,9 @@ namespace LearnVulkan::Wrapper
 
         void wait(uint64_t value);
 
+        /// 时间线信号量当前已到达的值
+        uint64_t getCounterValue() const;
+
         [[nodiscard]] auto getSemaphore() const { return mSemaphore; }
 
     private:
@@ -7,9 +7,10 @@ namespace LearnVulkan::Wrapper
     {
         std::ifstream file(fileName.c_str(), std::ios::ate | std::ios::binary | std::ios::in);
 
+        // .spv 只在构建期由 glslangValidator 生成（例如 cull.spv），缺失说明着色器没有随程序一起构建
         if (!file)
         {
-            throw std::runtime_error("Error: failed to open shader file!");
+            throw std::runtime_error("Error: failed to open shader file " + fileName + " (build the Shaders target)!");
         }
 
         const size_t fileSize = file.tellg();
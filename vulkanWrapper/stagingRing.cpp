@@ -0,0 +1,207 @@
+﻿#include "stagingRing.h"
+
+namespace LearnVulkan::Wrapper
+{
+    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    StagingRing::StagingRing(const Device::Ptr& device, VkDeviceSize size, uint32_t slotCount, bool useTransferQueue)
+    {
+        mDevice = device;
+        mSize   = size;
+        mQueue  = useTransferQueue ? mDevice->getTransferQueue() : mDevice->getGraphicQueue();
+
+        mRingBuffer = Buffer::create(mDevice,
+                                     mSize,
+                                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        mMappedData = static_cast<uint8_t*>(mRingBuffer->getAllocation().mMappedData);
+
+        // 独立的命令池：每个槽一个可复用的命令缓冲，vkBeginCommandBuffer 时隐式重置
+        mCommandPool = CommandPool::create(mDevice,
+                                           VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                                           useTransferQueue ? mDevice->getTransferQueueFamily() : mDevice->getGraphicQueueFamily());
+
+        mSlots.resize(slotCount);
+        for (auto& slot : mSlots)
+        {
+            slot.mCommandBuffer = CommandBuffer::create(mDevice, mCommandPool);
+            slot.mFence         = Fence::create(mDevice, false);
+        }
+    }
+
+    StagingRing::~StagingRing()
+    {
+        waitIdle();
+    }
+
+    void StagingRing::reclaimOldest()
+    {
+        uint32_t index = mSubmittedSlots.front();
+        mSubmittedSlots.pop_front();
+
+        auto& slot = mSlots[index];
+        slot.mFence->block();
+        slot.mFence->resetFence();
+        slot.mSubmitted = false;
+        slot.mOversizedBuffers.clear();
+
+        mTail = std::max(mTail, slot.mRingEnd);
+    }
+
+    StagingRing::Allocation StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment)
+    {
+        Allocation allocation{};
+
+        // 比整个环还大的上传：单独建一个暂存缓冲，随当前槽一起回收
+        if (size > mSize)
+        {
+            getCommandBuffer();
+
+            auto buffer = Buffer::create(mDevice,
+                                         size,
+                                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+            allocation.mBuffer     = buffer->getBuffer();
+            allocation.mOffset     = 0;
+            allocation.mMappedData = buffer->getAllocation().mMappedData;
+
+            mSlots[mCurrentSlot].mOversizedBuffers.push_back(buffer);
+
+            return allocation;
+        }
+
+        // 对齐的是环内偏移而不是累计位置：对齐值不一定是 2 的幂（例如 12 字节纹素），环大小不一定是它的倍数
+        VkDeviceSize ringStart = mHead - mHead % mSize;
+        VkDeviceSize offset    = alignUp(mHead % mSize, alignment);
+        VkDeviceSize position  = ringStart + offset;
+
+        // 放不下环尾的剩余部分时直接绕回环首（偏移 0 满足任何对齐），被跳过的部分随尾指针一起回收
+        if (offset + size > mSize)
+        {
+            position = ringStart + mSize;
+        }
+
+        while (position + size - mTail > mSize)
+        {
+            if (mSubmittedSlots.empty())
+            {
+                if (!mSlots[mCurrentSlot].mRecording)
+                {
+                    // 环里已没有 GPU 在用的数据，直接从新位置开始
+                    mTail = position;
+                    break;
+                }
+
+                // 环被当前尚未提交的拷贝占满：先提交，再等待它完成
+                flush();
+            }
+
+            reclaimOldest();
+        }
+
+        mHead = position + size;
+
+        allocation.mBuffer     = mRingBuffer->getBuffer();
+        allocation.mOffset     = position % mSize;
+        allocation.mMappedData = mMappedData + allocation.mOffset;
+
+        return allocation;
+    }
+
+    CommandBuffer::Ptr StagingRing::getCommandBuffer()
+    {
+        auto& slot = mSlots[mCurrentSlot];
+
+        if (!slot.mRecording)
+        {
+            // 槽位仍在 GPU 上执行：按提交顺序回收到它为止
+            while (slot.mSubmitted)
+            {
+                reclaimOldest();
+            }
+
+            slot.mCommandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+            slot.mRecording = true;
+        }
+
+        return slot.mCommandBuffer;
+    }
+
+    void StagingRing::flush(VkSemaphore signalSemaphore, uint64_t signalValue)
+    {
+        auto& slot = mSlots[mCurrentSlot];
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues    = &signalValue;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+        if (signalSemaphore != VK_NULL_HANDLE)
+        {
+            submitInfo.pNext                = &timelineInfo;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores    = &signalSemaphore;
+        }
+
+        if (!slot.mRecording)
+        {
+            // 之前的拷贝已在环满时提前提交：信号在队列中排在它们之后，同样覆盖这些拷贝
+            if (signalSemaphore != VK_NULL_HANDLE &&
+                vkQueueSubmit(mQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Error: failed to submit staging signal!");
+            }
+
+            return;
+        }
+
+        // 让之后提交到同一队列的渲染命令看到传输写入的数据
+        VkMemoryBarrier barrier{};
+        barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+        vkCmdPipelineBarrier(slot.mCommandBuffer->getCommandBuffer(),
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0,
+                             1, &barrier,
+                             0, nullptr,
+                             0, nullptr);
+
+        slot.mCommandBuffer->end();
+
+        VkCommandBuffer commandBuffer = slot.mCommandBuffer->getCommandBuffer();
+
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &commandBuffer;
+
+        if (vkQueueSubmit(mQueue, 1, &submitInfo, slot.mFence->getFence()) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to submit staging commands!");
+        }
+
+        slot.mRecording = false;
+        slot.mSubmitted = true;
+        slot.mRingEnd   = mHead;
+
+        mSubmittedSlots.push_back(mCurrentSlot);
+        mCurrentSlot = (mCurrentSlot + 1) % static_cast<uint32_t>(mSlots.size());
+    }
+
+    void StagingRing::waitIdle()
+    {
+        while (!mSubmittedSlots.empty())
+        {
+            reclaimOldest();
+        }
+    }
+}
@@ -0,0 +1,90 @@
+﻿#pragma once
+
+#include <deque>
+
+#include "base.h"
+#include "device.h"
+#include "buffer.h"
+#include "commandPool.h"
+#include "commandBuffer.h"
+#include "fence.h"
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // 常驻映射的暂存环形缓冲区
+    // 所有上传先 memcpy 进环，再录制到当前槽的传输命令缓冲里，
+    // 每帧调用一次 flush() 合并成一次提交；槽位靠 Fence 回收，不调用 vkQueueWaitIdle
+    // ==================================================================
+    class StagingRing
+    {
+    public:
+        using Ptr = std::shared_ptr<StagingRing>;
+
+        /// useTransferQueue：拷贝提交到设备的传输队列，否则提交到图形队列
+        static Ptr create(const Device::Ptr& device,
+                          VkDeviceSize size = 64ull * 1024 * 1024,
+                          uint32_t slotCount = 3,
+                          bool useTransferQueue = false)
+        {
+            return std::make_shared<StagingRing>(device, size, slotCount, useTransferQueue);
+        }
+
+        struct Allocation
+        {
+            VkBuffer     mBuffer{ VK_NULL_HANDLE };
+            VkDeviceSize mOffset{ 0 };
+            void*        mMappedData{ nullptr };
+        };
+
+        StagingRing(const Device::Ptr& device, VkDeviceSize size, uint32_t slotCount, bool useTransferQueue);
+
+        ~StagingRing();
+
+        /// 申请 size 字节的暂存空间；环满时等待最旧的一次提交完成后回收
+        Allocation allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+        /// 当前槽的传输命令缓冲，首次调用时开始录制
+        CommandBuffer::Ptr getCommandBuffer();
+
+        /// 把当前槽累积的所有拷贝一次性提交；给出时间线信号量时在提交完成后把它推进到 signalValue，
+        /// 即使当前槽没有新命令也会提交一次只含信号的批次
+        void flush(VkSemaphore signalSemaphore = VK_NULL_HANDLE, uint64_t signalValue = 0);
+
+        /// 等待所有已提交的槽完成（退出或销毁上传目标前调用）
+        void waitIdle();
+
+        [[nodiscard]] bool hasPendingWork() const { return mSlots[mCurrentSlot].mRecording; }
+
+        [[nodiscard]] auto getSize()             const { return mSize; }
+        [[nodiscard]] auto getQueueFamilyIndex() const { return mCommandPool->getQueueFamilyIndex(); }
+
+    private:
+        struct Slot
+        {
+            CommandBuffer::Ptr       mCommandBuffer{ nullptr };
+            Fence::Ptr               mFence{ nullptr };
+            VkDeviceSize             mRingEnd{ 0 };           // 提交时的写指针，槽完成后尾指针推进到这里
+            bool                     mRecording{ false };
+            bool                     mSubmitted{ false };
+            std::vector<Buffer::Ptr> mOversizedBuffers{};     // 超过整个环大小的上传使用的临时缓冲
+        };
+
+        void reclaimOldest();
+
+    private:
+        Device::Ptr      mDevice{ nullptr };
+        CommandPool::Ptr mCommandPool{ nullptr };
+        Buffer::Ptr      mRingBuffer{ nullptr };
+        uint8_t*         mMappedData{ nullptr };
+        VkQueue          mQueue{ VK_NULL_HANDLE };
+
+        VkDeviceSize mSize{ 0 };
+        VkDeviceSize mHead{ 0 };   // 单调递增的写位置，取模得到环内偏移
+        VkDeviceSize mTail{ 0 };   // 仍被 GPU 使用的最旧位置
+
+        std::vector<Slot>    mSlots{};
+        uint32_t             mCurrentSlot{ 0 };
+        std::deque<uint32_t> mSubmittedSlots{};  // 按提交顺序排列的槽
+    };
+}
@@ -6,7 +6,8 @@ namespace LearnVulkan::Wrapper
     SwapChain::SwapChain(const Device::Ptr& device,
                          const Window::Ptr& window,
                          const WindowSurface::Ptr& surface,
-                         const CommandPool::Ptr& commandPool)
+                         const CommandPool::Ptr& commandPool,
+                         const Ptr& oldSwapChain)
     {
         mDevice  = device;
         mWindow  = window;
@@ -75,6 +76,7 @@ namespace LearnVulkan::Wrapper
         createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;                    // 不透明合成（忽略 alpha 通道）
         createInfo.presentMode    = presentMode;                                          // 选择的呈现模式
         createInfo.clipped        = VK_TRUE;                                              // 允许裁剪（避免窗口遮挡时的渲染浪费）
+        createInfo.oldSwapchain   = oldSwapChain ? oldSwapChain->getSwapChain() : VK_NULL_HANDLE;  // 旧交换链进入退役状态，已提交的呈现仍可完成
 
         // 步骤8：创建 Vulkan 交换链对象
         // 调用 Vulkan API 创建交换链，若失败则抛出异常
@@ -108,30 +110,22 @@ namespace LearnVulkan::Wrapper
 
         // 步骤12：创建深度图像（用于深度测试）
         // 每个交换链图像需要对应的深度图像（同步创建，保证与交换链图像一一对应）
-        //mDepthImages.resize(mImageCount);
-
-        // 定义深度图像的子资源范围（仅深度通道，单层）
-        //VkImageSubresourceRange region{};
-        //region.aspectMask     = VK_IMAGE_ASPECT_DEPTH_BIT;  // 仅深度通道
-        //region.baseMipLevel   = 0;                          // 基础 Mipmap 层级（无 Mipmap 时为 0）
-        //region.levelCount     = 1;                          // Mipmap 层级数（单层）
-        //region.baseArrayLayer = 0;                          // 基础数组层（单层图像为 0）
-        //region.layerCount     = 1;                          // 数组层数（单层）
-
-        // 循环创建每个深度图像并设置布局
-        //for (int i = 0; i < mImageCount; ++i)
-        //{
-        //    // 创建深度图像对象（格式通常为 VK_FORMAT_D32_SFLOAT 或 VK_FORMAT_D24_UNORM_S8_UINT）
-        //    mDepthImages[i] = Image::createDepthImage(mDevice, mSwapChainExtent.width, mSwapChainExtent.height);
-
-        //    // 设置深度图像的初始布局（从 "未定义" 转换为 "深度模板附件最优"）
-        //    // 使图像准备好用于深度测试阶段
-        //    mDepthImages[i]->setImageLayout(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        //                                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-        //                                    VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-        //                                    region,
-        //                                    commandPool);
-        //}
+        // 深度只在渲染通道内使用：loadOp 清除、storeOp DONT_CARE，布局由渲染通道从 UNDEFINED 转换，
+        // 因此不需要在这里提交布局转换；图像为 TRANSIENT 附件，支持惰性分配的设备上可以不占显存
+        mDepthImages.resize(mImageCount);
+
+        for (int i = 0; i < mImageCount; ++i)
+        {
+            mDepthImages[i] = Image::createDepthImage(mDevice, mSwapChainExtent.width, mSwapChainExtent.height);
+        }
+
+        // 步骤13：每个交换链图像一个渲染完成信号量，提交时按获取到的图像序号选择，随交换链一起重建
+        mRenderFinishedSemaphores.resize(mImageCount);
+
+        for (int i = 0; i < mImageCount; ++i)
+        {
+            mRenderFinishedSemaphores[i] = Semaphore::create(mDevice, false);
+        }
     }
 
     void SwapChain::createFrameBuffers(const RenderPass::Ptr& renderPass)
@@ -142,7 +136,7 @@ namespace LearnVulkan::Wrapper
         {
             //FrameBuffer 里面为一帧的数据，比如有n个ColorAttachment 1个DepthStencilAttachment，
             //这些东西的集合为一个FrameBuffer，送入管线，就会形成一个GPU的集合，由上方的Attachments构成
-            std::array<VkImageView, 1> attachments = { mSwapChainImageViews[i] };
+            std::array<VkImageView, 2> attachments = { mSwapChainImageViews[i], mDepthImages[i]->getImageView() };
 
             VkFramebufferCreateInfo frameBufferCreateInfo{};
             frameBufferCreateInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
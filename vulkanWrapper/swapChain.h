@@ -7,6 +7,7 @@
 #include "renderPass.h"
 #include "image.h"
 #include "commandPool.h"
+#include "semaphore.h"
 
 namespace LearnVulkan::Wrapper
 {
@@ -25,9 +26,10 @@ namespace LearnVulkan::Wrapper
         static Ptr create(const Device::Ptr& device,
                           const Window::Ptr& window,
                           const WindowSurface::Ptr& surface,
-                          const CommandPool::Ptr& commandPool)
+                          const CommandPool::Ptr& commandPool,
+                          const Ptr& oldSwapChain = nullptr)
         {
-            return std::make_shared<SwapChain>(device, window, surface, commandPool);
+            return std::make_shared<SwapChain>(device, window, surface, commandPool, oldSwapChain);
         }
 
         // SwapChain ๹캯𴴽 Vulkan Swap ChainԴ
@@ -36,10 +38,12 @@ namespace LearnVulkan::Wrapper
         // - window: ڶָ룬ṩϵͳؽӿڣ GLFW ڣ
         // - surface: Vulkan ڱָ룬Ӵϵͳ Vulkan ڳͼĻ
         // - commandPool: ָ룬ڷ Vulkan ˴ͼ񲼾ת
+        // - oldSwapChain: 滻ľɽΪ oldSwapchain ԸԴƽɣΪգ
         SwapChain(const Device::Ptr& device, 
                   const Window::Ptr& window, 
                   const WindowSurface::Ptr& surface,
-                  const CommandPool::Ptr& commandPool);
+                  const CommandPool::Ptr& commandPool,
+                  const Ptr& oldSwapChain = nullptr);
 
         ~SwapChain();
 
@@ -60,6 +64,10 @@ namespace LearnVulkan::Wrapper
         [[nodiscard]] auto getFrameBuffer(const int index) const { return mSwapChainFrameBuffers[index]; }
         [[nodiscard]] auto getExtent()    const { return mSwapChainExtent; }
 
+        /// Ⱦźͼһͼ±ȡ֮ǰһֱ
+        /// ֡ķͼ frames-in-flight ʱڵȴеź
+        [[nodiscard]] const auto& getRenderFinishedSemaphore(uint32_t imageIndex) const { return mRenderFinishedSemaphores[imageIndex]; }
+
     private:
 
         // Ϊ Vulkan ͼ񴴽ͼͼImage View
@@ -81,10 +89,11 @@ namespace LearnVulkan::Wrapper
         VkExtent2D mSwapChainExtent;
         uint32_t   mImageCount{ 0 };
 
-        std::vector<VkImage>       mSwapChainImages{};
-        std::vector<VkImageView>   mSwapChainImageViews{};
-        std::vector<VkFramebuffer> mSwapChainFrameBuffers{};
-        std::vector<Image::Ptr>    mDepthImages{};
+        std::vector<VkImage>        mSwapChainImages{};
+        std::vector<VkImageView>    mSwapChainImageViews{};
+        std::vector<VkFramebuffer>  mSwapChainFrameBuffers{};
+        std::vector<Image::Ptr>     mDepthImages{};
+        std::vector<Semaphore::Ptr> mRenderFinishedSemaphores{};
 
         Device::Ptr        mDevice{ nullptr };
         Window::Ptr        mWindow{ nullptr };
@@ -0,0 +1,40 @@
+﻿#include "uniformArena.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace LearnVulkan::Wrapper
+{
+    UniformArena::UniformArena(const Device::Ptr& device, VkDeviceSize size)
+    {
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(device->getPhysicalDevice(), &properties);
+
+        mAlignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+        mSize      = size;
+        mBuffer    = Buffer::createUniformBuffer(device, size);
+
+        mMappedData = static_cast<uint8_t*>(mBuffer->getAllocation().mMappedData);
+        if (mMappedData == nullptr)
+        {
+            throw std::runtime_error("Error: uniform arena memory is not host visible!");
+        }
+    }
+
+    uint32_t UniformArena::push(const void* data, size_t size)
+    {
+        VkDeviceSize offset = (mHead + mAlignment - 1) / mAlignment * mAlignment;
+
+        if (offset + size > mSize)
+        {
+            throw std::runtime_error("Error: uniform arena is full!");
+        }
+
+        memcpy(mMappedData + offset, data, size);
+
+        mHead          = offset + size;
+        mHighWaterMark = std::max(mHighWaterMark, mHead);
+
+        return static_cast<uint32_t>(offset);
+    }
+}
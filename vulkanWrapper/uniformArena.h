@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include "base.h"
+#include "device.h"
+#include "buffer.h"
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // 每个 frame-in-flight 一块常驻映射的 uniform 内存
+    // 每帧开始时 reset，之后按 minUniformBufferOffsetAlignment 线性分配；
+    // 返回的偏移作为 UNIFORM_BUFFER_DYNAMIC 的动态偏移在绑定描述符集时传入，
+    // 写一个 uniform 只需一次 memcpy，不需要额外的 VkBuffer 和描述符集
+    // ==================================================================
+    class UniformArena
+    {
+    public:
+        using Ptr = std::shared_ptr<UniformArena>;
+
+        static Ptr create(const Device::Ptr& device, VkDeviceSize size)
+        {
+            return std::make_shared<UniformArena>(device, size);
+        }
+
+        UniformArena(const Device::Ptr& device, VkDeviceSize size);
+
+        ~UniformArena() = default;
+
+        /// 调用方需保证使用这块 arena 的上一帧已在 GPU 上完成
+        void reset() { mHead = 0; }
+
+        /// 把 data 拷贝到下一个对齐位置，返回相对 buffer 起点的字节偏移
+        uint32_t push(const void* data, size_t size);
+
+        [[nodiscard]] auto getBuffer()    const { return mBuffer; }
+        [[nodiscard]] auto getSize()      const { return mSize; }
+        [[nodiscard]] auto getAlignment() const { return mAlignment; }
+        [[nodiscard]] auto getUsedSize()  const { return mHead; }
+
+        /// 单帧内用量的最大值，用来确定 arena 大小是否合适
+        [[nodiscard]] auto getHighWaterMark() const { return mHighWaterMark; }
+
+    private:
+        Buffer::Ptr  mBuffer{ nullptr };
+        uint8_t*     mMappedData{ nullptr };
+        VkDeviceSize mSize{ 0 };
+        VkDeviceSize mAlignment{ 1 };
+        VkDeviceSize mHead{ 0 };
+        VkDeviceSize mHighWaterMark{ 0 };
+    };
+}
@@ -0,0 +1,520 @@
+﻿#include "uploadEngine.h"
+#include "cpuProfiler.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace LearnVulkan::Wrapper
+{
+    /// 一个纹素（块压缩格式为一个 4x4 块）的字节数；未列出的格式按 16 字节处理
+    static VkDeviceSize getTexelBlockSize(VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8_SRGB:
+        case VK_FORMAT_S8_UINT:
+            return 1;
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R8G8_SRGB:
+        case VK_FORMAT_R16_UNORM:
+        case VK_FORMAT_R16_SFLOAT:
+        case VK_FORMAT_D16_UNORM:
+            return 2;
+        case VK_FORMAT_R8G8B8_UNORM:
+        case VK_FORMAT_R8G8B8_SRGB:
+        case VK_FORMAT_B8G8R8_UNORM:
+        case VK_FORMAT_B8G8R8_SRGB:
+            return 3;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_D32_SFLOAT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+            return 4;
+        case VK_FORMAT_R16G16B16_UNORM:
+        case VK_FORMAT_R16G16B16_SFLOAT:
+            return 6;
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+            return 8;
+        case VK_FORMAT_R32G32B32_SFLOAT:
+            return 12;
+        default:
+            return 16;
+        }
+    }
+
+    UploadEngine::UploadEngine(const Device::Ptr& device, VkDeviceSize stagingSize, uint32_t slotCount)
+    {
+        mDevice         = device;
+        mDedicated      = mDevice->hasDedicatedTransferQueue();
+        mTransferFamily = mDevice->getTransferQueueFamily().value();
+        mGraphicFamily  = mDevice->getGraphicQueueFamily().value();
+
+        mStagingRing = StagingRing::create(mDevice, stagingSize, slotCount, true);
+
+        VkPhysicalDeviceProperties deviceProps{};
+        vkGetPhysicalDeviceProperties(mDevice->getPhysicalDevice(), &deviceProps);
+        mOptimalCopyAlignment = std::max<VkDeviceSize>(1, deviceProps.limits.optimalBufferCopyOffsetAlignment);
+
+        mTransferTimeline = Semaphore::create(mDevice, true);
+        mGraphicTimeline  = Semaphore::create(mDevice, true);
+
+        // acquire 屏障必须在接收方队列族上执行
+        mAcquireCommandPool = CommandPool::create(mDevice);
+    }
+
+    UploadEngine::~UploadEngine()
+    {
+        mStagingRing->waitIdle();
+
+        // acquire 命令缓冲可能还在图形队列上，等到它们全部执行完再释放
+        if (!mInFlightAcquires.empty())
+        {
+            mGraphicTimeline->wait(mInFlightAcquires.back().mValue);
+        }
+    }
+
+    void UploadEngine::uploadBuffer(VkBuffer dstBuffer,
+                                    VkDeviceSize dstOffset,
+                                    const void* pData,
+                                    VkDeviceSize size,
+                                    VkPipelineStageFlags dstStage,
+                                    VkAccessFlags dstAccess)
+    {
+        auto staging = mStagingRing->allocate(size);
+        memcpy(staging.mMappedData, pData, static_cast<size_t>(size));
+
+        auto commandBuffer = mStagingRing->getCommandBuffer();
+
+        VkBufferCopy copyInfo{};
+        copyInfo.srcOffset = staging.mOffset;
+        copyInfo.dstOffset = dstOffset;
+        copyInfo.size      = size;
+
+        commandBuffer->copyBufferToBuffer(staging.mBuffer, dstBuffer, 1, { copyInfo });
+
+        mHasPendingUpload = true;
+
+        // 同一队列族时，环在 flush 时的全局内存屏障已足够
+        if (!mDedicated)
+        {
+            return;
+        }
+
+        // release：传输队列放弃所有权，acquire 在图形队列上以相同参数完成交接
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask       = 0;
+        barrier.srcQueueFamilyIndex = mTransferFamily;
+        barrier.dstQueueFamilyIndex = mGraphicFamily;
+        barrier.buffer              = dstBuffer;
+        barrier.offset              = dstOffset;
+        barrier.size                = size;
+
+        vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(),
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0,
+                             0, nullptr,
+                             1, &barrier,
+                             0, nullptr);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = dstAccess;
+        mPendingBufferAcquires.push_back(barrier);
+        mPendingStages |= dstStage;
+    }
+
+    void UploadEngine::uploadImage(VkImage dstImage,
+                                   VkFormat format,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   const void* pData,
+                                   VkDeviceSize size,
+                                   const VkImageSubresourceRange& range,
+                                   VkImageLayout finalLayout,
+                                   VkPipelineStageFlags dstStage,
+                                   VkAccessFlags dstAccess)
+    {
+        uploadImage(dstImage,
+                    format,
+                    width,
+                    height,
+                    [pData, size](void* pStaging) { memcpy(pStaging, pData, static_cast<size_t>(size)); },
+                    size,
+                    range,
+                    finalLayout,
+                    dstStage,
+                    dstAccess);
+    }
+
+    void UploadEngine::uploadImage(VkImage dstImage,
+                                   VkFormat format,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   const StagingWriter& writer,
+                                   VkDeviceSize size,
+                                   const VkImageSubresourceRange& range,
+                                   VkImageLayout finalLayout,
+                                   VkPipelineStageFlags dstStage,
+                                   VkAccessFlags dstAccess)
+    {
+        VkBufferImageCopy region{};
+        region.bufferOffset                    = 0;
+        region.imageSubresource.aspectMask     = range.aspectMask;
+        region.imageSubresource.mipLevel       = range.baseMipLevel;
+        region.imageSubresource.baseArrayLayer = range.baseArrayLayer;
+        region.imageSubresource.layerCount     = range.layerCount;
+        region.imageExtent                     = { width, height, 1 };
+
+        auto commandBuffer = recordImageCopy(dstImage, format, { region }, writer, size, range);
+
+        finishImageUpload(commandBuffer, dstImage, range, finalLayout, dstStage, dstAccess);
+    }
+
+    void UploadEngine::uploadImage(VkImage dstImage,
+                                   VkFormat format,
+                                   const std::vector<VkBufferImageCopy>& regions,
+                                   const void* pData,
+                                   VkDeviceSize size,
+                                   const VkImageSubresourceRange& range,
+                                   VkImageLayout finalLayout,
+                                   VkPipelineStageFlags dstStage,
+                                   VkAccessFlags dstAccess)
+    {
+        auto commandBuffer = recordImageCopy(dstImage,
+                                             format,
+                                             regions,
+                                             [pData, size](void* pStaging) { memcpy(pStaging, pData, static_cast<size_t>(size)); },
+                                             size,
+                                             range);
+
+        finishImageUpload(commandBuffer, dstImage, range, finalLayout, dstStage, dstAccess);
+    }
+
+    void UploadEngine::uploadImageAndGenerateMips(VkImage dstImage,
+                                                  VkFormat format,
+                                                  uint32_t width,
+                                                  uint32_t height,
+                                                  const void* pData,
+                                                  VkDeviceSize size,
+                                                  const VkImageSubresourceRange& range,
+                                                  VkImageLayout finalLayout,
+                                                  VkPipelineStageFlags dstStage,
+                                                  VkAccessFlags dstAccess)
+    {
+        uploadImageAndGenerateMips(dstImage,
+                                   format,
+                                   width,
+                                   height,
+                                   [pData, size](void* pStaging) { memcpy(pStaging, pData, static_cast<size_t>(size)); },
+                                   size,
+                                   range,
+                                   finalLayout,
+                                   dstStage,
+                                   dstAccess);
+    }
+
+    void UploadEngine::uploadImageAndGenerateMips(VkImage dstImage,
+                                                  VkFormat format,
+                                                  uint32_t width,
+                                                  uint32_t height,
+                                                  const StagingWriter& writer,
+                                                  VkDeviceSize size,
+                                                  const VkImageSubresourceRange& range,
+                                                  VkImageLayout finalLayout,
+                                                  VkPipelineStageFlags dstStage,
+                                                  VkAccessFlags dstAccess)
+    {
+        VkBufferImageCopy region{};
+        region.bufferOffset                    = 0;
+        region.imageSubresource.aspectMask     = range.aspectMask;
+        region.imageSubresource.mipLevel       = range.baseMipLevel;
+        region.imageSubresource.baseArrayLayer = range.baseArrayLayer;
+        region.imageSubresource.layerCount     = range.layerCount;
+        region.imageExtent                     = { width, height, 1 };
+
+        auto commandBuffer = recordImageCopy(dstImage, format, { region }, writer, size, range);
+
+        MipChain mipChain{};
+        mipChain.mImage       = dstImage;
+        mipChain.mWidth       = width;
+        mipChain.mHeight      = height;
+        mipChain.mRange       = range;
+        mipChain.mFinalLayout = finalLayout;
+        mipChain.mDstStage    = dstStage;
+        mipChain.mDstAccess   = dstAccess;
+
+        // 同一队列族时传输队列就是图形队列，可以直接 blit
+        if (!mDedicated)
+        {
+            recordMipChain(commandBuffer, mipChain);
+            return;
+        }
+
+        // 专用传输队列不支持 blit：保持 TRANSFER_DST 交出所有权，在图形队列的 acquire 之后再生成
+        VkImageMemoryBarrier barrier{};
+        barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask       = 0;
+        barrier.srcQueueFamilyIndex = mTransferFamily;
+        barrier.dstQueueFamilyIndex = mGraphicFamily;
+        barrier.image               = dstImage;
+        barrier.subresourceRange    = range;
+
+        commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        mPendingImageAcquires.push_back(barrier);
+        mPendingMipChains.push_back(mipChain);
+        mPendingStages |= VK_PIPELINE_STAGE_TRANSFER_BIT | dstStage;
+    }
+
+    VkDeviceSize UploadEngine::getCopyAlignment(VkFormat format) const
+    {
+        VkDeviceSize alignment = std::lcm(getTexelBlockSize(format), VkDeviceSize(4));
+        return std::lcm(alignment, mOptimalCopyAlignment);
+    }
+
+    CommandBuffer::Ptr UploadEngine::recordImageCopy(VkImage dstImage,
+                                                     VkFormat format,
+                                                     std::vector<VkBufferImageCopy> regions,
+                                                     const StagingWriter& writer,
+                                                     VkDeviceSize size,
+                                                     const VkImageSubresourceRange& range)
+    {
+        // bufferOffset 需要是纹素（压缩格式为块）大小与 4 的整数倍，3 / 6 / 12 字节的格式不能只按 2 的幂对齐
+        auto staging = mStagingRing->allocate(size, getCopyAlignment(format));
+        writer(staging.mMappedData);
+
+        auto commandBuffer = mStagingRing->getCommandBuffer();
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask       = 0;
+        barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image               = dstImage;
+        barrier.subresourceRange    = range;
+
+        commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        for (auto& region : regions)
+        {
+            region.bufferOffset += staging.mOffset;
+        }
+
+        commandBuffer->copyBufferToImage(staging.mBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions);
+
+        mHasPendingUpload = true;
+
+        return commandBuffer;
+    }
+
+    void UploadEngine::finishImageUpload(const CommandBuffer::Ptr& commandBuffer,
+                                         VkImage dstImage,
+                                         const VkImageSubresourceRange& range,
+                                         VkImageLayout finalLayout,
+                                         VkPipelineStageFlags dstStage,
+                                         VkAccessFlags dstAccess)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout           = finalLayout;
+        barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image               = dstImage;
+        barrier.subresourceRange    = range;
+
+        if (!mDedicated)
+        {
+            barrier.dstAccessMask = dstAccess;
+            commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage);
+            return;
+        }
+
+        // release 与 acquire 的布局转换参数必须一致，转换只会执行一次
+        barrier.dstAccessMask       = 0;
+        barrier.srcQueueFamilyIndex = mTransferFamily;
+        barrier.dstQueueFamilyIndex = mGraphicFamily;
+
+        commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = dstAccess;
+        mPendingImageAcquires.push_back(barrier);
+        mPendingStages |= dstStage;
+    }
+
+    void UploadEngine::recordMipChain(const CommandBuffer::Ptr& commandBuffer, const MipChain& mipChain)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image                           = mipChain.mImage;
+        barrier.subresourceRange                = mipChain.mRange;
+        barrier.subresourceRange.levelCount     = 1;
+
+        int32_t width  = static_cast<int32_t>(mipChain.mWidth);
+        int32_t height = static_cast<int32_t>(mipChain.mHeight);
+
+        uint32_t firstLevel = mipChain.mRange.baseMipLevel;
+        uint32_t lastLevel  = firstLevel + mipChain.mRange.levelCount - 1;
+
+        for (uint32_t level = firstLevel + 1; level <= lastLevel; ++level)
+        {
+            int32_t nextWidth  = std::max(1, width / 2);
+            int32_t nextHeight = std::max(1, height / 2);
+
+            // 上一级写完后改为 blit 源
+            barrier.subresourceRange.baseMipLevel = level - 1;
+            barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout                     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask                 = VK_ACCESS_TRANSFER_READ_BIT;
+            commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+            VkImageBlit blit{};
+            blit.srcOffsets[1]                 = { width, height, 1 };
+            blit.srcSubresource.aspectMask     = mipChain.mRange.aspectMask;
+            blit.srcSubresource.mipLevel       = level - 1;
+            blit.srcSubresource.baseArrayLayer = mipChain.mRange.baseArrayLayer;
+            blit.srcSubresource.layerCount     = mipChain.mRange.layerCount;
+            blit.dstOffsets[1]                 = { nextWidth, nextHeight, 1 };
+            blit.dstSubresource                = blit.srcSubresource;
+            blit.dstSubresource.mipLevel       = level;
+
+            commandBuffer->blitImage(mipChain.mImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                     mipChain.mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                     blit, VK_FILTER_LINEAR);
+
+            // 上一级不再参与生成，直接转到最终布局
+            barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.newLayout     = mipChain.mFinalLayout;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.dstAccessMask = mipChain.mDstAccess;
+            commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, mipChain.mDstStage);
+
+            width  = nextWidth;
+            height = nextHeight;
+        }
+
+        barrier.subresourceRange.baseMipLevel = lastLevel;
+        barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout                     = mipChain.mFinalLayout;
+        barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask                 = mipChain.mDstAccess;
+        commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, mipChain.mDstStage);
+    }
+
+    CommandBuffer::Ptr UploadEngine::getAcquireCommandBuffer()
+    {
+        // 回收图形队列已经执行完的 acquire 命令缓冲
+        uint64_t completed = mGraphicTimeline->getCounterValue();
+        while (!mInFlightAcquires.empty() && mInFlightAcquires.front().mValue <= completed)
+        {
+            mFreeAcquires.push_back(mInFlightAcquires.front().mCommandBuffer);
+            mInFlightAcquires.pop_front();
+        }
+
+        if (mFreeAcquires.empty())
+        {
+            return CommandBuffer::create(mDevice, mAcquireCommandPool);
+        }
+
+        auto commandBuffer = mFreeAcquires.back();
+        mFreeAcquires.pop_back();
+
+        return commandBuffer;
+    }
+
+    bool UploadEngine::flush(FrameDependency& dependency)
+    {
+        if (!mHasPendingUpload)
+        {
+            return false;
+        }
+
+        CPU_PROFILE_ZONE("UploadEngine::flush");
+
+        ++mTransferValue;
+        mStagingRing->flush(mTransferTimeline->getSemaphore(), mTransferValue);
+        mHasPendingUpload = false;
+
+        // 同一队列族：提交顺序加上环的内存屏障已保证可见性，渲染无需等待
+        if (!mDedicated)
+        {
+            return false;
+        }
+
+        auto commandBuffer = getAcquireCommandBuffer();
+        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        // srcStage 与信号量等待阶段一致，保证 acquire（以及其中的布局转换）发生在传输完成之后
+        vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(),
+                             mPendingStages,
+                             mPendingStages,
+                             0,
+                             0, nullptr,
+                             static_cast<uint32_t>(mPendingBufferAcquires.size()), mPendingBufferAcquires.data(),
+                             static_cast<uint32_t>(mPendingImageAcquires.size()), mPendingImageAcquires.data());
+
+        for (const auto& mipChain : mPendingMipChains)
+        {
+            recordMipChain(commandBuffer, mipChain);
+        }
+
+        commandBuffer->end();
+
+        mInFlightAcquires.push_back({ commandBuffer, mTransferValue });
+
+        dependency.mAcquireCommandBuffer = commandBuffer->getCommandBuffer();
+        dependency.mWaitSemaphore        = mTransferTimeline->getSemaphore();
+        dependency.mWaitValue            = mTransferValue;
+        dependency.mWaitStage            = mPendingStages;
+        dependency.mSignalSemaphore      = mGraphicTimeline->getSemaphore();
+        dependency.mSignalValue          = mTransferValue;
+
+        mPendingBufferAcquires.clear();
+        mPendingImageAcquires.clear();
+        mPendingMipChains.clear();
+        mPendingStages = 0;
+
+        return true;
+    }
+
+    void UploadEngine::waitIdle()
+    {
+        if (mTransferValue > 0)
+        {
+            mTransferTimeline->wait(mTransferValue);
+        }
+
+        mStagingRing->waitIdle();
+    }
+}
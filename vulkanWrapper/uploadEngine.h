@@ -0,0 +1,189 @@
+﻿#pragma once
+
+#include <deque>
+#include <functional>
+
+#include "base.h"
+#include "device.h"
+#include "commandPool.h"
+#include "commandBuffer.h"
+#include "semaphore.h"
+#include "stagingRing.h"
+
+namespace LearnVulkan::Wrapper
+{
+    // ==================================================================
+    // 异步上传引擎
+    // 拷贝录制到传输队列（存在独立传输队列族时），提交后推进时间线信号量；
+    // 资源所有权通过 release / acquire 屏障交还给图形队列族，
+    // 渲染提交只在本帧确实有新上传时才等待对应的时间线值
+    // ==================================================================
+    class UploadEngine
+    {
+    public:
+        using Ptr = std::shared_ptr<UploadEngine>;
+
+        static Ptr create(const Device::Ptr& device, VkDeviceSize stagingSize = 64ull * 1024 * 1024, uint32_t slotCount = 3)
+        {
+            return std::make_shared<UploadEngine>(device, stagingSize, slotCount);
+        }
+
+        /// 把数据直接写进映射的暂存内存（pStaging 起的 size 字节），解码或格式转换可以省去一块中间缓冲
+        using StagingWriter = std::function<void(void* pStaging)>;
+
+        /// 渲染提交需要附加的依赖：等待传输完成、执行 acquire 屏障，并报告图形侧进度
+        struct FrameDependency
+        {
+            VkCommandBuffer      mAcquireCommandBuffer{ VK_NULL_HANDLE };
+            VkSemaphore          mWaitSemaphore{ VK_NULL_HANDLE };
+            uint64_t             mWaitValue{ 0 };
+            VkPipelineStageFlags mWaitStage{ 0 };
+            VkSemaphore          mSignalSemaphore{ VK_NULL_HANDLE };
+            uint64_t             mSignalValue{ 0 };
+        };
+
+        UploadEngine(const Device::Ptr& device, VkDeviceSize stagingSize, uint32_t slotCount);
+
+        ~UploadEngine();
+
+        /// dstStage / dstAccess：图形队列上第一次使用该缓冲的阶段与访问类型
+        void uploadBuffer(VkBuffer dstBuffer,
+                          VkDeviceSize dstOffset,
+                          const void* pData,
+                          VkDeviceSize size,
+                          VkPipelineStageFlags dstStage,
+                          VkAccessFlags dstAccess);
+
+        /// 图像从 UNDEFINED 开始，拷贝完成后转换到 finalLayout；format 决定暂存数据的对齐（见 getCopyAlignment）
+        void uploadImage(VkImage dstImage,
+                         VkFormat format,
+                         uint32_t width,
+                         uint32_t height,
+                         const void* pData,
+                         VkDeviceSize size,
+                         const VkImageSubresourceRange& range,
+                         VkImageLayout finalLayout,
+                         VkPipelineStageFlags dstStage,
+                         VkAccessFlags dstAccess);
+
+        /// 同上，但数据由 writer 直接生成在暂存内存中
+        void uploadImage(VkImage dstImage,
+                         VkFormat format,
+                         uint32_t width,
+                         uint32_t height,
+                         const StagingWriter& writer,
+                         VkDeviceSize size,
+                         const VkImageSubresourceRange& range,
+                         VkImageLayout finalLayout,
+                         VkPipelineStageFlags dstStage,
+                         VkAccessFlags dstAccess);
+
+        /// 多个子资源一次上传：regions 中的 bufferOffset 相对 pData，range 覆盖所有被写入的级别与层
+        void uploadImage(VkImage dstImage,
+                         VkFormat format,
+                         const std::vector<VkBufferImageCopy>& regions,
+                         const void* pData,
+                         VkDeviceSize size,
+                         const VkImageSubresourceRange& range,
+                         VkImageLayout finalLayout,
+                         VkPipelineStageFlags dstStage,
+                         VkAccessFlags dstAccess);
+
+        /// 只上传 range 的第一级，其余各级在图形队列上用 vkCmdBlitImage 逐级缩小生成；
+        /// 图像需带 TRANSFER_SRC 用途，格式需支持线性过滤的 blit（见 Image::supportsLinearBlit）
+        void uploadImageAndGenerateMips(VkImage dstImage,
+                                        VkFormat format,
+                                        uint32_t width,
+                                        uint32_t height,
+                                        const void* pData,
+                                        VkDeviceSize size,
+                                        const VkImageSubresourceRange& range,
+                                        VkImageLayout finalLayout,
+                                        VkPipelineStageFlags dstStage,
+                                        VkAccessFlags dstAccess);
+
+        void uploadImageAndGenerateMips(VkImage dstImage,
+                                        VkFormat format,
+                                        uint32_t width,
+                                        uint32_t height,
+                                        const StagingWriter& writer,
+                                        VkDeviceSize size,
+                                        const VkImageSubresourceRange& range,
+                                        VkImageLayout finalLayout,
+                                        VkPipelineStageFlags dstStage,
+                                        VkAccessFlags dstAccess);
+
+        /// 提交累积的上传；返回 true 时渲染提交需要附加 dependency
+        bool flush(FrameDependency& dependency);
+
+        /// 阻塞直到所有上传在传输队列上完成
+        void waitIdle();
+
+        [[nodiscard]] uint64_t getCompletedValue() const { return mTransferTimeline->getCounterValue(); }
+        [[nodiscard]] uint64_t getSubmittedValue() const { return mTransferValue; }
+
+    private:
+        /// 等待生成的 mip 链：第一级已写入，所有级别处于 TRANSFER_DST_OPTIMAL
+        struct MipChain
+        {
+            VkImage                 mImage{ VK_NULL_HANDLE };
+            uint32_t                mWidth{ 0 };
+            uint32_t                mHeight{ 0 };
+            VkImageSubresourceRange mRange{};
+            VkImageLayout           mFinalLayout{ VK_IMAGE_LAYOUT_UNDEFINED };
+            VkPipelineStageFlags    mDstStage{ 0 };
+            VkAccessFlags           mDstAccess{ 0 };
+        };
+
+        CommandBuffer::Ptr getAcquireCommandBuffer();
+
+        /// 暂存数据并录制 UNDEFINED -> TRANSFER_DST 与拷贝，返回录制所用的命令缓冲
+        CommandBuffer::Ptr recordImageCopy(VkImage dstImage,
+                                           VkFormat format,
+                                           std::vector<VkBufferImageCopy> regions,
+                                           const StagingWriter& writer,
+                                           VkDeviceSize size,
+                                           const VkImageSubresourceRange& range);
+
+        /// 转换到 finalLayout；独立传输队列时改为 release，acquire 留到 flush
+        void finishImageUpload(const CommandBuffer::Ptr& commandBuffer,
+                               VkImage dstImage,
+                               const VkImageSubresourceRange& range,
+                               VkImageLayout finalLayout,
+                               VkPipelineStageFlags dstStage,
+                               VkAccessFlags dstAccess);
+
+        static void recordMipChain(const CommandBuffer::Ptr& commandBuffer, const MipChain& mipChain);
+
+        /// 缓冲到图像拷贝的 bufferOffset 对齐：lcm(纹素 / 压缩块字节数, 4)，再与 optimalBufferCopyOffsetAlignment 取最小公倍数
+        VkDeviceSize getCopyAlignment(VkFormat format) const;
+
+    private:
+        struct AcquireBatch
+        {
+            CommandBuffer::Ptr mCommandBuffer{ nullptr };
+            uint64_t           mValue{ 0 };
+        };
+
+        Device::Ptr      mDevice{ nullptr };
+        StagingRing::Ptr mStagingRing{ nullptr };
+        bool             mDedicated{ false };
+        uint32_t         mTransferFamily{ 0 };
+        uint32_t         mGraphicFamily{ 0 };
+        VkDeviceSize     mOptimalCopyAlignment{ 1 };
+
+        Semaphore::Ptr mTransferTimeline{ nullptr };  // 传输队列推进：上传批次完成
+        Semaphore::Ptr mGraphicTimeline{ nullptr };   // 图形队列推进：acquire 屏障执行完毕，命令缓冲可复用
+        uint64_t       mTransferValue{ 0 };
+        bool           mHasPendingUpload{ false };
+
+        std::vector<VkBufferMemoryBarrier> mPendingBufferAcquires{};
+        std::vector<VkImageMemoryBarrier>  mPendingImageAcquires{};
+        std::vector<MipChain>              mPendingMipChains{};      // acquire 之后在图形队列上生成
+        VkPipelineStageFlags               mPendingStages{ 0 };
+
+        CommandPool::Ptr                mAcquireCommandPool{ nullptr };
+        std::deque<AcquireBatch>        mInFlightAcquires{};
+        std::vector<CommandBuffer::Ptr> mFreeAcquires{};
+    };
+}